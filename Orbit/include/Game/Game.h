@@ -6,11 +6,15 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <stack>
 
+#include "Task/FrameScheduler.h"
 #include "Visitors/ModelVisitor.h"
+#include <Game/FrameGraph.h>
 #include <Render/Projection.h>
+#include <Task/Task.h>
 
 namespace Orbit
 {
@@ -66,8 +70,9 @@ namespace Orbit
 		bool shouldClose() const;
 
 		/*!
-		@brief Passes on the elapsed time to the inner tree to generate a game tick.
-		@param elapsedTime The elapsed time since the last tick.
+		@brief Generates a game tick by executing the frame graph's phases.
+		@see Orbit::Game::loadPhases()
+		@param elapsedTime The elapsed time since the last tick. Always equal to the update loop's fixed step.
 		*/
 		void update(std::chrono::nanoseconds elapsedTime);
 		
@@ -81,13 +86,26 @@ namespace Orbit
 		/*! Sets the next scene to the scene in parameter. It will be loaded on the next frame. */
 		void loadScene(std::unique_ptr<Scene> scene);
 
-		/*! Handles scene changing transactions. */
+		/*!
+		@brief Handles scene changing transactions. The next scene's factories are loaded asynchronously, while the current
+		scene keeps running; the switch only happens on the first tick after they are done.
+		*/
 		void updateScene();
 
+		/*!
+		@brief Adds the engine's phases to the frame graph: input locking, scene transitions, timers, tree update, model
+		collection and frustum culling, view/projection setup, render queueing, frame publishing and visitor flushing.
+		*/
+		void loadPhases();
+
 		/*! The scene currently running in the game. Should never be nullptr except during initialization. */
 		std::unique_ptr<Scene> _currentScene;
 		/*! The scene that should be switched on the next (or current) frame. Should mostly be nullptr, except when a transition is necessary. */
 		std::unique_ptr<Scene> _nextScene;
+		/*! The scene whose factories are currently being loaded. Becomes the current scene once they are done. */
+		std::unique_ptr<Scene> _loadingScene;
+		/*! The task loading the loading scene's factories. */
+		Task<> _sceneLoading;
 
 		/*! The composite tree containing the game's nodes. */
 		std::unique_ptr<CompositeTree> _tree;
@@ -102,6 +120,18 @@ namespace Orbit
 
 		/*! The game's visitor, retrieving model state data. */
 		ModelVisitor _visitor;
+
+		/*! The phases making up a game tick. */
+		FrameGraph _frameGraph;
+		/*! The scheduler executing the frame graph on the task runner's workers. */
+		FrameScheduler _frameScheduler;
+
+		/*! The amount of frame packets published to the renderer so far. */
+		uint64_t _publishedFrames = 0;
+		/*! The view matrix of the last published packet, handed to the next one to blend from. */
+		glm::mat4 _previousView{ 1.f };
+		/*! The projection matrix of the last published packet, handed to the next one to blend from. */
+		glm::mat4 _previousProjection{ 1.f };
 	};
 }
 
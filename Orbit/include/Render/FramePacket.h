@@ -0,0 +1,60 @@
+/*! @file Render/FramePacket.h */
+
+#ifndef RENDER_FRAMEPACKET_H
+#define RENDER_FRAMEPACKET_H
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Orbit
+{
+	class Model;
+
+	/*!
+	@brief Everything the renderer needs to know about a simulated tick: the camera matrices and every model to draw, along
+	with its instance transforms. Built by the update thread, then handed over to the render thread, which only ever reads
+	it from then on.
+	Packets also hold the state of the tick before theirs, so that the renderer blends between two consecutive ticks even
+	when it skips packets, as it does whenever the simulation runs faster than the frame rate.
+	*/
+	struct FramePacket final
+	{
+		/*!
+		@brief A model and the instances of it to draw.
+		*/
+		struct ModelInstances
+		{
+			/*! The model. */
+			std::shared_ptr<Model> model;
+			/*! The transforms of the instances. */
+			std::vector<glm::mat4> transforms;
+			/*! The transforms of the instances as of the previous tick, matching the transforms. Instances that were not drawn
+			on the previous tick keep their current transform. */
+			std::vector<glm::mat4> previousTransforms;
+			/*! The ids of the instances (see Orbit::Node::instanceId()), matching the transforms. */
+			std::vector<uint64_t> ids;
+		};
+
+		/*! Sequence number of the packet. 0 until the update thread publishes its first packet. */
+		uint64_t index = 0;
+
+		/*! The camera's view matrix. */
+		glm::mat4 view{ 1.f };
+		/*! The projection matrix. */
+		glm::mat4 projection{ 1.f };
+		/*! The camera's view matrix as of the previous tick. */
+		glm::mat4 previousView{ 1.f };
+		/*! The projection matrix as of the previous tick. */
+		glm::mat4 previousProjection{ 1.f };
+
+		/*! The models to draw, along with their instances. Every model of the tree is listed, in the same order from one
+		packet to the next, even when none of its instances is in view. */
+		std::vector<ModelInstances> models;
+	};
+}
+
+#endif //RENDER_FRAMEPACKET_H
\ No newline at end of file
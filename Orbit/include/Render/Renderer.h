@@ -4,13 +4,15 @@
 #define RENDER_RENDERER_H
 #pragma once
 
+#include "Render/FramePacket.h"
+#include "Task/TripleBuffer.h"
+
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
 
 namespace Orbit
 {
-	class Model;
 	class Window;
 
 	/*!
@@ -24,7 +26,8 @@ namespace Orbit
 
 	/*!
 	@brief Renderer base class for the engine. Abstracts rendering operations in a usable base class
-	for general rendering requirements.
+	for general rendering requirements. The update thread never calls into the rendering API: it fills and publishes frame
+	packets, which the render thread picks up at its own pace.
 	*/
 	class Renderer
 	{
@@ -59,43 +62,71 @@ namespace Orbit
 		*/
 		virtual void flagResize(const glm::ivec2& newSize) = 0;
 
-		/*! Pair of models and their counts in the composite tree. */
-		using ModelCountPair = std::pair<std::shared_ptr<Model>, size_t>;
+		/*!
+		@brief Getter for the frame packet being built, to be filled in then published with publishFramePacket(). The
+		packet is recycled and holds stale data, so every field must be rewritten. Update thread only.
+		@return A reference to the packet being built.
+		*/
+		FramePacket& framePacket()
+		{
+			return _framePackets.writeBuffer();
+		}
 
 		/*!
-		@brief Loads the models in parameter. Uses ModelCountPair in order to allow the renderer any
-		optimizations in memory (like reserving buffers for transformations, for instance).
-		@param modelCounts A collection containing models and their counts.
+		@brief Publishes the frame packet being built, to be picked up by the next rendered frame. Never blocks, even while
+		a frame is being rendered. Update thread only.
 		*/
-		virtual void loadModels(const std::vector<ModelCountPair>& modelCounts) = 0;
+		void publishFramePacket()
+		{
+			_framePackets.publish();
+		}
 
 		/*!
-		@brief Sets up the view/projection matrices in the renderer. Ideally, information would be
-		passed along to device memory in order to be used in rendering.
-		@param view The view matrix.
-		@param projection The projection matrix.
+		@brief Actually renders a frame, from the latest published frame packet. Whether or not this really happens (think
+		OpenGL 1.2 immediate mode) is up to implementation. Transforms (and view/projection) are blended between the packet's
+		tick and the one before it, so that rendering at a different rate than the simulation stays smooth.
+		@param interpolation Where the frame sits between the previous tick (0) and the packet's tick (1).
 		*/
-		virtual void setupViewProjection(const glm::mat4& view, const glm::mat4& projection) = 0;
+		virtual void renderFrame(float interpolation) = 0;
 
-		/*! Pair of models and their transforms. Useful when passing along transform data for models. */
-		using ModelTransformsPair = std::pair<std::shared_ptr<Model>, std::vector<glm::mat4>>;
+		/*!
+		@brief Waits for the rendering device to be idle. Serves as high-level synchronization.
+		*/
+		virtual void waitDeviceIdle() = 0;
 
+	protected:
 		/*!
-		@brief Prepares a frame to be rendered, with the models in parameter taking the transforms in parameter.
-		@param modelTransforms The models and their transformations.
+		@brief Picks up the latest published frame packet, if a newer one than the current one is available. Render thread
+		only.
+		@return Whether or not a newer packet was picked up.
 		*/
-		virtual void queueRender(const std::vector<ModelTransformsPair>& modelTransforms) = 0;
+		bool acquireFramePacket()
+		{
+			return _framePackets.consume();
+		}
 
 		/*!
-		@brief Actually renders a frame. Whether or not this really happens (think OpenGL 1.2 immediate mode) is
-		up to implementation.
+		@brief Returns whether or not a newer frame packet than the current one was published. Render thread only.
+		@return Whether or not a newer packet is available.
 		*/
-		virtual void renderFrame() = 0;
+		bool hasNewFramePacket() const
+		{
+			return _framePackets.hasFresh();
+		}
 
 		/*!
-		@brief Waits for the rendering device to be idle. Serves as high-level synchronization.
+		@brief Getter for the current frame packet, that is the last one picked up by acquireFramePacket(). Stays valid
+		until the next successful acquisition. Render thread only.
+		@return A reference to the current frame packet.
 		*/
-		virtual void waitDeviceIdle() = 0;
+		const FramePacket& currentFramePacket() const
+		{
+			return _framePackets.readBuffer();
+		}
+
+	private:
+		/*! The frame packets exchanged between the update and render threads. */
+		TripleBuffer<FramePacket> _framePackets;
 	};
 
 	inline Renderer::~Renderer() = default;
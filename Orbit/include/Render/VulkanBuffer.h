@@ -99,8 +99,8 @@ namespace Orbit
 
 		public:
 			/*!
-			@brief Copy the data in parameter to the underlying memory (using memcpy) with the size in parameter.
-			@throw std::runtime_error Throws if the size parameter is different from the Block's size.
+			@brief Copy the data in parameter to the start of the underlying memory (using memcpy) with the size in parameter.
+			@throw std::runtime_error Throws if the size parameter is larger than the Block's size.
 			@param data The data source to copy.
 			@param size The size of the data to copy.
 			*/
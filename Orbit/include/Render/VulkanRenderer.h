@@ -64,29 +64,11 @@ namespace Orbit
 		void flagResize(const glm::ivec2& newSize) override;
 
 		/*!
-		@brief Loads the models into GPU-local memory.
-		@param models The models to load into memory.
+		@brief Makes a frame be rendered. Picks up the latest frame packet (reloading models if they changed), then writes
+		its state, blended with the previous packet's, before submitting.
+		@param interpolation Where the frame sits between the previous tick (0) and the packet's tick (1).
 		*/
-		void loadModels(const std::vector<ModelCountPair>& models) override;
-
-		/*!
-		@brief Sets up the viewProjection matrix for the current frame. Computes it together and writes
-		it in device-local memory.
-		@param view The view matrix.
-		@param projection The projection matrix.
-		*/
-		void setupViewProjection(const glm::mat4& view, const glm::mat4& projection) override;
-
-		/*!
-		@brief Queues a render operation for the current frame with the updated model transformation data.
-		@param modelTransforms The model and transformation data.
-		*/
-		void queueRender(const std::vector<ModelTransformsPair>& modelTransforms) override;
-
-		/*!
-		@brief Makes a frame be rendered.
-		*/
-		void renderFrame() override;
+		void renderFrame(float interpolation) override;
 
 		/*!
 		@brief Waits for the device to become idle, for synchronization purposes.
@@ -111,13 +93,54 @@ namespace Orbit
 			/*! Index of the texture in the texture buffer. Only set if the model has a texture. */
 			size_t textureIndex = std::numeric_limits<size_t>::max();
 
-			/*! Index of the first instance of the model. */
+			/*! Index of the model's instances, both in the transform blocks and in the indirect draw commands. */
 			size_t instanceIndex = std::numeric_limits<size_t>::max();
-			/*! Amount of instances of this model to render. */
-			size_t instanceCount = std::numeric_limits<size_t>::max();
+			/*! Amount of instances the model's transform block can hold. The amount actually drawn is written every frame. */
+			size_t instanceCapacity = 0;
 		};
 
 
+		/*!
+		@brief Loads the models into GPU-local memory, then creates the transform buffer.
+		@param models The models to load into memory, from a frame packet: room is made for as many instances as they have.
+		*/
+		void loadModels(const std::vector<FramePacket::ModelInstances>& models);
+
+		/*!
+		@brief Creates the transform buffer from the instance capacities of the loaded models: the view/projection block,
+		a block of transforms per model, then a block holding every model's indirect draw command. Points the descriptor sets
+		to it, then records the command buffers again.
+		*/
+		void createInstanceBuffer();
+
+		/*!
+		@brief Makes sure that the transform blocks can hold a packet's instances. Blocks are grown to the next power of
+		two when they cannot, which recreates the transform buffer, but leaves the models' geometry be.
+		@param packet The packet to make room for, whose models match the loaded ones.
+		*/
+		void reserveInstances(const FramePacket& packet);
+
+		/*!
+		@brief Picks up the latest frame packet, if there is a new one. Reloads the models when the packet's models differ
+		from the loaded ones, and makes room for its instances.
+		*/
+		void acquireLatestFramePacket();
+
+		/*!
+		@brief Checks whether a packet's models match the loaded ones. Instance counts are not looked at, as they are
+		written every frame.
+		@param packet The packet to check.
+		@return Whether or not the packet's models differ from the loaded ones.
+		*/
+		bool modelsChanged(const FramePacket& packet) const;
+
+		/*!
+		@brief Writes the current packet's view/projection, transforms and instance counts to the transform buffer, blending
+		view/projection and transforms with their values as of the previous tick, which the packet holds as well.
+		@param interpolation Where the frame sits between the previous tick (0) and the packet's tick (1).
+		*/
+		void writeFrameState(float interpolation);
+
 		/*!
 		@brief Helper function to record the primary command buffers. Also handles their creation.
 		@param device The device used for allocations.
@@ -221,6 +244,11 @@ namespace Orbit
 		/*! Image (list? array?) containing all textures used by models. */
 		VulkanImage _textureImage = nullptr;
 
+		/*! Scratch storage for blended transforms, kept around to avoid reallocating every frame. */
+		std::vector<glm::mat4> _blendedTransforms;
+		/*! Scratch storage for the indirect draw commands, one per model. */
+		std::vector<vk::DrawIndexedIndirectCommand> _drawCommands;
+
 		/*! Semaphore controlling access to image availability. */
 		vk::Semaphore _imageSemaphore;
 		/*! Semaphore controlling access to render operations. */
@@ -0,0 +1,52 @@
+/*! @file Task/FrameScheduler.h */
+
+#ifndef TASK_FRAMESCHEDULER_H
+#define TASK_FRAMESCHEDULER_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace Orbit
+{
+	class FrameGraph;
+	class TaskRunner;
+
+	/*!
+	@brief Executes a FrameGraph on a TaskRunner's workers. Every phase is started as soon as the phases it depends on are
+	done, so that independent phases run concurrently.
+	*/
+	class FrameScheduler final
+	{
+	public:
+		/*!
+		@brief Constructor for the class.
+		@param runner The runner whose workers execute the phases.
+		*/
+		explicit FrameScheduler(TaskRunner& runner);
+
+		FrameScheduler(const FrameScheduler&) = delete;
+		FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+		/*!
+		@brief Executes every phase of the graph once, returning when all of them are done. The calling thread takes part
+		in the work. Should a phase throw, the phases depending on it are skipped.
+		@throw Rethrows the first exception thrown by a phase.
+		@param graph The graph to execute.
+		@param elapsedTime The elapsed time passed along to every phase.
+		*/
+		void execute(const FrameGraph& graph, std::chrono::nanoseconds elapsedTime);
+
+	private:
+		/*! The runner whose workers execute the phases. */
+		TaskRunner& _runner;
+
+		/*! Per-phase amount of dependencies left before the phase can run. Kept around between executions. */
+		std::unique_ptr<std::atomic<size_t>[]> _remainingDependencies;
+		/*! The amount of counters allocated in _remainingDependencies. */
+		size_t _capacity = 0;
+	};
+}
+
+#endif //TASK_FRAMESCHEDULER_H
\ No newline at end of file
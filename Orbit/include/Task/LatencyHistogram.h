@@ -0,0 +1,90 @@
+/*! @file Task/LatencyHistogram.h */
+
+#ifndef TASK_LATENCYHISTOGRAM_H
+#define TASK_LATENCYHISTOGRAM_H
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Orbit
+{
+	/*!
+	@brief Fixed-width bucket histogram of durations, to extract minimums, means and percentiles of timing samples without
+	keeping every sample around. Samples above the last bucket are counted in it (minimum, mean and maximum stay exact).
+	Not thread-safe.
+	*/
+	class LatencyHistogram final
+	{
+	public:
+		/*!
+		@brief Constructor for the class.
+		@param bucketWidth The width of a single bucket, which is the precision of the percentiles.
+		@param bucketCount The amount of buckets.
+		*/
+		explicit LatencyHistogram(
+			std::chrono::nanoseconds bucketWidth = std::chrono::microseconds(1),
+			size_t bucketCount = 4096);
+
+		/*!
+		@brief Records a sample. Negative samples are recorded as zero.
+		@param sample The sample to record.
+		*/
+		void record(std::chrono::nanoseconds sample);
+
+		/*!
+		@brief Clears every recorded sample.
+		*/
+		void reset();
+
+		/*!
+		@brief Getter for the amount of recorded samples.
+		@return The amount of recorded samples.
+		*/
+		uint64_t count() const;
+
+		/*!
+		@brief Getter for the smallest recorded sample.
+		@return The smallest recorded sample, or zero if there are none.
+		*/
+		std::chrono::nanoseconds min() const;
+
+		/*!
+		@brief Getter for the largest recorded sample.
+		@return The largest recorded sample, or zero if there are none.
+		*/
+		std::chrono::nanoseconds max() const;
+
+		/*!
+		@brief Computes the mean of the recorded samples.
+		@return The mean of the recorded samples, or zero if there are none.
+		*/
+		std::chrono::nanoseconds mean() const;
+
+		/*!
+		@brief Computes a percentile of the recorded samples, rounded up to the bucket's upper bound (and never over the
+		largest sample).
+		@param percentile The percentile to compute, in [0, 1] (i.e. 0.99 for the 99th percentile).
+		@return The computed percentile, or zero if there are no samples.
+		*/
+		std::chrono::nanoseconds percentile(double percentile) const;
+
+	private:
+		/*! The width of a single bucket. */
+		std::chrono::nanoseconds _bucketWidth;
+		/*! The sample counts, per bucket. */
+		std::vector<uint64_t> _buckets;
+
+		/*! The amount of recorded samples. */
+		uint64_t _count = 0;
+		/*! The sum of the recorded samples, in nanoseconds. */
+		std::chrono::nanoseconds::rep _sum = 0;
+		/*! The smallest recorded sample. */
+		std::chrono::nanoseconds _min = std::chrono::nanoseconds::max();
+		/*! The largest recorded sample. */
+		std::chrono::nanoseconds _max = std::chrono::nanoseconds::zero();
+	};
+}
+
+#endif //TASK_LATENCYHISTOGRAM_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*! @file Task/TaskGroup.h */
+
+#ifndef TASK_TASKGROUP_H
+#define TASK_TASKGROUP_H
+#pragma once
+
+#include "Task/TaskRunner.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace Orbit
+{
+	/*!
+	@brief Fork/join helper over a TaskRunner's worker pool. Jobs are forked with run() and joined with wait(), during
+	which the waiting thread executes the group's pending jobs instead of blocking - waiting from within a job is therefore
+	safe. Jobs that do not belong to the group are left to the workers, so a join never ends up stuck behind unrelated work.
+	*/
+	class TaskGroup final
+	{
+	public:
+		/*! A job forked by the group. Smaller than a runner job, as it gets wrapped in one along with the group. */
+		using Job = InplaceFunction<void(), 48>;
+
+		/*!
+		@brief Constructor for the class.
+		@param runner The runner whose workers execute the group's jobs.
+		*/
+		explicit TaskGroup(TaskRunner& runner);
+
+		/*!
+		@brief Destructor for the class. Waits for the remaining jobs, as they reference the group.
+		*/
+		~TaskGroup();
+
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		/*!
+		@brief Forks a job onto the runner's workers.
+		@param job The job to execute.
+		*/
+		void run(Job job);
+
+		/*!
+		@brief Joins every job forked so far, helping out with the group's pending jobs in the meantime.
+		@throw Rethrows the first exception thrown by one of the group's jobs.
+		*/
+		void wait();
+
+	private:
+		/*!
+		@brief Helps out with the group's pending jobs until every one of them has finished.
+		*/
+		void join();
+
+		/*! The runner executing the group's jobs. */
+		TaskRunner& _runner;
+
+		/*! The amount of jobs forked but not yet finished. */
+		std::atomic<size_t> _remainingJobs = 0;
+
+		/*! Mutex protecting the exception pointer. */
+		std::mutex _exceptionMutex;
+		/*! The first exception thrown by one of the group's jobs, if any. */
+		std::exception_ptr _exception;
+	};
+}
+
+#endif //TASK_TASKGROUP_H
\ No newline at end of file
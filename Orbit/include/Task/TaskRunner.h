@@ -4,71 +4,268 @@
 #define TASK_TASKRUNNER_H
 #pragma once
 
+#include "Task/Executor.h"
+#include "Task/LatencyHistogram.h"
+#include "Task/ThreadSettings.h"
+#include "Task/TickTelemetry.h"
+
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <thread>
-#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace Orbit
 {
+	class TaskGroup;
+
+	/*!
+	@brief Definition of the ways a loop can wait for its next tick.
+	*/
+	enum class PacingMode : int
+	{
+		/*! Sleeps until the deadline. Cheapest, but the OS routinely oversleeps by a sizeable fraction of a tick. */
+		Sleep,
+		/*! Sleeps until shortly before the deadline, then spin-waits for the rest of the way. */
+		Hybrid,
+		/*! Spin-waits until the deadline, burning a whole core for the best precision. */
+		Busy
+	};
+
+	/*!
+	@brief Per-loop settings, passed along when starting a loop in a TaskRunner.
+	*/
+	struct LoopOptions final
+	{
+		/*! The loop's name, used to query its statistics and to name its thread. If empty, the runner generates one. */
+		std::string name;
+
+		/*! The logical CPUs the loop's thread is pinned to. The thread may run anywhere if empty. */
+		std::vector<size_t> cpus;
+		/*! The scheduling priority of the loop's thread. */
+		ThreadPriority priority = ThreadPriority::Normal;
+
+		/*! How the loop waits for its next tick. */
+		PacingMode pacing = PacingMode::Sleep;
+		/*! How long before the deadline a hybrid loop stops sleeping and starts spinning. Should cover the usual oversleep. */
+		std::chrono::nanoseconds spinDuration = std::chrono::milliseconds(2);
+
+		/*! For fixed timestep loops, the maximum amount of ticks to run back-to-back when catching up. */
+		size_t maxCatchUpTicks = 5;
+	};
+
 	/*!
-	@brief Helper class to run multiple threads of stuff at the same time in an easy-to-use format.
+	@brief Settings of a TaskRunner's worker threads.
 	*/
-	class TaskRunner final
+	struct WorkerOptions final
+	{
+		/*! Prefix of the workers' thread names, followed by their index in the pool. */
+		std::string namePrefix = "Worker";
+
+		/*!
+		The logical CPUs the workers are pinned to. If empty, workers may run on any available CPU that is not reserved.
+		*/
+		std::vector<size_t> cpus;
+		/*! Whether every worker is pinned to a single CPU of the set (in a round-robin fashion), or may float over all of them. */
+		bool pinToSingleCpu = false;
+		/*! The scheduling priority of the workers. */
+		ThreadPriority priority = ThreadPriority::Normal;
+
+		/*!
+		Logical CPUs kept off-limits to the workers, so that latency-sensitive loops can have them to themselves. Loops
+		still have to be pinned on them explicitly.
+		@see Orbit::TaskRunner::reservedCpus()
+		*/
+		std::vector<size_t> reservedCpus;
+	};
+
+	/*!
+	@brief Helper class to run multiple threads of stuff at the same time in an easy-to-use format. Also owns a pool of
+	worker threads, to which jobs can be submitted from anywhere (including from within a running loop's tick). Acts as
+	the executor on which coroutine tasks resume.
+	*/
+	class TaskRunner final : public Executor
 	{
 	public:
+		/*! A unit of work to be executed by the runner's workers. */
+		using Job = Executor::Job;
+		/*! A loop's end condition, checked before every tick. */
+		using LoopCondition = InplaceFunction<bool()>;
+		/*! A loop's tick. */
+		using LoopFunction = InplaceFunction<void()>;
+		/*! A loop's tick, given the time elapsed since the last one. */
+		using TimedLoopFunction = InplaceFunction<void(std::chrono::nanoseconds)>;
+
+		/*!
+		@brief Constructor for the class. Starts up the worker pool.
+		@param workerCount The amount of worker threads to spawn. If 0, jobs are executed inline on submission.
+		@param workerOptions The settings of the worker threads.
+		*/
+		explicit TaskRunner(size_t workerCount = defaultWorkerCount(), const WorkerOptions& workerOptions = WorkerOptions());
+
 		/*!
 		@brief Ensures that all the threads close up correctly.
 		*/
 		~TaskRunner();
 
+		TaskRunner(const TaskRunner&) = delete;
+		TaskRunner& operator=(const TaskRunner&) = delete;
+
 		/*!
 		@brief Runs the function defined by run in the current thread, taking control of the thread.
 		@param targetTPS The target amount of ticks per second.
 		@param end The end condition, taken as a function execution.
 		@param run The function to actually run on every tick.
+		@param options The loop's settings.
 		*/
 		void run(
 			size_t targetTPS,
-			const std::function<bool()>& end,
-			const std::function<void()>& run);
+			LoopCondition end,
+			LoopFunction run,
+			const LoopOptions& options = LoopOptions());
 
 		/*!
 		@brief Runs the function defined by run in the current thread, taking control of the thread, passing time.
 		@param targetTPS The target amount of ticks per second.
 		@param end The end condition, taken as a function execution.
 		@param run The function to actually run on every tick.
+		@param options The loop's settings.
 		*/
 		void run(
 			size_t targetTPS,
-			const std::function<bool()>& end, 
-			const std::function<void(std::chrono::nanoseconds)>& run);
+			LoopCondition end,
+			TimedLoopFunction run,
+			const LoopOptions& options = LoopOptions());
 
 		/*!
 		@brief Runs the function defined by run on a separate thread.
 		@param targetTPS The target amount of ticks per second.
 		@param end The end condition, taken as a function execution.
 		@param run The function to actually run on every tick.
+		@param options The loop's settings.
 		*/
 		void runAsync(
-			size_t targetTPS, 
-			const std::function<bool()>& end,
-			const std::function<void()>& run);
+			size_t targetTPS,
+			LoopCondition end,
+			LoopFunction run,
+			const LoopOptions& options = LoopOptions());
 
 		/*!
 		@brief Runs the function defined by run on a separate thread, passing time.
 		@param targetTPS the target amount of ticks per second.
 		@param end The end condition, taken as a function execution.
 		@param run The function to actually run on every tick.
+		@param options The loop's settings.
 		*/
 		void runAsync(
-			size_t targetTPS, 
-			const std::function<bool()>& end,
-			const std::function<void(std::chrono::nanoseconds)>& run);
+			size_t targetTPS,
+			LoopCondition end,
+			TimedLoopFunction run,
+			const LoopOptions& options = LoopOptions());
+
+		/*!
+		@brief Runs the function defined by run in the current thread with a fixed timestep, taking control of the thread.
+		Ticks are scheduled on absolute deadlines and always simulate exactly one step: when the loop falls behind, it runs
+		catch-up ticks until it is back on schedule, up to LoopOptions::maxCatchUpTicks in a row, after which the lost time
+		is dropped.
+		@throw std::runtime_error Throws if a fixed timestep loop is already running in this runner.
+		@param targetTPS The amount of ticks per second. The step passed to run is one second divided by this amount.
+		@param end The end condition, taken as a function execution.
+		@param run The function to actually run on every tick.
+		@param options The loop's settings.
+		*/
+		void runFixed(
+			size_t targetTPS,
+			LoopCondition end,
+			TimedLoopFunction run,
+			const LoopOptions& options = LoopOptions());
+
+		/*!
+		@brief Runs the function defined by run on a separate thread with a fixed timestep.
+		@see Orbit::TaskRunner::runFixed()
+		@throw std::runtime_error Throws if a fixed timestep loop is already running in this runner.
+		@param targetTPS The amount of ticks per second. The step passed to run is one second divided by this amount.
+		@param end The end condition, taken as a function execution.
+		@param run The function to actually run on every tick.
+		@param options The loop's settings.
+		*/
+		void runFixedAsync(
+			size_t targetTPS,
+			LoopCondition end,
+			TimedLoopFunction run,
+			const LoopOptions& options = LoopOptions());
+
+		/*!
+		@brief Computes how far the current time is between the last tick of the fixed timestep loop and the next one.
+		Meant to be used by a loop running at a different rate (i.e. rendering) to blend between the last two simulated
+		states.
+		@return A value in [0, 1], or 1 if no fixed timestep loop is running.
+		*/
+		float interpolationAlpha() const;
+
+		/*!
+		@brief Returns a snapshot of a loop's wake-up errors, that is how late the loop woke up compared to its deadline
+		on every tick. Loops keep their statistics after they end.
+		@throw std::runtime_error Throws if no loop with this name was started in this runner.
+		@param loopName The name of the loop.
+		@return A copy of the loop's wake-up error histogram.
+		*/
+		LatencyHistogram wakeUpErrors(const std::string& loopName) const;
+
+		/*!
+		@brief Returns a snapshot of a loop's tick statistics: work and sleep times, overruns, achieved tick rate and work
+		time percentiles. Cheap enough to be polled every frame, and never blocks the loop's thread. Loops keep their
+		statistics after they end.
+		@throw std::runtime_error Throws if no loop with this name was started in this runner.
+		@param loopName The name of the loop.
+		@return The loop's statistics.
+		*/
+		LoopTelemetry telemetry(const std::string& loopName) const;
+
+		/*!
+		@brief Lists the names of every loop started in this runner, to be used with telemetry() and wakeUpErrors().
+		@return The names of the loops, in start order.
+		*/
+		std::vector<std::string> loopNames() const;
+
+		/*!
+		@brief Submits a job to the worker pool. When called from a worker, the job is pushed on that worker's own queue
+		(where it is likely to be picked up while still hot in cache); otherwise, queues are picked in a round-robin fashion.
+		@note Exceptions escaping a job submitted this way are fatal. Use a TaskGroup to get them back on the waiting thread.
+		@param job The job to execute.
+		*/
+		void submit(Job job) override;
+
+		/*!
+		@brief Executes func for every index in [begin, end), splitting the range in chunks of grainSize indices spread
+		over the worker pool. The calling thread takes part in the work and only returns once every index is processed.
+		@throw Rethrows the first exception thrown by func, once the whole range is done.
+		@param begin The first index of the range.
+		@param end The index past the last index of the range.
+		@param func The function to execute for every index.
+		@param grainSize The amount of indices processed by a single job. Raise it when func is very cheap.
+		*/
+		void parallelFor(size_t begin, size_t end, const InplaceFunction<void(size_t)>& func, size_t grainSize = 1) override;
+
+		/*!
+		@brief Getter for the amount of worker threads in the pool.
+		@return The amount of worker threads.
+		*/
+		size_t workerCount() const;
+
+		/*!
+		@brief Getter for the logical CPUs kept off-limits to the workers, on which loops can be pinned.
+		@return The reserved logical CPUs.
+		*/
+		const std::vector<size_t>& reservedCpus() const;
 
 		/*!
-		@brief Signals all thread that they should join, and therefore end execution.
+		@brief Signals all thread that they should join, and therefore end execution. Stops the worker pool once every
+		loop has joined.
 		*/
 		void joinAll();
 
@@ -78,33 +275,206 @@ namespace Orbit
 		*/
 		bool shouldJoin() const;
 
+		/*!
+		@brief Computes a sensible default amount of workers, leaving one hardware thread for the calling loop.
+		@return The default amount of workers.
+		*/
+		static size_t defaultWorkerCount();
+
 	private:
+		friend class TaskGroup;
+
+		/*!
+		@brief Structure holding a queued job along with the group that forked it, if any.
+		*/
+		struct QueuedJob
+		{
+			/*! The job to execute. */
+			Job job;
+			/*! The group that forked the job, or nullptr if it was submitted directly. */
+			const TaskGroup* group = nullptr;
+		};
+
+		/*!
+		@brief Structure holding a worker's job queue and thread. The owning worker pops from the back of its queue,
+		while other threads steal from the front.
+		*/
+		struct Worker
+		{
+			/*! Mutex protecting the job queue. */
+			std::mutex mutex;
+			/*! The worker's job queue. */
+			std::deque<QueuedJob> jobs;
+			/*! The worker's thread. */
+			std::thread thread;
+		};
+
+		/*!
+		@brief Structure holding a loop's settings and statistics. Loops are heap-allocated, so that their address stays
+		valid for their thread while other loops get registered.
+		*/
+		struct Loop
+		{
+			/*! The loop's settings. */
+			LoopOptions options;
+			/*! Mutex protecting the statistics, as they are read from other threads. */
+			mutable std::mutex statisticsMutex;
+			/*! How late the loop woke up compared to its deadline, on every tick. */
+			LatencyHistogram wakeUpErrors;
+			/*! The loop's tick statistics. Lock-free, as they are recorded on every tick. */
+			TickTelemetry telemetry;
+			/*! Whether or not every thread setting of the loop could be applied, reported through its telemetry. */
+			std::atomic<bool> settingsApplied{ true };
+		};
+
 		/*!
 		@brief Actual implementation of the function that is run either on the current thread (bare) or on another thread
 		(wrapped by an std::thread).
 		@param parentRunner A reference to the parent TaskRunner object, to check if it should join.
+		@param loop The loop's settings and statistics.
 		@param targetTPS The target amount of ticks per second for the function. Sleeps otherwise.
 		@param end The end condition, taken as a function execution.
 		@param run The function to actually run on every tick.
 		*/
 		static void run_func(
 			const TaskRunner& parentRunner,
-			size_t targetTPS, 
-			const std::function<bool()>& end, 
-			const std::function<void()>& run);
+			Loop& loop,
+			size_t targetTPS,
+			LoopCondition end,
+			LoopFunction run);
 
 		/*! @copydoc TaskRunner:run_func() */
 		static void run_func_tick(
 			const TaskRunner& parentRunner,
+			Loop& loop,
 			size_t targetTPS,
-			const std::function<bool()>& end,
-			const std::function<void(std::chrono::nanoseconds)>& run);
+			LoopCondition end,
+			TimedLoopFunction run);
+
+		/*!
+		@brief Implementation of the fixed timestep loop.
+		@see Orbit::TaskRunner::runFixed()
+		@param parentRunner A reference to the parent TaskRunner object, to check if it should join and publish tick times.
+		@param loop The loop's settings and statistics.
+		@param targetTPS The amount of ticks per second.
+		@param end The end condition, taken as a function execution.
+		@param run The function to actually run on every tick.
+		*/
+		static void run_func_fixed(
+			TaskRunner& parentRunner,
+			Loop& loop,
+			size_t targetTPS,
+			LoopCondition end,
+			TimedLoopFunction run);
+
+		/*!
+		@brief Waits until the deadline using the loop's pacing mode, then records how late the wake-up was.
+		@param loop The loop's settings and statistics.
+		@param deadline The time at which the loop's next tick is due.
+		@return The time spent waiting.
+		*/
+		static std::chrono::nanoseconds pace(Loop& loop, std::chrono::steady_clock::time_point deadline);
+
+		/*!
+		@brief Applies a loop's thread settings (name, CPUs and priority) to the calling thread, on a best-effort basis.
+		Settings that could not be applied (usually priorities, for lack of privileges) are reported in the loop's
+		telemetry.
+		@param loop The loop's settings and statistics.
+		*/
+		static void applyLoopSettings(Loop& loop);
+
+		/*!
+		@brief Computes the thread settings of a worker from the runner's worker options.
+		@param index The index of the worker in the pool.
+		@return The worker's thread settings.
+		*/
+		ThreadSettings workerSettings(size_t index) const;
+
+		/*!
+		@brief Registers a new loop, generating a name for it if it has none.
+		@throw std::runtime_error Throws if a loop with the same name was already registered.
+		@param options The loop's settings.
+		@return A reference to the registered loop, valid for the runner's lifetime.
+		*/
+		Loop& registerLoop(const LoopOptions& options);
+
+		/*!
+		@brief Flags the fixed timestep loop as running, then registers it.
+		@see Orbit::TaskRunner::registerLoop()
+		@throw std::runtime_error Throws if a fixed timestep loop is already running, or if the loop's name is taken.
+		@param options The loop's settings.
+		@return A reference to the registered loop, valid for the runner's lifetime.
+		*/
+		Loop& registerFixedLoop(const LoopOptions& options);
+
+		/*!
+		@brief Main loop of a worker thread. Executes pending jobs, sleeping when there are none left.
+		@param parentRunner A reference to the parent TaskRunner object.
+		@param index The index of the worker in the pool.
+		*/
+		static void worker_func(TaskRunner& parentRunner, size_t index);
+
+		/*!
+		@brief Queues a job on the current worker's queue or, from outside the pool, on the next queue in round-robin order.
+		@param job The job to execute.
+		@param group The group that forked the job, or nullptr if it was submitted directly.
+		*/
+		void push(Job job, const TaskGroup* group);
+
+		/*!
+		@brief Pops a job from the current worker's queue or, failing that, steals one from another worker.
+		@param job The popped job, if any.
+		@param group If not nullptr, only jobs forked by this group are popped.
+		@return Whether or not a job was found.
+		*/
+		bool popJob(Job& job, const TaskGroup* group = nullptr);
+
+		/*!
+		@brief Executes a single pending job on the calling thread, if there is one. Used by waiting threads to help out
+		instead of blocking.
+		@param group If not nullptr, only jobs forked by this group are executed. Threads joining a group pass it, so that
+		they never pick up unrelated long-running work (like a polling coroutine) and stall the join.
+		@return Whether or not a job was executed.
+		*/
+		bool runPendingJob(const TaskGroup* group = nullptr);
+
+		/*!
+		@brief Stops and joins every worker thread. Jobs submitted afterwards are executed inline.
+		*/
+		void stopWorkers();
 
 		/*! Whether or not every task in the runner should join. */
 		std::atomic<bool> _shouldJoin = false;
 
 		/*! Collection of threads owned by the class. */
 		std::vector<std::thread> _threads;
+
+		/*! Every loop started in the runner. */
+		std::vector<std::unique_ptr<Loop>> _loops;
+		/*! Mutex protecting the loop collection. */
+		mutable std::mutex _loopsMutex;
+
+		/*! Whether or not a fixed timestep loop is running. */
+		std::atomic<bool> _fixedLoopRunning = false;
+		/*! The fixed timestep loop's step, in nanoseconds. */
+		std::atomic<std::chrono::nanoseconds::rep> _fixedStep = 0;
+		/*! The scheduled time of the fixed timestep loop's last tick, in nanoseconds since the steady clock's epoch. */
+		std::atomic<std::chrono::nanoseconds::rep> _lastFixedTick = 0;
+
+		/*! The settings of the worker threads. */
+		WorkerOptions _workerOptions;
+		/*! The worker pool. Workers are heap-allocated as they hold non-movable synchronization primitives. */
+		std::vector<std::unique_ptr<Worker>> _workers;
+		/*! Whether or not the workers should stop. */
+		std::atomic<bool> _stopWorkers = false;
+		/*! Amount of jobs queued but not yet picked up. */
+		std::atomic<size_t> _pendingJobs = 0;
+		/*! Round-robin counter used to pick a queue for jobs submitted from outside the pool. */
+		std::atomic<size_t> _nextWorker = 0;
+		/*! Mutex used along with _workerCondition to put idle workers to sleep. */
+		std::mutex _workerMutex;
+		/*! Condition variable on which idle workers sleep. */
+		std::condition_variable _workerCondition;
 	};
 }
 
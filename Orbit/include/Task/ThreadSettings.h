@@ -0,0 +1,63 @@
+/*! @file Task/ThreadSettings.h */
+
+#ifndef TASK_THREADSETTINGS_H
+#define TASK_THREADSETTINGS_H
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Orbit
+{
+	/*!
+	@brief Definition of the scheduling priorities a thread can be given.
+	*/
+	enum class ThreadPriority : int
+	{
+		/*! Below the default priority (nice 10 on Linux). */
+		Low,
+		/*! The OS' default priority. Nothing is changed. */
+		Normal,
+		/*! Above the default priority (nice -10 on Linux). Usually requires elevated privileges. */
+		High,
+		/*! Real-time priority (SCHED_FIFO on Linux, time critical on Windows). Usually requires elevated privileges, and
+		can starve the rest of the system if the thread never blocks. */
+		RealTime
+	};
+
+	/*!
+	@brief Scheduling settings of a thread: its name, the logical CPUs it may run on and its priority.
+	*/
+	struct ThreadSettings final
+	{
+		/*! The thread's name, as shown in debuggers and profilers. Truncated to 15 characters on Linux. Left as-is if empty. */
+		std::string name;
+		/*! The logical CPUs the thread is pinned to. The thread may run anywhere if empty. */
+		std::vector<size_t> cpus;
+		/*! The thread's scheduling priority. */
+		ThreadPriority priority = ThreadPriority::Normal;
+	};
+
+	/*!
+	@brief Applies settings to the calling thread. Settings are applied on a best-effort basis, as some (i.e. raising the
+	priority) commonly require privileges the process does not have.
+	@param settings The settings to apply.
+	@return Whether or not every setting could be applied.
+	*/
+	bool applyThreadSettings(const ThreadSettings& settings);
+
+	/*!
+	@brief Lists the logical CPUs the process is allowed to run on.
+	@return The indices of the available logical CPUs, in ascending order.
+	*/
+	std::vector<size_t> availableCpus();
+
+	/*!
+	@brief Groups the available logical CPUs by physical core, so that a thread can be given a core to itself (including
+	its hyperthread siblings). Falls back to one logical CPU per core when the topology cannot be queried.
+	@return The logical CPUs of every physical core, in ascending order of their first CPU.
+	*/
+	std::vector<std::vector<size_t>> physicalCores();
+}
+
+#endif //TASK_THREADSETTINGS_H
\ No newline at end of file
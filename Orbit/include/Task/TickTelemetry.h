@@ -0,0 +1,105 @@
+/*! @file Task/TickTelemetry.h */
+
+#ifndef TASK_TICKTELEMETRY_H
+#define TASK_TICKTELEMETRY_H
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Orbit
+{
+	/*!
+	@brief Snapshot of a loop's tick statistics. Totals cover the loop's whole lifetime, while rates and percentiles cover
+	its last ticks only (up to TickTelemetry::WindowSize of them).
+	*/
+	struct LoopTelemetry final
+	{
+		/*! The amount of ticks run so far. */
+		uint64_t ticks = 0;
+		/*! The amount of ticks whose work went past the next tick's deadline. */
+		uint64_t overruns = 0;
+
+		/*! The total time spent running ticks. */
+		std::chrono::nanoseconds totalWorkTime = std::chrono::nanoseconds::zero();
+		/*! The total time spent waiting for the next tick. */
+		std::chrono::nanoseconds totalSleepTime = std::chrono::nanoseconds::zero();
+
+		/*! The amount of ticks covered by the window. */
+		size_t windowTicks = 0;
+		/*! The tick rate actually achieved over the window, in ticks per second. */
+		double tickRate = 0.0;
+		/*! The median work time of a tick over the window. */
+		std::chrono::nanoseconds workTimeP50 = std::chrono::nanoseconds::zero();
+		/*! The 95th percentile of a tick's work time over the window. */
+		std::chrono::nanoseconds workTimeP95 = std::chrono::nanoseconds::zero();
+		/*! The 99th percentile of a tick's work time over the window. */
+		std::chrono::nanoseconds workTimeP99 = std::chrono::nanoseconds::zero();
+
+		/*! Whether or not every thread setting of the loop (name, CPUs and priority) could be applied to its thread. */
+		bool settingsApplied = true;
+	};
+
+	/*!
+	@brief Records a loop's ticks, to be snapshotted from other threads at any time. Recording is wait-free and takes a
+	handful of relaxed atomic stores, so it can stay on in production; snapshots never block the recording thread, and
+	simply leave out the ticks overwritten while they were being taken.
+	@note There must only be one recording thread.
+	*/
+	class TickTelemetry final
+	{
+	public:
+		/*! The amount of most recent ticks kept around for rates and percentiles. */
+		static constexpr size_t WindowSize = 512;
+
+		/*!
+		@brief Records a tick. Recording thread only.
+		@param tickStart The time at which the tick started.
+		@param workTime The time spent running the tick.
+		@param sleepTime The time spent waiting for the next tick afterwards.
+		@param overran Whether or not the tick's work went past the next tick's deadline.
+		*/
+		void record(
+			std::chrono::steady_clock::time_point tickStart,
+			std::chrono::nanoseconds workTime,
+			std::chrono::nanoseconds sleepTime,
+			bool overran);
+
+		/*!
+		@brief Takes a snapshot of the recorded statistics. Safe to call from any thread.
+		@return The snapshot.
+		*/
+		LoopTelemetry snapshot() const;
+
+	private:
+		/*!
+		@brief A single recorded tick. Fields are atomic so that snapshots can read them while they are being overwritten.
+		*/
+		struct Sample
+		{
+			/*! The time at which the tick started, in nanoseconds since the steady clock's epoch. */
+			std::atomic<int64_t> start{ 0 };
+			/*! The time spent running the tick, in nanoseconds. */
+			std::atomic<int64_t> workTime{ 0 };
+		};
+
+		/*! The amount of stored ticks: one more than the window, as the sample being written cannot be read. */
+		static constexpr size_t SampleCount = WindowSize + 1;
+
+		/*! The last recorded ticks. The tick numbered n is stored at n % SampleCount. */
+		std::array<Sample, SampleCount> _samples;
+
+		/*! The amount of recorded ticks. Published last, so that the samples it covers are complete. */
+		std::atomic<uint64_t> _ticks{ 0 };
+		/*! The amount of ticks that overran. */
+		std::atomic<uint64_t> _overruns{ 0 };
+		/*! The total time spent running ticks, in nanoseconds. */
+		std::atomic<int64_t> _totalWorkTime{ 0 };
+		/*! The total time spent waiting, in nanoseconds. */
+		std::atomic<int64_t> _totalSleepTime{ 0 };
+	};
+}
+
+#endif //TASK_TICKTELEMETRY_H
\ No newline at end of file
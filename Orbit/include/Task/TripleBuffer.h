@@ -0,0 +1,91 @@
+/*! @file Task/TripleBuffer.h */
+
+#ifndef TASK_TRIPLEBUFFER_H
+#define TASK_TRIPLEBUFFER_H
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Orbit
+{
+	/*!
+	@brief Lock-free single producer, single consumer hand-off of values of type T. The producer fills its own buffer then
+	publishes it; the consumer picks up the latest published buffer whenever it wants to. Neither side ever waits for the
+	other: values published while the consumer is busy are simply skipped in favour of newer ones.
+	@note Buffers are recycled, so the producer's buffer holds stale data from an older value and must be fully rewritten.
+	@tparam T The type of the exchanged values.
+	*/
+	template<typename T>
+	class TripleBuffer final
+	{
+	public:
+		/*!
+		@brief Getter for the producer's buffer, to be filled before publishing it. Producer thread only.
+		@return A reference to the producer's buffer.
+		*/
+		T& writeBuffer()
+		{
+			return _buffers[_writeIndex];
+		}
+
+		/*!
+		@brief Publishes the producer's buffer, making it the latest value. The producer then gets another buffer to fill.
+		Producer thread only.
+		*/
+		void publish()
+		{
+			_writeIndex = _latest.exchange(static_cast<uint8_t>(_writeIndex | FreshFlag), std::memory_order_acq_rel) & IndexMask;
+		}
+
+		/*!
+		@brief Returns whether or not a value was published since the consumer last picked one up. Consumer thread only.
+		@return Whether or not a newer value is available.
+		*/
+		bool hasFresh() const
+		{
+			return (_latest.load(std::memory_order_relaxed) & FreshFlag) != 0;
+		}
+
+		/*!
+		@brief Picks up the latest published value, if there is a newer one than the consumer's. Consumer thread only.
+		@return Whether or not a newer value was picked up.
+		*/
+		bool consume()
+		{
+			if (!hasFresh())
+				return false;
+
+			_readIndex = _latest.exchange(_readIndex, std::memory_order_acq_rel) & IndexMask;
+			return true;
+		}
+
+		/*!
+		@brief Getter for the consumer's buffer, holding the last value picked up. Consumer thread only.
+		@return A reference to the consumer's buffer.
+		*/
+		const T& readBuffer() const
+		{
+			return _buffers[_readIndex];
+		}
+
+	private:
+		/*! Mask extracting the buffer index from the shared state. */
+		static constexpr uint8_t IndexMask = 0x3;
+		/*! Flag set in the shared state when the latest buffer has not been picked up yet. */
+		static constexpr uint8_t FreshFlag = 0x4;
+
+		/*! The three buffers: the producer's, the consumer's and the latest published one. */
+		std::array<T, 3> _buffers;
+
+		/*! Index of the producer's buffer. Only touched by the producer. */
+		alignas(64) uint8_t _writeIndex = 0;
+		/*! Index of the latest published buffer, along with the fresh flag. The only state shared by both threads. */
+		alignas(64) std::atomic<uint8_t> _latest{ 1 };
+		/*! Index of the consumer's buffer. Only touched by the consumer. */
+		alignas(64) uint8_t _readIndex = 2;
+	};
+}
+
+#endif //TASK_TRIPLEBUFFER_H
\ No newline at end of file
@@ -4,18 +4,29 @@
 #define VISITORS_MODELVISITOR_H
 #pragma once
 
+#include <Game/CompositeTree/Node.h>
 #include <Game/CompositeTree/Visitor.h>
 
 #include "Render/Renderer.h"
+#include <Render/Frustum.h>
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace Orbit
 {
 	class Model;
 
 	/*!
-	@brief Simple visitor implementation to retrieve models from the composite tree.
+	@brief Simple visitor implementation to retrieve models from the composite tree. Instances outside of the view
+	frustum are culled on the way, so that only visible instances reach the renderer, and the others are committed at the
+	level of detail matching their size on screen.
+	Models keep their place in the tree state from one iteration to the next for as long as the tree has instances of
+	them, in view or not: only the instances change, so that the renderer only reloads its models when models come and go.
+	Levels of detail are kept along with their model, so that instances switching levels do not change the models either.
+	The instances of the last flushed iteration are kept as well, so that every instance of the tree state comes with its
+	transform as of the previous iteration, for the renderer to blend from.
 	*/
 	class ModelVisitor final : public Visitor
 	{
@@ -38,46 +49,139 @@ namespace Orbit
 		void visitElement(Node* node) override;
 
 		/*!
-		@brief Returns whether or not the models (and counts of models) have changed since the last update.
-		If true, it indicates that the rendering tree's state is different that on the last iteration and
-		that an update to graphics memory is required (depending on the renderer used).
-		@return If the composite tree's state has changed.
+		@brief Statically dispatched counterpart of visitElement(), meant for Orbit::CompositeNode::forEach(). Inlined into
+		the traversal, and does not copy the node's model pointer unless it is the first node found with this model.
+		Nodes whose world bounds lie outside of the frustum are counted, then skipped, their model staying in the tree state.
+		@param node The node to visit.
 		*/
-		bool modelCountsChanged() const;
+		void collect(const Node& node)
+		{
+			const std::shared_ptr<Model>& model = node.model();
+			if (!model)
+				return;
+
+			size_t bucket = findBucket(model);
+
+			_testedInstances++;
+			if (!_frustum.intersects(node.worldBounds()))
+			{
+				_culledInstances++;
+				return;
+			}
+
+			commitModel(bucket, node);
+		}
 
 		/*!
-		@brief Flushes the model counts from the last iteration to the "saved" state. The in-progress
-		model states are saved and will be tested against by modelCountsChanged.
+		@brief Sets the view instances are culled against and their level of detail is selected from, until set again.
+		@param view The view matrix.
+		@param projection The projection matrix.
 		*/
-		void flushModelCounts();
+		void setView(const glm::mat4& view, const glm::mat4& projection);
+
+		/*!
+		@brief Resets the view: instances are no longer culled, and are committed at full detail.
+		*/
+		void clearView();
+
+		/*!
+		@brief Getter for the amount of instances tested against the frustum during the last flushed iteration.
+		@return The amount of instances (nodes with a model) visited.
+		*/
+		size_t testedInstances() const;
+
+		/*!
+		@brief Getter for the amount of instances culled during the last flushed iteration.
+		@return The amount of instances found to be outside of the frustum, and left out of the tree state.
+		*/
+		size_t culledInstances() const;
 
 		/*!
-		@brief Computes the collection of ModelCountPairs from the inner transforms map for reloading purposes.
-		@return A collection of ModelCountPairs.
+		@brief Fills in the previous transforms of the current iteration's instances, from the last flushed iteration. To
+		be called once every node was collected. Instances are matched by id, so that instances changing models (i.e.
+		levels of detail) are still blended with themselves; instances that were not in the tree state keep their current
+		transform.
 		*/
-		std::vector<Renderer::ModelCountPair> modelCounts() const;
+		void matchPreviousTransforms();
+
+		/*!
+		@brief Ends the iteration: its instances become the previous ones, and its culling counters are saved. Models no
+		instance was found of during the iteration are dropped from the tree state, the others are kept in the same order,
+		without instances. Whether the models changed is up to the renderer, which compares the published tree state with
+		the models it loaded.
+		*/
+		void flushModelCounts();
 
 		/*!
 		@brief Returns a reference to the interior collection of models and transforms, effectively translating
 		the state of the composite tree.
 		@return A reference to the interior collection of models and transforms.
 		*/
-		const std::vector<Renderer::ModelTransformsPair>& treeState() const;
+		const std::vector<FramePacket::ModelInstances>& treeState() const;
 
 	private:
 		/*!
-		@brief Commits a model and a transform to the tree state. Handles insertions in the collection and
-		updating of already existing values.
-		@param model The model to insert/update.
-		@param transform The new transform to add.
+		@brief Finds the place of a model in the tree state, adding it (along with its levels of detail) if it is not there
+		yet, and flags it as in use.
+		@param model The model.
+		@return The index of the model in the tree state.
+		*/
+		size_t findBucket(const std::shared_ptr<Model>& model);
+
+		/*!
+		@brief Commits a node's instance to the tree state. Models with levels of detail are swapped for the level matching
+		the instance's projected size, each level being a bucket of its own.
+		@param bucket The index of the node's model in the tree state.
+		@param node The node.
 		*/
-		void commitModel(std::shared_ptr<Model> model, const glm::mat4& transform);
+		void commitModel(size_t bucket, const Node& node);
+
+		/*!
+		@brief Estimates the projected size of an instance, from its bounding sphere.
+		@param bounds The instance's world-space bounds.
+		@return The instance's size on screen, as a fraction of the viewport's height.
+		*/
+		float screenSize(const AABB& bounds) const;
+
+		/*!
+		@brief The instances of a model as of the last flushed iteration.
+		*/
+		struct PreviousInstances
+		{
+			/*! The transforms of the instances. */
+			std::vector<glm::mat4> transforms;
+			/*! The ids of the instances, matching the transforms. */
+			std::vector<uint64_t> ids;
+		};
 
-		/*! The model counts. Updated when Orbit::ModelVisitor::flushModelCounts() is called. */
-		std::vector<Renderer::ModelCountPair> _oldModelCounts;
 		/*! The current retrieved state of the composite tree. */
-		std::vector<Renderer::ModelTransformsPair> _retrievedTreeState;
+		std::vector<FramePacket::ModelInstances> _retrievedTreeState;
+		/*! The instances of each model of the tree state as of the last flushed iteration, in the same order. */
+		std::vector<PreviousInstances> _previousTreeState;
+		/*! Scratch index of the last flushed iteration's transforms by instance id, for the models whose instances changed. */
+		std::unordered_map<uint64_t, const glm::mat4*> _previousTransformsById;
+		/*! Whether or not an instance of each model of the tree state was found during the current iteration. */
+		std::vector<bool> _usedBuckets;
+		/*! The bucket found last, looked at first, as instances of a model tend to be visited in a row. */
+		size_t _lastBucket = 0;
+
+		/*! The frustum instances are culled against. */
+		Frustum _frustum;
+		/*! The position of the viewer, in world space. */
+		glm::vec3 _eye;
+		/*! The projection's vertical scale: cot(fov / 2) for perspective projections. 0 to disable levels of detail. */
+		float _projectionScale = 0.f;
+		/*! Whether or not the projection is orthographic, in which case sizes on screen do not depend on distance. */
+		bool _orthographic = false;
+		/*! The amount of instances tested in the current iteration. */
+		size_t _testedInstances = 0;
+		/*! The amount of instances culled in the current iteration. */
+		size_t _culledInstances = 0;
+		/*! The amount of instances tested in the last flushed iteration. */
+		size_t _lastTestedInstances = 0;
+		/*! The amount of instances culled in the last flushed iteration. */
+		size_t _lastCulledInstances = 0;
 	};
 }
 
-#endif //VISITORS_MODELVISITOR_H
+#endif //VISITORS_MODELVISITOR_H
\ No newline at end of file
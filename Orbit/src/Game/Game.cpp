@@ -8,6 +8,7 @@
 #include "Task/TaskRunner.h"
 
 #include <Game/CompositeTree/CompositeTree.h>
+#include <Game/FrameGraph.h>
 #include <Game/Mod.h>
 #include <Game/MainModule.h>
 #include <Game/Scene.h>
@@ -17,6 +18,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <thread>
 
 using namespace Orbit;
 
@@ -24,7 +26,8 @@ Game::Game(TaskRunner& taskRunner)
 	: _taskRunner(taskRunner),
 	_currentScene(nullptr),
 	_nextScene(nullptr),
-	_tree(std::make_unique<CompositeTree>())
+	_tree(std::make_unique<CompositeTree>()),
+	_frameScheduler(taskRunner)
 {
 }
 
@@ -35,7 +38,8 @@ Game::Game(Window& window, TaskRunner& taskRunner)
 	_taskRunner(taskRunner), 
 	_currentScene(nullptr),
 	_nextScene(nullptr),
-	_tree(std::make_unique<CompositeTree>())
+	_tree(std::make_unique<CompositeTree>()),
+	_frameScheduler(taskRunner)
 {
 }
 
@@ -45,6 +49,13 @@ void Game::initialize()
 	_mainModule = std::unique_ptr<MainModule>(getMainModule());
 	_mainModule->load();
 
+	// Build up the tick's phases. The main module and mods then get to insert their own.
+	loadPhases();
+
+	// Large scenes make the tree update the most expensive part of the tick: spread it over the workers.
+	_tree->setUpdateExecutor(&_taskRunner);
+	_mainModule->loadPhases(_frameGraph);
+
 	// TEMP
 	glm::ivec2 windowSize = _window->input()->windowSize();
 	_projection.setFoV(glm::radians(45.f));
@@ -62,6 +73,7 @@ void Game::initialize()
 	{
 		std::unique_ptr<ModLibrary> modLib = std::make_unique<ModLibrary>("Mods\\" + modName + "\\" + modName);
 		(*modLib)->load();
+		(*modLib)->loadPhases(_frameGraph);
 		_modStack.push(std::move(modLib));
 	}
 
@@ -75,18 +87,29 @@ void Game::initialize()
 	// Temporary test: register Spacebar to "Fire".
 	_window->input()->registerVirtualKey("Fire", Key::Code::Space);
 
-	// Begin the update thread.
-	_taskRunner.runAsync(144, [this] {
+	// Begin the update thread. Fixed timestep, so that the simulation does not depend on scheduling jitter. It gets the
+	// CPUs reserved in the runner, if any, and is bumped up in priority when allowed to.
+	LoopOptions updateOptions;
+	updateOptions.name = "Update";
+	updateOptions.cpus = _taskRunner.reservedCpus();
+	updateOptions.priority = ThreadPriority::High;
+
+	_taskRunner.runFixedAsync(144, [this] {
 		return shouldClose();
 	},
 	[this](std::chrono::nanoseconds time) {
 		update(time);
-	});
+	},
+	updateOptions);
 
 }
 
 void Game::cleanup()
 {
+	// A scene might still be loading on the workers; its coroutine must be done before it can be destroyed.
+	while (!_sceneLoading.ready())
+		std::this_thread::yield();
+
 	while (!_modStack.empty())
 	{
 		std::unique_ptr<ModLibrary> modLib = std::move(_modStack.top());
@@ -106,26 +129,7 @@ bool Game::shouldClose() const
 
 void Game::update(std::chrono::nanoseconds elapsedTime)
 {
-	// Lock the mouse movement for the current frame.
-	_window->input()->lockMouseMovement();
-
-	updateScene();
-
-	_tree->update(elapsedTime);
-
-	_tree->acceptVisitor(&_visitor);
-	if (_visitor.modelCountsChanged())
-		_window->renderer()->loadModels(_visitor.modelCounts());
-
-	if (_tree->getCamera() == nullptr)
-		throw std::runtime_error("Scene has no camera to render!");
-
-	glm::mat4 view = _tree->getCamera()->getViewMatrix();
-	glm::mat4 projection = _projection.getMatrix();
-	_window->renderer()->setupViewProjection(view, projection);
-	_window->renderer()->queueRender(_visitor.treeState());
-
-	_visitor.flushModelCounts();
+	_frameScheduler.execute(_frameGraph, elapsedTime);
 }
 
 void Game::loadScene(std::unique_ptr<Scene> scene)
@@ -133,19 +137,108 @@ void Game::loadScene(std::unique_ptr<Scene> scene)
 	_nextScene = std::move(scene);
 }
 
+void Game::loadPhases()
+{
+	// Phases are listed in the order the tick used to be hand-written in: conflicting phases keep that order, the others
+	// (i.e. the view/projection setup and the model collection) are free to overlap. Nothing here calls into the renderer
+	// itself: the tick's results are written to a frame packet, published for the render thread to pick up.
+	_frameGraph.addPhase({ "LockInput", FrameResource::None, FrameResource::Input, [this](std::chrono::nanoseconds) {
+		// Lock the mouse movement for the current frame.
+		_window->input()->lockMouseMovement();
+	} });
+
+	_frameGraph.addPhase({ "UpdateScene", FrameResource::Input, FrameResource::Scene | FrameResource::Tree,
+		[this](std::chrono::nanoseconds) {
+		updateScene();
+	} });
+
+	_frameGraph.addPhase({ "FireTimers", FrameResource::Input, FrameResource::Tree, [this](std::chrono::nanoseconds elapsedTime) {
+		_tree->timers().advance(elapsedTime);
+	} });
+
+	_frameGraph.addPhase({ "UpdateTree", FrameResource::Input, FrameResource::Tree, [this](std::chrono::nanoseconds elapsedTime) {
+		_tree->update(elapsedTime);
+	} });
+
+	_frameGraph.addPhase({ "CollectModels", FrameResource::Tree, FrameResource::ModelVisitor, [this](std::chrono::nanoseconds) {
+		// Cull and select levels of detail against the view the packet is about to be given. Without a camera, the view
+		// setup fails the tick anyway.
+		std::shared_ptr<CameraNode> camera = _tree->getCamera();
+		if (camera)
+			_visitor.setView(camera->getViewMatrix(), _projection.getMatrix());
+		else
+			_visitor.clearView();
+
+		_tree->forEach([this](const Node& node) {
+			_visitor.collect(node);
+		});
+
+		_visitor.matchPreviousTransforms();
+	} });
+
+	_frameGraph.addPhase({ "SetupViewProjection", FrameResource::Tree, FrameResource::RenderView, [this](std::chrono::nanoseconds) {
+		std::shared_ptr<CameraNode> camera = _tree->getCamera();
+		if (camera == nullptr)
+			throw std::runtime_error("Scene has no camera to render!");
+
+		FramePacket& packet = _window->renderer()->framePacket();
+		packet.view = camera->getViewMatrix();
+		packet.projection = _projection.getMatrix();
+
+		// The very first packet has nothing to be blended with.
+		packet.previousView = _publishedFrames ? _previousView : packet.view;
+		packet.previousProjection = _publishedFrames ? _previousProjection : packet.projection;
+		_previousView = packet.view;
+		_previousProjection = packet.projection;
+	} });
+
+	_frameGraph.addPhase({ "QueueRender", FrameResource::ModelVisitor, FrameResource::RenderInstances, [this](std::chrono::nanoseconds) {
+		_window->renderer()->framePacket().models = _visitor.treeState();
+	} });
+
+	_frameGraph.addPhase({ "PublishFrame", FrameResource::None, FrameResource::RenderView | FrameResource::RenderInstances,
+		[this](std::chrono::nanoseconds) {
+		FramePacket& packet = _window->renderer()->framePacket();
+		packet.index = ++_publishedFrames;
+		_window->renderer()->publishFramePacket();
+	} });
+
+	_frameGraph.addPhase({ "FlushModelCounts", FrameResource::None, FrameResource::ModelVisitor, [this](std::chrono::nanoseconds) {
+		_visitor.flushModelCounts();
+	} });
+}
+
 void Game::updateScene()
 {
-	if (!_nextScene)
+	if (!_loadingScene && _nextScene)
+	{
+		// Load the factories (textures, models...) off the update thread.
+		_loadingScene = std::move(_nextScene);
+		_sceneLoading = _loadingScene->loadFactoriesAsync(*_window->input(), _taskRunner);
+		_sceneLoading.start();
+	}
+
+	if (!_loadingScene)
 		return;
 
+	if (!_sceneLoading.ready())
+	{
+		// Keep running the current scene while the next one loads. Without one, there is nothing to show in the meantime.
+		if (_currentScene)
+			return;
+
+		while (!_sceneLoading.ready())
+			std::this_thread::yield();
+	}
+
+	Task<> sceneLoading = std::move(_sceneLoading);
+	sceneLoading.get();
+
 	if (_currentScene)
 		_currentScene->unload();
 
 	_tree->clearChildren();
 
-	_currentScene = std::move(_nextScene);
-	_nextScene = nullptr;
-
-	_currentScene->loadFactories(*_window->input());
+	_currentScene = std::move(_loadingScene);
 	_currentScene->load(*_tree);
 }
\ No newline at end of file
@@ -213,7 +213,7 @@ VulkanBuffer::Block::Block(
 
 void VulkanBuffer::Block::copy(const void* data, vk::DeviceSize size)
 {
-	ASSERT_DEBUG(size == _size, "Tried to copy memory of mismatching sizes!");
+	ASSERT_DEBUG(size <= _size, "Tried to copy more memory than the block holds!");
 
 	void* copyRegion = _base->device().mapMemory(_memory, _offset, size);
 	memcpy(copyRegion, data, size);
@@ -19,6 +19,27 @@
 
 using namespace Orbit;
 
+namespace
+{
+	/*! The least amount of instances a model's transform block holds. */
+	constexpr size_t MinimumInstanceCapacity = 16;
+
+	/*!
+	@brief Computes the capacity of a transform block: a power of two, so that a model whose instance count keeps growing
+	only has the transform buffer recreated a logarithmic amount of times.
+	@param count The amount of instances the block must hold.
+	@return The block's capacity.
+	*/
+	size_t instanceCapacity(size_t count)
+	{
+		size_t capacity = MinimumInstanceCapacity;
+		while (capacity < count)
+			capacity *= 2;
+
+		return capacity;
+	}
+}
+
 VulkanRenderer::~VulkanRenderer()
 {
 	if (!_base)
@@ -81,7 +102,7 @@ void VulkanRenderer::flagResize(const glm::ivec2& newSize)
 		_secondaryGraphicsCommandBuffers);
 }
 
-void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
+void VulkanRenderer::loadModels(const std::vector<FramePacket::ModelInstances>& models)
 {
 	waitDeviceIdle();
 
@@ -96,16 +117,13 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 	std::vector<vk::DeviceSize> textureDataBlocks;
 	std::vector<vk::Extent2D> textureExtents;
 
-	// Create transform buffer (sizes used later on)
-	std::vector<vk::DeviceSize> transformBlockSizes = { static_cast<vk::DeviceSize>(sizeof(glm::mat4)) };
-
 	_modelData.reserve(models.size());
-	for (const Renderer::ModelCountPair& modelCountPair : models)
+	for (const FramePacket::ModelInstances& modelInstances : models)
 	{
-		modelDataBlocks.push_back(static_cast<vk::DeviceSize>(modelCountPair.first->getVertices().size() * Vertex::size()));
-		modelDataBlocks.push_back(static_cast<vk::DeviceSize>(modelCountPair.first->getIndices().size() * sizeof(uint32_t)));
+		modelDataBlocks.push_back(static_cast<vk::DeviceSize>(modelInstances.model->getVertices().size() * Vertex::size()));
+		modelDataBlocks.push_back(static_cast<vk::DeviceSize>(modelInstances.model->getIndices().size() * sizeof(uint32_t)));
 
-		if (std::shared_ptr<const Texture> texture = modelCountPair.first->getTexture())
+		if (std::shared_ptr<const Texture> texture = modelInstances.model->getTexture())
 		{
 			textureDataBlocks.push_back(texture->data().size());
 			textureExtents.push_back(vk::Extent2D{
@@ -140,12 +158,12 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 	size_t modelIndex = 0;
 	size_t textureIndex = 0;
 	size_t instanceIndex = 0;
-	for (const Renderer::ModelCountPair& modelCountPair : models)
+	for (const FramePacket::ModelInstances& modelInstances : models)
 	{
-		std::shared_ptr<Model> model = modelCountPair.first;
+		const std::shared_ptr<Model>& model = modelInstances.model;
 
 		ModelData modelData;
-		modelData.weakModel = modelCountPair.first;
+		modelData.weakModel = model;
 		modelData.vertexIndex = modelIndex++;
 		modelData.indicesIndex = modelIndex++;
 
@@ -154,13 +172,11 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 		if (model->getTexture() != nullptr)
 			modelData.textureIndex = textureIndex++;
 
-		modelData.instanceCount = modelCountPair.second;
+		modelData.instanceCapacity = instanceCapacity(modelInstances.transforms.size());
 		modelData.instanceIndex = instanceIndex++;
 
 		_modelData.push_back(modelData);
 
-		transformBlockSizes.push_back(static_cast<vk::DeviceSize>(modelData.instanceCount * sizeof(glm::mat4)));
-
 		vertexStagingBuffer[modelData.vertexIndex].copy(
 			model->getVertices().data(),
 			static_cast<vk::DeviceSize>(model->getVertices().size() * Vertex::size()));
@@ -177,19 +193,6 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 		}
 	}
 
-	// Create transform buffer. Still host coherent and cohesive, since it's going to be overwritten every frame anyways.
-	createInfo.setUsage(
-		vk::BufferUsageFlagBits::eUniformBuffer |
-		vk::BufferUsageFlagBits::eIndirectBuffer |
-		vk::BufferUsageFlagBits::eTransferDst);
-
-	_transformBuffer = VulkanBuffer{
-		_base,
-		transformBlockSizes,
-		createInfo,
-		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-	};
-
 	createInfo.setUsage(
 		vk::BufferUsageFlagBits::eVertexBuffer |
 		vk::BufferUsageFlagBits::eIndexBuffer |
@@ -220,14 +223,8 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 		vk::MemoryPropertyFlagBits::eDeviceLocal
 	};
 
-	// Update the descriptor sets to point to our new buffer (and texture).
-	// Buffer info for the viewProjection transform...
-	vk::DescriptorBufferInfo bufferInfo = vk::DescriptorBufferInfo()
-		.setBuffer(_transformBuffer.buffer())
-		.setOffset(0Ui64)
-		.setRange(static_cast<vk::DeviceSize>(sizeof(glm::mat4)));
-
-	
+	// Update the descriptor sets to point to our new textures. The view/projection transform is pointed to along with the
+	// transform buffer.
 	std::vector<vk::WriteDescriptorSet> descriptorWrites;
 
 	// Need to declare image infos here as to not have memory overriden when used in a loop (since everything uses pointers).
@@ -237,14 +234,6 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 	{
 		vk::DescriptorSet& descriptorSet = modelData.descriptorSet;
 
-		descriptorWrites.push_back(vk::WriteDescriptorSet()
-			.setDstSet(descriptorSet)
-			.setDstBinding(0)
-			.setDstArrayElement(0)
-			.setDescriptorType(vk::DescriptorType::eUniformBuffer)
-			.setDescriptorCount(1)
-			.setPBufferInfo(&bufferInfo));
-
 		if (modelData.textureIndex != std::numeric_limits<size_t>::max())
 		{
 			VulkanImage::Block& imageBlock = _textureImage[modelData.textureIndex];
@@ -295,6 +284,55 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 	vertexStagingBuffer.clear();
 	textureStagingBuffer.clear();
 
+	createInstanceBuffer();
+}
+
+void VulkanRenderer::createInstanceBuffer()
+{
+	std::vector<vk::DeviceSize> transformBlockSizes = { static_cast<vk::DeviceSize>(sizeof(glm::mat4)) };
+	transformBlockSizes.reserve(_modelData.size() + 2);
+
+	for (const ModelData& modelData : _modelData)
+		transformBlockSizes.push_back(static_cast<vk::DeviceSize>(modelData.instanceCapacity * sizeof(glm::mat4)));
+
+	transformBlockSizes.push_back(static_cast<vk::DeviceSize>(_modelData.size() * sizeof(vk::DrawIndexedIndirectCommand)));
+
+	// Still host coherent and cohesive, since it's going to be overwritten every frame anyways.
+	vk::BufferCreateInfo createInfo = vk::BufferCreateInfo()
+		.setUsage(
+			vk::BufferUsageFlagBits::eUniformBuffer |
+			vk::BufferUsageFlagBits::eVertexBuffer |
+			vk::BufferUsageFlagBits::eIndirectBuffer |
+			vk::BufferUsageFlagBits::eTransferDst)
+		.setSharingMode(vk::SharingMode::eExclusive);
+
+	_transformBuffer.clear();
+	_transformBuffer = VulkanBuffer{
+		_base,
+		transformBlockSizes,
+		createInfo,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+	};
+
+	// Buffer info for the viewProjection transform...
+	vk::DescriptorBufferInfo bufferInfo = vk::DescriptorBufferInfo()
+		.setBuffer(_transformBuffer.buffer())
+		.setOffset(0Ui64)
+		.setRange(static_cast<vk::DeviceSize>(sizeof(glm::mat4)));
+
+	std::vector<vk::WriteDescriptorSet> descriptorWrites;
+	descriptorWrites.reserve(_modelData.size());
+	for (const ModelData& modelData : _modelData)
+		descriptorWrites.push_back(vk::WriteDescriptorSet()
+			.setDstSet(modelData.descriptorSet)
+			.setDstBinding(0)
+			.setDstArrayElement(0)
+			.setDescriptorType(vk::DescriptorType::eUniformBuffer)
+			.setDescriptorCount(1)
+			.setPBufferInfo(&bufferInfo));
+
+	_base->device().updateDescriptorSets(descriptorWrites, nullptr);
+
 	destroySecondaryBuffers(
 		_base->device(),
 		_base->graphicsCommandPool(),
@@ -316,43 +354,18 @@ void VulkanRenderer::loadModels(const std::vector<ModelCountPair>& models)
 		std::move(_primaryGraphicsCommandBuffers));
 }
 
-void VulkanRenderer::setupViewProjection(const glm::mat4& view, const glm::mat4& projection)
-{
-	// Flip the middle y coordinate to flip the matrix around (since vulkan is flipped on that coordinate vs OGL).
-	glm::mat4 flippedProjection = projection;
-	flippedProjection[1][1] *= -1;
-	glm::mat4 viewProjection = flippedProjection * view;
-	_transformBuffer[0].copy(&viewProjection, static_cast<vk::DeviceSize>(sizeof(glm::mat4)));
-}
-
-void VulkanRenderer::queueRender(const std::vector<ModelTransformsPair>& modelTransforms)
+void VulkanRenderer::renderFrame(float interpolation)
 {
-	// _modelData (loaded by loadModel()) is assumed to be in the same order as these transforms. Same goes for instances.
-	// They are intended to be traversed by visitors in the tree - as the tree's general state is assumed to not change without
-	// re-recording command buffers (and rebuilding GPU state) this is a non-issue.
-	// This changes every frame.
+	acquireLatestFramePacket();
 
-	if (modelTransforms.size() != _modelData.size())
-		throw std::runtime_error("Renderer is in a weird state!");
-
-	for (size_t i = 0; i < modelTransforms.size(); i++)
-	{
-		const Renderer::ModelTransformsPair& modelTransform = modelTransforms[i];
-		const ModelData& modelData = _modelData[i];
-
-		_transformBuffer.getBlock(i + 1).copy(
-			modelTransform.second.data(),
-			static_cast<vk::DeviceSize>(modelTransform.second.size() * sizeof(glm::mat4)));
-	}
-}
-
-void VulkanRenderer::renderFrame()
-{
 	if (_primaryGraphicsCommandBuffers.empty())
 		return;
 
 	waitDeviceIdle();
 
+	// The device is idle: the transform buffer can be safely overwritten.
+	writeFrameState(interpolation);
+
 	vk::SwapchainKHR swapchain = _pipeline->swapchain();
 	auto imageResult = _base->device().acquireNextImageKHR(swapchain, std::numeric_limits<uint64_t>::max(), _imageSemaphore, nullptr);
 
@@ -391,6 +404,105 @@ void VulkanRenderer::waitDeviceIdle()
 	_base->device().waitIdle();
 }
 
+void VulkanRenderer::acquireLatestFramePacket()
+{
+	if (!acquireFramePacket())
+		return;
+
+	const FramePacket& packet = currentFramePacket();
+	if (!modelsChanged(packet))
+	{
+		reserveInstances(packet);
+		return;
+	}
+
+	loadModels(packet.models);
+}
+
+void VulkanRenderer::reserveInstances(const FramePacket& packet)
+{
+	bool grown = false;
+	for (size_t i = 0; i < packet.models.size(); i++)
+	{
+		ModelData& modelData = _modelData[i];
+		size_t instanceCount = packet.models[i].transforms.size();
+
+		if (instanceCount > modelData.instanceCapacity)
+		{
+			modelData.instanceCapacity = instanceCapacity(instanceCount);
+			grown = true;
+		}
+	}
+
+	if (!grown)
+		return;
+
+	waitDeviceIdle();
+	createInstanceBuffer();
+}
+
+bool VulkanRenderer::modelsChanged(const FramePacket& packet) const
+{
+	if (packet.models.size() != _modelData.size())
+		return true;
+
+	for (size_t i = 0; i < packet.models.size(); i++)
+		if (_modelData[i].weakModel.lock() != packet.models[i].model)
+			return true;
+
+	return false;
+}
+
+void VulkanRenderer::writeFrameState(float interpolation)
+{
+	const FramePacket& packet = currentFramePacket();
+
+	// Nothing was published yet.
+	if (packet.index == 0)
+		return;
+
+	// Flip the middle y coordinate to flip the matrix around (since vulkan is flipped on that coordinate vs OGL).
+	glm::mat4 flippedProjection = packet.projection;
+	flippedProjection[1][1] *= -1;
+	glm::mat4 previousFlippedProjection = packet.previousProjection;
+	previousFlippedProjection[1][1] *= -1;
+
+	glm::mat4 viewProjection =
+		(previousFlippedProjection * packet.previousView) * (1.f - interpolation) +
+		(flippedProjection * packet.view) * interpolation;
+	_transformBuffer[0].copy(&viewProjection, static_cast<vk::DeviceSize>(sizeof(glm::mat4)));
+
+	// _modelData (loaded by loadModels()) is in the same order as the packet's models, which is checked upon acquisition,
+	// and its transform blocks are large enough for the packet's instances.
+	_drawCommands.resize(packet.models.size());
+
+	for (size_t i = 0; i < packet.models.size(); i++)
+	{
+		const FramePacket::ModelInstances& instances = packet.models[i];
+		const std::vector<glm::mat4>& transforms = instances.transforms;
+		const std::vector<glm::mat4>& previousTransforms = instances.previousTransforms;
+		_blendedTransforms.resize(transforms.size());
+
+		// Component-wise blending, which is good enough between two consecutive ticks.
+		for (size_t j = 0; j < transforms.size(); j++)
+			_blendedTransforms[j] = previousTransforms[j] * (1.f - interpolation) + transforms[j] * interpolation;
+
+		if (!transforms.empty())
+			_transformBuffer.getBlock(i + 1).copy(
+				_blendedTransforms.data(),
+				static_cast<vk::DeviceSize>(_blendedTransforms.size() * sizeof(glm::mat4)));
+
+		_drawCommands[i] = vk::DrawIndexedIndirectCommand()
+			.setIndexCount(static_cast<uint32_t>(instances.model->getIndices().size()))
+			.setInstanceCount(static_cast<uint32_t>(transforms.size()));
+	}
+
+	if (!_drawCommands.empty())
+		_transformBuffer.getBlock(packet.models.size() + 1).copy(
+			_drawCommands.data(),
+			static_cast<vk::DeviceSize>(_drawCommands.size() * sizeof(vk::DrawIndexedIndirectCommand)));
+}
+
 std::vector<vk::CommandBuffer> VulkanRenderer::createPrimaryCommandBuffers(
 	const vk::Device& device,
 	const vk::CommandPool& commandPool,
@@ -556,12 +668,13 @@ std::vector<vk::CommandBuffer> VulkanRenderer::createSecondaryCommandBuffers(
 		secondaryBuffer.bindVertexBuffers(0, buffers, offsets);
 		secondaryBuffer.bindIndexBuffer(modelBuffer.buffer(), modelBuffer[modelData.indicesIndex].offset(), vk::IndexType::eUint32);
 
-		secondaryBuffer.drawIndexed(
-			static_cast<uint32_t>(model->getIndices().size()),
-			static_cast<uint32_t>(modelData.instanceCount),
-			0,
-			0,
-			0);
+		// Instance counts change from frame to frame: they are read from the model's indirect draw command, written along
+		// with the transforms, so that command buffers are only recorded again when the buffers themselves change.
+		secondaryBuffer.drawIndexedIndirect(
+			transformBuffer.buffer(),
+			transformBuffer[allModelData.size() + 1].offset() + modelData.instanceIndex * sizeof(vk::DrawIndexedIndirectCommand),
+			1,
+			static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand)));
 
 		secondaryBuffer.end();
 	}
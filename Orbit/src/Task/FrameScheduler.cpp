@@ -0,0 +1,47 @@
+/*! @file Task/FrameScheduler.cpp */
+
+#include "Task/FrameScheduler.h"
+
+#include "Task/TaskGroup.h"
+#include "Task/TaskRunner.h"
+
+#include <Game/FrameGraph.h>
+
+using namespace Orbit;
+
+FrameScheduler::FrameScheduler(TaskRunner& runner)
+	: _runner(runner)
+{
+}
+
+void FrameScheduler::execute(const FrameGraph& graph, std::chrono::nanoseconds elapsedTime)
+{
+	if (graph.size() == 0)
+		return;
+
+	if (_capacity < graph.size())
+	{
+		_remainingDependencies = std::make_unique<std::atomic<size_t>[]>(graph.size());
+		_capacity = graph.size();
+	}
+
+	for (size_t i = 0; i < graph.size(); i++)
+		_remainingDependencies[i] = graph.dependencyCount(i);
+
+	TaskGroup group(_runner);
+
+	InplaceFunction<void(size_t)> runPhase = [&](size_t index) {
+		graph.phase(index).run(elapsedTime);
+
+		// The last dependency to finish is the one starting the successor.
+		for (size_t successor : graph.successors(index))
+			if (--_remainingDependencies[successor] == 0)
+				group.run([&runPhase, successor] { runPhase(successor); });
+	};
+
+	for (size_t i = 0; i < graph.size(); i++)
+		if (graph.dependencyCount(i) == 0)
+			group.run([&runPhase, i] { runPhase(i); });
+
+	group.wait();
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*! @file Task/LatencyHistogram.cpp */
+
+#include "Task/LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace Orbit;
+
+LatencyHistogram::LatencyHistogram(std::chrono::nanoseconds bucketWidth, size_t bucketCount)
+	: _bucketWidth(bucketWidth), _buckets(bucketCount, 0)
+{
+	if (bucketWidth <= std::chrono::nanoseconds::zero() || bucketCount == 0)
+		throw std::runtime_error("A histogram requires at least one bucket of non-zero width!");
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds sample)
+{
+	sample = std::max(sample, std::chrono::nanoseconds::zero());
+
+	size_t bucket = static_cast<size_t>(sample / _bucketWidth);
+	_buckets[std::min(bucket, _buckets.size() - 1)]++;
+
+	_count++;
+	_sum += sample.count();
+	_min = std::min(_min, sample);
+	_max = std::max(_max, sample);
+}
+
+void LatencyHistogram::reset()
+{
+	std::fill(_buckets.begin(), _buckets.end(), 0);
+
+	_count = 0;
+	_sum = 0;
+	_min = std::chrono::nanoseconds::max();
+	_max = std::chrono::nanoseconds::zero();
+}
+
+uint64_t LatencyHistogram::count() const
+{
+	return _count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::min() const
+{
+	return _count == 0 ? std::chrono::nanoseconds::zero() : _min;
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+	return _max;
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const
+{
+	if (_count == 0)
+		return std::chrono::nanoseconds::zero();
+
+	return std::chrono::nanoseconds(_sum / static_cast<std::chrono::nanoseconds::rep>(_count));
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double percentile) const
+{
+	if (_count == 0)
+		return std::chrono::nanoseconds::zero();
+
+	percentile = std::min(std::max(percentile, 0.), 1.);
+	uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile * _count)), 1);
+
+	uint64_t accumulated = 0;
+	for (size_t i = 0; i < _buckets.size(); i++)
+	{
+		accumulated += _buckets[i];
+		if (accumulated >= rank)
+			return std::min(_bucketWidth * static_cast<std::chrono::nanoseconds::rep>(i + 1), _max);
+	}
+
+	return _max;
+}
\ No newline at end of file
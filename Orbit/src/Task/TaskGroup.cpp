@@ -0,0 +1,56 @@
+/*! @file Task/TaskGroup.cpp */
+
+#include "Task/TaskGroup.h"
+
+using namespace Orbit;
+
+TaskGroup::TaskGroup(TaskRunner& runner)
+	: _runner(runner)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+	join();
+}
+
+void TaskGroup::run(Job job)
+{
+	_remainingJobs++;
+
+	_runner.push([this, job = std::move(job)] {
+		try
+		{
+			job();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(_exceptionMutex);
+			if (!_exception)
+				_exception = std::current_exception();
+		}
+
+		_remainingJobs--;
+	}, this);
+}
+
+void TaskGroup::wait()
+{
+	join();
+
+	std::exception_ptr exception;
+	{
+		std::lock_guard<std::mutex> lock(_exceptionMutex);
+		std::swap(exception, _exception);
+	}
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void TaskGroup::join()
+{
+	while (_remainingJobs > 0)
+		if (!_runner.runPendingJob(this))
+			std::this_thread::yield();
+}
\ No newline at end of file
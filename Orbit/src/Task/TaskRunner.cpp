@@ -2,8 +2,56 @@
 
 #include "Task/TaskRunner.h"
 
+#include "Task/TaskGroup.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 using namespace Orbit;
 
+namespace
+{
+	/*! The runner owning the current thread, if the current thread is a worker. */
+	thread_local const TaskRunner* currentRunner = nullptr;
+	/*! The index of the current thread in its runner's pool, if the current thread is a worker. */
+	thread_local size_t currentWorkerIndex = 0;
+
+	/*!
+	@brief Hints the processor that the current thread is spin-waiting, which saves power and frees up resources for the
+	sibling hyperthread.
+	*/
+	inline void cpuRelax()
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#else
+		std::this_thread::yield();
+#endif
+	}
+}
+
+TaskRunner::TaskRunner(size_t workerCount, const WorkerOptions& workerOptions)
+	: _workerOptions(workerOptions)
+{
+	for (size_t i = 0; i < workerCount; i++)
+		_workers.push_back(std::make_unique<Worker>());
+
+	// Start the threads only once the pool is complete, as workers steal from one another.
+	for (size_t i = 0; i < workerCount; i++)
+		_workers[i]->thread = std::thread(worker_func, std::ref(*this), i);
+}
+
 TaskRunner::~TaskRunner()
 {
 	joinAll();
@@ -11,34 +59,173 @@ TaskRunner::~TaskRunner()
 
 void TaskRunner::run(
 	size_t targetTPS,
-	const std::function<bool()>& end, 
-	const std::function<void()>& run)
+	LoopCondition end,
+	LoopFunction run,
+	const LoopOptions& options)
 {
-	run_func(*this, targetTPS, end, run);
+	run_func(*this, registerLoop(options), targetTPS, std::move(end), std::move(run));
 }
 
 void TaskRunner::run(
 	size_t targetTPS, 
-	const std::function<bool()>& end,
-	const std::function<void(std::chrono::nanoseconds)>& run)
+	LoopCondition end,
+	TimedLoopFunction run,
+	const LoopOptions& options)
 {
-	run_func_tick(*this, targetTPS, end, run);
+	run_func_tick(*this, registerLoop(options), targetTPS, std::move(end), std::move(run));
 }
 
 void TaskRunner::runAsync(
 	size_t targetTPS,
-	const std::function<bool()>& end,
-	const std::function<void()>& run)
+	LoopCondition end,
+	LoopFunction run,
+	const LoopOptions& options)
 {
-	_threads.push_back(std::thread(run_func, std::cref(*this), targetTPS, end, run));
+	_threads.push_back(std::thread(run_func, std::cref(*this), std::ref(registerLoop(options)), targetTPS, std::move(end), std::move(run)));
 }
 
 void TaskRunner::runAsync(
 	size_t targetTPS,
-	const std::function<bool()>& end,
-	const std::function<void(std::chrono::nanoseconds)>& run)
+	LoopCondition end,
+	TimedLoopFunction run,
+	const LoopOptions& options)
+{
+	_threads.push_back(std::thread(run_func_tick, std::cref(*this), std::ref(registerLoop(options)), targetTPS, std::move(end), std::move(run)));
+}
+
+void TaskRunner::runFixed(
+	size_t targetTPS,
+	LoopCondition end,
+	TimedLoopFunction run,
+	const LoopOptions& options)
+{
+	run_func_fixed(*this, registerFixedLoop(options), targetTPS, std::move(end), std::move(run));
+}
+
+void TaskRunner::runFixedAsync(
+	size_t targetTPS,
+	LoopCondition end,
+	TimedLoopFunction run,
+	const LoopOptions& options)
+{
+	_threads.push_back(std::thread(run_func_fixed, std::ref(*this), std::ref(registerFixedLoop(options)), targetTPS, std::move(end), std::move(run)));
+}
+
+float TaskRunner::interpolationAlpha() const
+{
+	using namespace std::chrono;
+
+	if (!_fixedLoopRunning)
+		return 1.f;
+
+	nanoseconds::rep step = _fixedStep;
+	if (step <= 0)
+		return 1.f;
+
+	nanoseconds::rep now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	float alpha = static_cast<float>(now - _lastFixedTick) / static_cast<float>(step);
+	return std::min(std::max(alpha, 0.f), 1.f);
+}
+
+LatencyHistogram TaskRunner::wakeUpErrors(const std::string& loopName) const
+{
+	std::lock_guard<std::mutex> loopsLock(_loopsMutex);
+
+	for (const std::unique_ptr<Loop>& loop : _loops)
+	{
+		if (loop->options.name != loopName)
+			continue;
+
+		std::lock_guard<std::mutex> statisticsLock(loop->statisticsMutex);
+		return loop->wakeUpErrors;
+	}
+
+	throw std::runtime_error("No loop named " + loopName + " was started in this runner!");
+}
+
+LoopTelemetry TaskRunner::telemetry(const std::string& loopName) const
+{
+	std::lock_guard<std::mutex> loopsLock(_loopsMutex);
+
+	for (const std::unique_ptr<Loop>& loop : _loops)
+		if (loop->options.name == loopName)
+		{
+			LoopTelemetry telemetry = loop->telemetry.snapshot();
+			telemetry.settingsApplied = loop->settingsApplied;
+			return telemetry;
+		}
+
+	throw std::runtime_error("No loop named " + loopName + " was started in this runner!");
+}
+
+std::vector<std::string> TaskRunner::loopNames() const
+{
+	std::lock_guard<std::mutex> loopsLock(_loopsMutex);
+
+	std::vector<std::string> names;
+	names.reserve(_loops.size());
+	for (const std::unique_ptr<Loop>& loop : _loops)
+		names.push_back(loop->options.name);
+
+	return names;
+}
+
+void TaskRunner::submit(Job job)
+{
+	push(std::move(job), nullptr);
+}
+
+void TaskRunner::push(Job job, const TaskGroup* group)
+{
+	if (_workers.empty())
+	{
+		job();
+		return;
+	}
+
+	size_t index = currentRunner == this ? currentWorkerIndex : _nextWorker++ % _workers.size();
+
+	// Count the job before it becomes visible, so that a worker never sees it without also seeing the count.
+	_pendingJobs++;
+	{
+		std::lock_guard<std::mutex> lock(_workers[index]->mutex);
+		_workers[index]->jobs.push_back(QueuedJob{ std::move(job), group });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_workerMutex);
+	}
+	_workerCondition.notify_one();
+}
+
+void TaskRunner::parallelFor(size_t begin, size_t end, const InplaceFunction<void(size_t)>& func, size_t grainSize)
 {
-	_threads.push_back(std::thread(run_func_tick, std::cref(*this), targetTPS, end, run));
+	if (begin >= end)
+		return;
+
+	grainSize = std::max<size_t>(grainSize, 1);
+
+	TaskGroup group(*this);
+	for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += std::min(grainSize, end - chunkBegin))
+	{
+		size_t chunkEnd = chunkBegin + std::min(grainSize, end - chunkBegin);
+		group.run([&func, chunkBegin, chunkEnd] {
+			for (size_t i = chunkBegin; i < chunkEnd; i++)
+				func(i);
+		});
+	}
+
+	group.wait();
+}
+
+size_t TaskRunner::workerCount() const
+{
+	return _workers.size();
+}
+
+const std::vector<size_t>& TaskRunner::reservedCpus() const
+{
+	return _workerOptions.reservedCpus;
 }
 
 void TaskRunner::joinAll()
@@ -52,6 +239,8 @@ void TaskRunner::joinAll()
 
 		thread.join();
 	}
+
+	stopWorkers();
 }
 
 bool TaskRunner::shouldJoin() const
@@ -59,14 +248,23 @@ bool TaskRunner::shouldJoin() const
 	return _shouldJoin;
 }
 
+size_t TaskRunner::defaultWorkerCount()
+{
+	size_t hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
 void TaskRunner::run_func(
 	const TaskRunner& parentRunner,
+	Loop& loop,
 	size_t targetTPS,
-	const std::function<bool()>& end,
-	const std::function<void()>& run)
+	LoopCondition end,
+	LoopFunction run)
 {
 	using namespace std::chrono;
 
+	applyLoopSettings(loop);
+
 	const nanoseconds targetTime{ (seconds(1) / nanoseconds(1)) / targetTPS };
 	steady_clock::time_point time = steady_clock::now();
 
@@ -89,19 +287,25 @@ void TaskRunner::run_func(
 			throw;
 		}
 
+		steady_clock::time_point workEnd = steady_clock::now();
 		steady_clock::time_point nextTime = time + targetTime;
-		std::this_thread::sleep_until(nextTime);
+		nanoseconds sleepTime = pace(loop, nextTime);
+
+		loop.telemetry.record(time, workEnd - time, sleepTime, workEnd > nextTime);
 	}
 }
 
 void TaskRunner::run_func_tick(
 	const TaskRunner& parentRunner,
+	Loop& loop,
 	size_t targetTPS,
-	const std::function<bool()>& end,
-	const std::function<void(std::chrono::nanoseconds)>& run)
+	LoopCondition end,
+	TimedLoopFunction run)
 {
 	using namespace std::chrono;
 
+	applyLoopSettings(loop);
+
 	const nanoseconds targetTime{ (seconds(1) / nanoseconds(1)) / targetTPS };
 	steady_clock::time_point lastTime = steady_clock::now();
 
@@ -113,7 +317,280 @@ void TaskRunner::run_func_tick(
 
 		run(elapsedTime);
 
+		steady_clock::time_point workEnd = steady_clock::now();
 		steady_clock::time_point nextTime = currentTime + targetTime;
-		std::this_thread::sleep_until(nextTime);
+		nanoseconds sleepTime = pace(loop, nextTime);
+
+		loop.telemetry.record(currentTime, workEnd - currentTime, sleepTime, workEnd > nextTime);
 	}
+}
+
+void TaskRunner::run_func_fixed(
+	TaskRunner& parentRunner,
+	Loop& loop,
+	size_t targetTPS,
+	LoopCondition end,
+	TimedLoopFunction run)
+{
+	using namespace std::chrono;
+
+	applyLoopSettings(loop);
+
+	const nanoseconds step{ (seconds(1) / nanoseconds(1)) / targetTPS };
+	const size_t maxCatchUpTicks = std::max<size_t>(loop.options.maxCatchUpTicks, 1);
+
+	// Deadlines are absolute: the next tick is scheduled relative to the previous deadline rather than to the time at
+	// which the thread actually woke up, so lateness never accumulates.
+	steady_clock::time_point nextTick = steady_clock::now();
+
+	parentRunner._fixedStep = step.count();
+	parentRunner._lastFixedTick = duration_cast<nanoseconds>((nextTick - step).time_since_epoch()).count();
+
+	try
+	{
+		while (!(parentRunner.shouldJoin() || end()))
+		{
+			steady_clock::time_point currentTime = steady_clock::now();
+
+			size_t ticks = 0;
+			steady_clock::time_point tickStart = currentTime;
+			nanoseconds workTime = nanoseconds::zero();
+			bool overran = false;
+
+			while (currentTime >= nextTick && ticks < maxCatchUpTicks)
+			{
+				// Catch-up ticks run back-to-back: record them right away, as only the last tick gets to sleep.
+				if (ticks > 0)
+					loop.telemetry.record(tickStart, workTime, nanoseconds::zero(), overran);
+
+				tickStart = steady_clock::now();
+				run(step);
+				nextTick += step;
+				ticks++;
+
+				steady_clock::time_point tickEnd = steady_clock::now();
+				workTime = tickEnd - tickStart;
+				overran = tickEnd > nextTick;
+			}
+
+			// Still behind after the maximum amount of catch-up ticks: drop the lost time instead of trying to simulate it,
+			// as doing so would only make the next iterations later still. The catch-up ticks took time of their own: the
+			// next deadline is set from the current time, not from the time the iteration started at.
+			if (currentTime >= nextTick)
+			{
+				currentTime = steady_clock::now();
+				if (currentTime >= nextTick)
+					nextTick = currentTime + step;
+			}
+
+			parentRunner._lastFixedTick = duration_cast<nanoseconds>((nextTick - step).time_since_epoch()).count();
+
+			nanoseconds sleepTime = pace(loop, nextTick);
+			if (ticks > 0)
+				loop.telemetry.record(tickStart, workTime, sleepTime, overran);
+		}
+	}
+	catch (...)
+	{
+		parentRunner._fixedLoopRunning = false;
+		throw;
+	}
+
+	parentRunner._fixedLoopRunning = false;
+}
+
+std::chrono::nanoseconds TaskRunner::pace(Loop& loop, std::chrono::steady_clock::time_point deadline)
+{
+	using namespace std::chrono;
+
+	steady_clock::time_point paceStart = steady_clock::now();
+
+	switch (loop.options.pacing)
+	{
+	case PacingMode::Sleep:
+		std::this_thread::sleep_until(deadline);
+		break;
+
+	case PacingMode::Hybrid:
+		// Sleep coarsely, leaving enough margin for the oversleep, then spin for the last stretch.
+		if (deadline - steady_clock::now() > loop.options.spinDuration)
+			std::this_thread::sleep_until(deadline - loop.options.spinDuration);
+
+		while (steady_clock::now() < deadline)
+			cpuRelax();
+		break;
+
+	case PacingMode::Busy:
+		while (steady_clock::now() < deadline)
+			cpuRelax();
+		break;
+	}
+
+	steady_clock::time_point wakeUp = steady_clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(loop.statisticsMutex);
+		loop.wakeUpErrors.record(wakeUp - deadline);
+	}
+
+	return wakeUp - paceStart;
+}
+
+void TaskRunner::applyLoopSettings(Loop& loop)
+{
+	ThreadSettings settings;
+	settings.name = loop.options.name;
+	settings.cpus = loop.options.cpus;
+	settings.priority = loop.options.priority;
+
+	loop.settingsApplied = applyThreadSettings(settings);
+}
+
+ThreadSettings TaskRunner::workerSettings(size_t index) const
+{
+	ThreadSettings settings;
+	settings.name = _workerOptions.namePrefix + std::to_string(index);
+	settings.priority = _workerOptions.priority;
+
+	std::vector<size_t> cpus = _workerOptions.cpus;
+	if (cpus.empty() && !_workerOptions.reservedCpus.empty())
+	{
+		for (size_t cpu : availableCpus())
+			if (std::find(_workerOptions.reservedCpus.begin(), _workerOptions.reservedCpus.end(), cpu) == _workerOptions.reservedCpus.end())
+				cpus.push_back(cpu);
+	}
+
+	if (_workerOptions.pinToSingleCpu && !cpus.empty())
+		settings.cpus = { cpus[index % cpus.size()] };
+	else
+		settings.cpus = std::move(cpus);
+
+	return settings;
+}
+
+TaskRunner::Loop& TaskRunner::registerLoop(const LoopOptions& options)
+{
+	std::lock_guard<std::mutex> lock(_loopsMutex);
+
+	std::unique_ptr<Loop> loop = std::make_unique<Loop>();
+	loop->options = options;
+	if (loop->options.name.empty())
+		loop->options.name = "Loop" + std::to_string(_loops.size());
+
+	for (const std::unique_ptr<Loop>& existingLoop : _loops)
+		if (existingLoop->options.name == loop->options.name)
+			throw std::runtime_error("A loop named " + loop->options.name + " was already started in this runner!");
+
+	_loops.push_back(std::move(loop));
+	return *_loops.back();
+}
+
+TaskRunner::Loop& TaskRunner::registerFixedLoop(const LoopOptions& options)
+{
+	bool expected = false;
+	if (!_fixedLoopRunning.compare_exchange_strong(expected, true))
+		throw std::runtime_error("A fixed timestep loop is already running in this runner!");
+
+	try
+	{
+		return registerLoop(options);
+	}
+	catch (...)
+	{
+		_fixedLoopRunning = false;
+		throw;
+	}
+}
+
+void TaskRunner::worker_func(TaskRunner& parentRunner, size_t index)
+{
+	currentRunner = &parentRunner;
+	currentWorkerIndex = index;
+
+	applyThreadSettings(parentRunner.workerSettings(index));
+
+	while (!parentRunner._stopWorkers)
+	{
+		if (parentRunner.runPendingJob())
+			continue;
+
+		std::unique_lock<std::mutex> lock(parentRunner._workerMutex);
+		parentRunner._workerCondition.wait(lock, [&parentRunner] {
+			return parentRunner._stopWorkers || parentRunner._pendingJobs > 0;
+		});
+	}
+}
+
+bool TaskRunner::popJob(Job& job, const TaskGroup* group)
+{
+	if (_workers.empty())
+		return false;
+
+	auto matches = [group](const QueuedJob& queued) { return !group || queued.group == group; };
+
+	// Threads outside of the pool have no queue of their own and can only steal.
+	size_t ownIndex = currentRunner == this ? currentWorkerIndex : _workers.size();
+	if (ownIndex < _workers.size())
+	{
+		Worker& worker = *_workers[ownIndex];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		auto it = std::find_if(worker.jobs.rbegin(), worker.jobs.rend(), matches);
+		if (it != worker.jobs.rend())
+		{
+			job = std::move(it->job);
+			worker.jobs.erase(std::next(it).base());
+			_pendingJobs--;
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i <= _workers.size(); i++)
+	{
+		size_t victimIndex = (ownIndex + i) % _workers.size();
+		if (victimIndex == ownIndex)
+			continue;
+
+		Worker& victim = *_workers[victimIndex];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		auto it = std::find_if(victim.jobs.begin(), victim.jobs.end(), matches);
+		if (it != victim.jobs.end())
+		{
+			job = std::move(it->job);
+			victim.jobs.erase(it);
+			_pendingJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool TaskRunner::runPendingJob(const TaskGroup* group)
+{
+	Job job;
+	if (!popJob(job, group))
+		return false;
+
+	job();
+	return true;
+}
+
+void TaskRunner::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(_workerMutex);
+		_stopWorkers = true;
+	}
+	_workerCondition.notify_all();
+
+	for (std::unique_ptr<Worker>& worker : _workers)
+		if (worker->thread.joinable())
+			worker->thread.join();
+
+	// Jobs left behind are executed inline, as nobody else will pick them up.
+	Job job;
+	while (popJob(job))
+		job();
+
+	_workers.clear();
 }
\ No newline at end of file
@@ -0,0 +1,293 @@
+/*! @file Task/ThreadSettings.cpp */
+
+#include "Task/ThreadSettings.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <utility>
+
+using namespace Orbit;
+
+#if defined(_WIN32)
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+namespace
+{
+	/*! Signature of SetThreadDescription, which only exists from Windows 10 1607 onwards. */
+	using SetThreadDescriptionFunc = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+
+	/*!
+	@brief Converts a process affinity mask to a list of logical CPUs.
+	@param mask The mask to convert.
+	@return The logical CPUs in the mask.
+	*/
+	std::vector<size_t> maskToCpus(DWORD_PTR mask)
+	{
+		std::vector<size_t> cpus;
+		for (size_t i = 0; i < sizeof(DWORD_PTR) * 8; i++)
+			if (mask & (static_cast<DWORD_PTR>(1) << i))
+				cpus.push_back(i);
+
+		return cpus;
+	}
+}
+
+bool Orbit::applyThreadSettings(const ThreadSettings& settings)
+{
+	bool applied = true;
+
+	if (!settings.name.empty())
+	{
+		// Looked up at runtime, so that older versions of Windows simply go without thread names.
+		SetThreadDescriptionFunc setThreadDescription = reinterpret_cast<SetThreadDescriptionFunc>(
+			GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+
+		int length = MultiByteToWideChar(CP_UTF8, 0, settings.name.c_str(), -1, nullptr, 0);
+		std::wstring name(length, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, settings.name.c_str(), -1, &name[0], length);
+
+		applied &= setThreadDescription && SUCCEEDED(setThreadDescription(GetCurrentThread(), name.c_str()));
+	}
+
+	if (!settings.cpus.empty())
+	{
+		DWORD_PTR mask = 0;
+		for (size_t cpu : settings.cpus)
+		{
+			if (cpu >= sizeof(DWORD_PTR) * 8)
+			{
+				// CPUs beyond the first processor group cannot be expressed in a thread affinity mask.
+				applied = false;
+				continue;
+			}
+
+			mask |= static_cast<DWORD_PTR>(1) << cpu;
+		}
+
+		applied &= mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+	}
+
+	int priority = THREAD_PRIORITY_NORMAL;
+	switch (settings.priority)
+	{
+	case ThreadPriority::Low:
+		priority = THREAD_PRIORITY_BELOW_NORMAL;
+		break;
+	case ThreadPriority::Normal:
+		priority = THREAD_PRIORITY_NORMAL;
+		break;
+	case ThreadPriority::High:
+		priority = THREAD_PRIORITY_HIGHEST;
+		break;
+	case ThreadPriority::RealTime:
+		priority = THREAD_PRIORITY_TIME_CRITICAL;
+		break;
+	}
+
+	if (settings.priority != ThreadPriority::Normal)
+		applied &= SetThreadPriority(GetCurrentThread(), priority) != 0;
+
+	return applied;
+}
+
+std::vector<size_t> Orbit::availableCpus()
+{
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) || processMask == 0)
+		return { 0 };
+
+	return maskToCpus(processMask);
+}
+
+std::vector<std::vector<size_t>> Orbit::physicalCores()
+{
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+
+	DWORD length = 0;
+	GetLogicalProcessorInformation(nullptr, &length);
+
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> information(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+	std::vector<std::vector<size_t>> cores;
+
+	if (!information.empty() && GetLogicalProcessorInformation(information.data(), &length))
+	{
+		for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : information)
+		{
+			if (entry.Relationship != RelationProcessorCore)
+				continue;
+
+			std::vector<size_t> core = maskToCpus(entry.ProcessorMask & processMask);
+			if (!core.empty())
+				cores.push_back(std::move(core));
+		}
+	}
+
+	if (cores.empty())
+		for (size_t cpu : availableCpus())
+			cores.push_back({ cpu });
+
+	std::sort(cores.begin(), cores.end());
+	return cores;
+}
+
+#elif defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+
+namespace
+{
+	/*!
+	@brief Reads a single integer from a sysfs file.
+	@param path The path to the file.
+	@param value The read value.
+	@return Whether or not a value could be read.
+	*/
+	bool readSysfsValue(const std::string& path, long& value)
+	{
+		std::ifstream file(path);
+		return static_cast<bool>(file >> value);
+	}
+}
+
+bool Orbit::applyThreadSettings(const ThreadSettings& settings)
+{
+	bool applied = true;
+
+	// Thread names are limited to 15 characters, plus the null terminator.
+	if (!settings.name.empty())
+		applied &= pthread_setname_np(pthread_self(), settings.name.substr(0, 15).c_str()) == 0;
+
+	if (!settings.cpus.empty())
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+
+		for (size_t cpu : settings.cpus)
+		{
+			if (cpu >= CPU_SETSIZE)
+			{
+				applied = false;
+				continue;
+			}
+
+			CPU_SET(cpu, &cpuSet);
+		}
+
+		applied &= CPU_COUNT(&cpuSet) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+	}
+
+	// Niceness is per-thread on Linux, despite the PRIO_PROCESS name.
+	pid_t threadId = static_cast<pid_t>(syscall(SYS_gettid));
+
+	switch (settings.priority)
+	{
+	case ThreadPriority::Low:
+		applied &= setpriority(PRIO_PROCESS, threadId, 10) == 0;
+		break;
+
+	case ThreadPriority::Normal:
+		break;
+
+	case ThreadPriority::High:
+		applied &= setpriority(PRIO_PROCESS, threadId, -10) == 0;
+		break;
+
+	case ThreadPriority::RealTime:
+	{
+		// The lowest real-time priority is enough to preempt every normal thread, without getting in the way of the
+		// kernel's own real-time threads.
+		sched_param parameters{};
+		parameters.sched_priority = sched_get_priority_min(SCHED_FIFO);
+		applied &= pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0;
+		break;
+	}
+	}
+
+	return applied;
+}
+
+std::vector<size_t> Orbit::availableCpus()
+{
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+
+	if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+		return { 0 };
+
+	std::vector<size_t> cpus;
+	for (size_t i = 0; i < CPU_SETSIZE; i++)
+		if (CPU_ISSET(i, &cpuSet))
+			cpus.push_back(i);
+
+	return cpus;
+}
+
+std::vector<std::vector<size_t>> Orbit::physicalCores()
+{
+	// Logical CPUs sharing the same package and core ids are hyperthread siblings.
+	std::map<std::pair<long, long>, std::vector<size_t>> coreMap;
+
+	for (size_t cpu : availableCpus())
+	{
+		std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+
+		long package = 0;
+		long core = 0;
+		if (!readSysfsValue(topology + "physical_package_id", package) || !readSysfsValue(topology + "core_id", core))
+		{
+			package = -1;
+			core = static_cast<long>(cpu);
+		}
+
+		coreMap[std::make_pair(package, core)].push_back(cpu);
+	}
+
+	std::vector<std::vector<size_t>> cores;
+	for (std::pair<const std::pair<long, long>, std::vector<size_t>>& core : coreMap)
+		cores.push_back(std::move(core.second));
+
+	std::sort(cores.begin(), cores.end());
+	return cores;
+}
+
+#else
+
+bool Orbit::applyThreadSettings(const ThreadSettings& settings)
+{
+	// No thread control on this system: only the default settings can be honoured.
+	return settings.name.empty() && settings.cpus.empty() && settings.priority == ThreadPriority::Normal;
+}
+
+std::vector<size_t> Orbit::availableCpus()
+{
+	std::vector<size_t> cpus;
+	for (size_t i = 0; i < std::max(std::thread::hardware_concurrency(), 1u); i++)
+		cpus.push_back(i);
+
+	return cpus;
+}
+
+std::vector<std::vector<size_t>> Orbit::physicalCores()
+{
+	std::vector<std::vector<size_t>> cores;
+	for (size_t cpu : availableCpus())
+		cores.push_back({ cpu });
+
+	return cores;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+/*! @file Task/TickTelemetry.cpp */
+
+#include "Task/TickTelemetry.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Orbit;
+
+void TickTelemetry::record(
+	std::chrono::steady_clock::time_point tickStart,
+	std::chrono::nanoseconds workTime,
+	std::chrono::nanoseconds sleepTime,
+	bool overran)
+{
+	using namespace std::chrono;
+
+	// Only this thread writes: plain load/store pairs are enough, no read-modify-write needed.
+	uint64_t ticks = _ticks.load(std::memory_order_relaxed);
+
+	Sample& sample = _samples[ticks % SampleCount];
+	sample.start.store(duration_cast<nanoseconds>(tickStart.time_since_epoch()).count(), std::memory_order_relaxed);
+	sample.workTime.store(workTime.count(), std::memory_order_relaxed);
+
+	if (overran)
+		_overruns.store(_overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	_totalWorkTime.store(_totalWorkTime.load(std::memory_order_relaxed) + workTime.count(), std::memory_order_relaxed);
+	_totalSleepTime.store(_totalSleepTime.load(std::memory_order_relaxed) + sleepTime.count(), std::memory_order_relaxed);
+
+	_ticks.store(ticks + 1, std::memory_order_release);
+}
+
+LoopTelemetry TickTelemetry::snapshot() const
+{
+	using namespace std::chrono;
+
+	LoopTelemetry telemetry;
+
+	uint64_t ticks = _ticks.load(std::memory_order_acquire);
+	telemetry.ticks = ticks;
+	telemetry.overruns = _overruns.load(std::memory_order_relaxed);
+	telemetry.totalWorkTime = nanoseconds(_totalWorkTime.load(std::memory_order_relaxed));
+	telemetry.totalSleepTime = nanoseconds(_totalSleepTime.load(std::memory_order_relaxed));
+
+	// Copy the window, oldest tick first.
+	uint64_t firstTick = ticks > WindowSize ? ticks - WindowSize : 0;
+
+	std::vector<int64_t> starts;
+	std::vector<int64_t> workTimes;
+	starts.reserve(static_cast<size_t>(ticks - firstTick));
+	workTimes.reserve(static_cast<size_t>(ticks - firstTick));
+
+	for (uint64_t tick = firstTick; tick < ticks; tick++)
+	{
+		const Sample& sample = _samples[tick % SampleCount];
+		starts.push_back(sample.start.load(std::memory_order_relaxed));
+		workTimes.push_back(sample.workTime.load(std::memory_order_relaxed));
+	}
+
+	// Ticks recorded in the meantime may have overwritten the oldest samples (or be halfway through doing so): drop them.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t ticksAfter = _ticks.load(std::memory_order_relaxed);
+	uint64_t firstValidTick = ticksAfter >= WindowSize ? ticksAfter - WindowSize : 0;
+	if (firstValidTick > firstTick)
+	{
+		size_t overwritten = static_cast<size_t>(std::min<uint64_t>(firstValidTick - firstTick, starts.size()));
+		starts.erase(starts.begin(), starts.begin() + overwritten);
+		workTimes.erase(workTimes.begin(), workTimes.begin() + overwritten);
+	}
+
+	telemetry.windowTicks = workTimes.size();
+	if (workTimes.empty())
+		return telemetry;
+
+	if (starts.size() > 1 && starts.back() > starts.front())
+		telemetry.tickRate = static_cast<double>(starts.size() - 1) * 1e9 / static_cast<double>(starts.back() - starts.front());
+
+	std::sort(workTimes.begin(), workTimes.end());
+
+	auto percentile = [&workTimes](double percentile) {
+		size_t index = static_cast<size_t>(percentile * static_cast<double>(workTimes.size() - 1) + 0.5);
+		return nanoseconds(workTimes[std::min(index, workTimes.size() - 1)]);
+	};
+
+	telemetry.workTimeP50 = percentile(0.50);
+	telemetry.workTimeP95 = percentile(0.95);
+	telemetry.workTimeP99 = percentile(0.99);
+
+	return telemetry;
+}
\ No newline at end of file
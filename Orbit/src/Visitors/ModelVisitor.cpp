@@ -3,72 +3,169 @@
 #include "Visitors/ModelVisitor.h"
 
 #include <Game/CompositeTree/Node.h>
+#include <Render/Model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 using namespace Orbit;
 
 void ModelVisitor::visitElement(Node* node)
 {
-	if (!node->hasModel())
-		return;
-
-	commitModel(node->getModel(), node->modelMatrix());
+	collect(*node);
 }
 
-bool ModelVisitor::modelCountsChanged() const
+void ModelVisitor::matchPreviousTransforms()
 {
-	std::vector<Renderer::ModelCountPair> counts = modelCounts();
-	if (_oldModelCounts.size() != counts.size())
-		return true;
+	_previousTransformsById.clear();
 
-	for (size_t i = 0; i < _oldModelCounts.size(); i++)
+	for (size_t i = 0; i < _retrievedTreeState.size(); i++)
 	{
-		const Renderer::ModelCountPair& oldModelCount = _oldModelCounts[i];
-		const Renderer::ModelCountPair& newModelCount = counts[i];
+		FramePacket::ModelInstances& instances = _retrievedTreeState[i];
+		const PreviousInstances& previous = _previousTreeState[i];
+
+		// Usual case: the same instances, in the same order.
+		if (previous.ids == instances.ids)
+		{
+			instances.previousTransforms = previous.transforms;
+			continue;
+		}
+
+		// Instances came into view, left it, or switched models: look them up by id.
+		if (_previousTransformsById.empty())
+			for (const PreviousInstances& previousInstances : _previousTreeState)
+				for (size_t j = 0; j < previousInstances.ids.size(); j++)
+					_previousTransformsById.emplace(previousInstances.ids[j], &previousInstances.transforms[j]);
+
+		instances.previousTransforms.resize(instances.transforms.size());
+		for (size_t j = 0; j < instances.transforms.size(); j++)
+		{
+			auto found = _previousTransformsById.find(instances.ids[j]);
+			instances.previousTransforms[j] = found == _previousTransformsById.end() ? instances.transforms[j] : *found->second;
+		}
+	}
+}
 
-		if (oldModelCount.first != newModelCount.first)
-			return true;
+void ModelVisitor::setView(const glm::mat4& view, const glm::mat4& projection)
+{
+	_frustum = Frustum(projection * view);
+	_eye = glm::vec3(glm::inverse(view)[3]);
 
-		if (oldModelCount.second != newModelCount.second)
-			return true;
-	}
+	// Perspective projections divide by the depth (w = -z), orthographic ones do not.
+	_orthographic = projection[2][3] == 0.f;
+	_projectionScale = std::fabs(projection[1][1]);
+}
 
-	return false;
+void ModelVisitor::clearView()
+{
+	_frustum = Frustum();
+	_projectionScale = 0.f;
 }
 
-void ModelVisitor::flushModelCounts()
+size_t ModelVisitor::testedInstances() const
+{
+	return _lastTestedInstances;
+}
+
+size_t ModelVisitor::culledInstances() const
 {
-	_oldModelCounts = modelCounts();
-	_retrievedTreeState.clear();
+	return _lastCulledInstances;
 }
 
-std::vector<Renderer::ModelCountPair> ModelVisitor::modelCounts() const
+void ModelVisitor::flushModelCounts()
 {
-	std::vector<Renderer::ModelCountPair> modelCounts;
-	modelCounts.reserve(_retrievedTreeState.size());
+	// Levels of detail stay along with their model, even when no instance was at their level.
+	size_t bucketCount = _retrievedTreeState.size();
+	for (size_t i = 0; i < bucketCount; i++)
+		if (_usedBuckets[i])
+			for (const Model::Lod& lod : _retrievedTreeState[i].model->lods())
+				findBucket(lod.model);
+
+	size_t keptBuckets = 0;
+	for (size_t i = 0; i < _retrievedTreeState.size(); i++)
+	{
+		if (!_usedBuckets[i])
+			continue;
+
+		FramePacket::ModelInstances& bucket = _retrievedTreeState[keptBuckets];
+		PreviousInstances& previous = _previousTreeState[keptBuckets];
+		if (i != keptBuckets)
+		{
+			bucket = std::move(_retrievedTreeState[i]);
+			previous = std::move(_previousTreeState[i]);
+		}
+
+		// This iteration's instances become the previous ones; the older ones' storage is reused for the next iteration.
+		std::swap(bucket.transforms, previous.transforms);
+		std::swap(bucket.ids, previous.ids);
+		bucket.transforms.clear();
+		bucket.previousTransforms.clear();
+		bucket.ids.clear();
+		_usedBuckets[keptBuckets++] = false;
+	}
 
-	for (const Renderer::ModelTransformsPair& pair : _retrievedTreeState)
-		modelCounts.push_back(std::make_pair(pair.first, pair.second.size()));
+	_retrievedTreeState.resize(keptBuckets);
+	_previousTreeState.resize(keptBuckets);
+	_usedBuckets.resize(keptBuckets);
 
-	return modelCounts;
+	_lastTestedInstances = _testedInstances;
+	_lastCulledInstances = _culledInstances;
+	_testedInstances = 0;
+	_culledInstances = 0;
 }
 
-const std::vector<Renderer::ModelTransformsPair>& ModelVisitor::treeState() const
+const std::vector<FramePacket::ModelInstances>& ModelVisitor::treeState() const
 {
 	return _retrievedTreeState;
 }
 
-void ModelVisitor::commitModel(std::shared_ptr<Model> model, const glm::mat4& transform)
+size_t ModelVisitor::findBucket(const std::shared_ptr<Model>& model)
 {
-	std::vector<Renderer::ModelTransformsPair>::iterator found = std::find_if(_retrievedTreeState.begin(), _retrievedTreeState.end(),
-		[&model] (const Renderer::ModelTransformsPair& pair) {
-		return model == pair.first;
-	});
-
-	if (found == _retrievedTreeState.end())
+	if (_lastBucket >= _retrievedTreeState.size() || _retrievedTreeState[_lastBucket].model != model)
 	{
-		_retrievedTreeState.push_back(std::make_pair(model, std::vector<glm::mat4>{ transform }));
-		return;
+		std::vector<FramePacket::ModelInstances>::iterator found = std::find_if(_retrievedTreeState.begin(), _retrievedTreeState.end(),
+			[&model] (const FramePacket::ModelInstances& bucket) {
+			return bucket.model == model;
+		});
+
+		size_t bucket = found - _retrievedTreeState.begin();
+		if (found == _retrievedTreeState.end())
+		{
+			_retrievedTreeState.push_back(FramePacket::ModelInstances{ model, {}, {}, {} });
+			_previousTreeState.emplace_back();
+			_usedBuckets.push_back(false);
+
+			for (const Model::Lod& lod : model->lods())
+				findBucket(lod.model);
+		}
+
+		_lastBucket = bucket;
 	}
-	
-	found->second.push_back(transform);
+
+	_usedBuckets[_lastBucket] = true;
+	return _lastBucket;
+}
+
+void ModelVisitor::commitModel(size_t bucket, const Node& node)
+{
+	const std::shared_ptr<Model>& model = _retrievedTreeState[bucket].model;
+	if (_projectionScale > 0.f && !model->lods().empty())
+		if (const Model::Lod* lod = model->selectLod(screenSize(node.worldBounds())))
+			bucket = findBucket(lod->model);
+
+	FramePacket::ModelInstances& instances = _retrievedTreeState[bucket];
+	instances.transforms.push_back(node.modelMatrix());
+	instances.ids.push_back(node.instanceId());
+}
+
+float ModelVisitor::screenSize(const AABB& bounds) const
+{
+	// The projected diameter of the bounding sphere, over the viewport's height (2 in clip space).
+	float radius = glm::length(bounds.halfExtents());
+	if (_orthographic)
+		return radius * _projectionScale;
+
+	float distance = std::max(glm::length(bounds.center() - _eye), radius);
+	return radius * _projectionScale / distance;
 }
\ No newline at end of file
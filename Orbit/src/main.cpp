@@ -1,8 +1,10 @@
 /*! @file main.cpp */
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "Input/WindowLibrary.h"
 #include "Input/Window.h"
@@ -40,7 +42,15 @@ int main(int argc, char* argv[])
 
 		window->open();
 
-		TaskRunner runner;
+		// With enough cores, give a physical core to the update loop alone, so that its ticks do not compete with the
+		// workers. The workers get the rest, less a hardware thread for the render loop.
+		WorkerOptions workerOptions;
+		std::vector<std::vector<size_t>> cores = physicalCores();
+		if (cores.size() > 2)
+			workerOptions.reservedCpus = cores.back();
+
+		size_t freeCpus = availableCpus().size() - std::min(workerOptions.reservedCpus.size(), availableCpus().size());
+		TaskRunner runner(freeCpus > 1 ? freeCpus - 1 : 0, workerOptions);
 		Game game{ *window, runner };
 
 		game.initialize();
@@ -48,13 +58,17 @@ int main(int argc, char* argv[])
 		// Note that the game's shouldClose() function is directly linked to the window's.
 		// TODO: Instead of doing rendering on main thread, check if -server is in parameters. Then pipe console commands
 		// to the game's hypothetical command pipeline.
+		LoopOptions renderOptions;
+		renderOptions.name = "Render";
+
 		runner.run(120, [&window]() {
 			return window->shouldClose();
 		},
-		[&window]() {
+		[&window, &runner]() {
 			window->handleMessages();
-			window->renderer()->renderFrame();
-		});
+			window->renderer()->renderFrame(runner.interpolationAlpha());
+		},
+		renderOptions);
 
 		runner.joinAll();
 	}
@@ -0,0 +1,51 @@
+/*! @file Benchmark.h */
+
+#ifndef ORBITBENCHMARK_BENCHMARK_H
+#define ORBITBENCHMARK_BENCHMARK_H
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Times a function over several runs, keeping the fastest: slower runs only add noise (cold caches on the first
+	run, preemption...).
+	@tparam Function The type of the function, taking no parameters.
+	@param runs The amount of runs.
+	@param function The function to time.
+	@return The duration of the fastest run.
+	*/
+	template<typename Function>
+	std::chrono::nanoseconds measure(size_t runs, Function&& function)
+	{
+		std::chrono::nanoseconds fastest = std::chrono::nanoseconds::max();
+		for (size_t run = 0; run < runs; run++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			function();
+			fastest = std::min(fastest, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+		}
+
+		return fastest;
+	}
+
+	/*!
+	@brief Prints the timing of a benchmark case, in total and per operation.
+	@param name The name of the case.
+	@param time The time the case took.
+	@param operations The amount of operations the case did.
+	*/
+	void report(const std::string& name, std::chrono::nanoseconds time, size_t operations);
+
+	/*!
+	@brief Keeps a result around, so that the work computing it is not optimized away.
+	@param value The result.
+	*/
+	void keep(uint64_t value);
+}
+
+#endif //ORBITBENCHMARK_BENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+/*! @file Benchmarks/FunctionBenchmark.h */
+
+#ifndef ORBITBENCHMARK_BENCHMARKS_FUNCTIONBENCHMARK_H
+#define ORBITBENCHMARK_BENCHMARKS_FUNCTIONBENCHMARK_H
+#pragma once
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Compares Orbit::InplaceFunction to std::function, the way the task runner uses them: building a callable and
+	moving it to where it runs (as queuing a job does), then calling it (as every loop iteration does).
+	*/
+	void runFunctionBenchmark();
+}
+
+#endif //ORBITBENCHMARK_BENCHMARKS_FUNCTIONBENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,16 @@
+/*! @file Benchmarks/SceneFileBenchmark.h */
+
+#ifndef ORBITBENCHMARK_BENCHMARKS_SCENEFILEBENCHMARK_H
+#define ORBITBENCHMARK_BENCHMARKS_SCENEFILEBENCHMARK_H
+#pragma once
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Writes a scene of 100k nodes to a scene file, then times loading it back: the file's nodes alone, then added to
+	a tree, next to the same scene built in code.
+	*/
+	void runSceneFileBenchmark();
+}
+
+#endif //ORBITBENCHMARK_BENCHMARKS_SCENEFILEBENCHMARK_H
\ No newline at end of file
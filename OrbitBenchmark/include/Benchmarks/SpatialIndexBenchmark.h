@@ -0,0 +1,16 @@
+/*! @file Benchmarks/SpatialIndexBenchmark.h */
+
+#ifndef ORBITBENCHMARK_BENCHMARKS_SPATIALINDEXBENCHMARK_H
+#define ORBITBENCHMARK_BENCHMARKS_SPATIALINDEXBENCHMARK_H
+#pragma once
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Compares the tree's spatial index to a brute-force scan of every node, on the same random box, sphere, ray and
+	nearest-node queries over a tree of 100k nodes.
+	*/
+	void runSpatialIndexBenchmark();
+}
+
+#endif //ORBITBENCHMARK_BENCHMARKS_SPATIALINDEXBENCHMARK_H
\ No newline at end of file
@@ -0,0 +1,17 @@
+/*! @file Benchmarks/TraversalBenchmark.h */
+
+#ifndef ORBITBENCHMARK_BENCHMARKS_TRAVERSALBENCHMARK_H
+#define ORBITBENCHMARK_BENCHMARKS_TRAVERSALBENCHMARK_H
+#pragma once
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Compares the ways of going over a tree of 100k nodes, reading each node's model and model matrix as the model
+	visitor does: a virtual Orbit::Visitor reaching models through shared pointer copies, then CompositeTree::forEach() and
+	CompositeTree::forEachNodeOfType() reaching them through Node::model().
+	*/
+	void runTraversalBenchmark();
+}
+
+#endif //ORBITBENCHMARK_BENCHMARKS_TRAVERSALBENCHMARK_H
\ No newline at end of file
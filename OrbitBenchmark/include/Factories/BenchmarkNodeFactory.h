@@ -0,0 +1,68 @@
+/*! @file Factories/BenchmarkNodeFactory.h */
+
+#ifndef ORBITBENCHMARK_FACTORIES_BENCHMARKNODEFACTORY_H
+#define ORBITBENCHMARK_FACTORIES_BENCHMARKNODEFACTORY_H
+#pragma once
+
+#include <Game/Factories/NodeFactory.h>
+#include <Game/Factories/NodePool.h>
+
+#include <Render/Model.h>
+
+#include "Nodes/BenchmarkNode.h"
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Implementation of the factory design pattern, outputting instances of OrbitBenchmark::BenchmarkNode. Instances
+	are allocated from (and recycled through) the factory's node pool, like the game's own factories do.
+	*/
+	class BenchmarkNodeFactory : public Orbit::NodeFactory
+	{
+	public:
+		/*!
+		@brief Constructs the factory with the model in parameter.
+		@param input The input handler to be used in the nodes.
+		@param model The model to be used in instances of BenchmarkNode.
+		*/
+		BenchmarkNodeFactory(const Orbit::Input& input, std::shared_ptr<Orbit::Model> model);
+
+		/*!
+		@brief Creates an instance of OrbitBenchmark::BenchmarkNode.
+		@return An instance of OrbitBenchmark::BenchmarkNode.
+		*/
+		std::shared_ptr<Orbit::Node> create() const override;
+
+		/*!
+		@brief Creates an instance of OrbitBenchmark::BenchmarkNode with the name in parameter.
+		@param name the name to apply to the node.
+		@return An instance of OrbitBenchmark::BenchmarkNode.
+		*/
+		std::shared_ptr<Orbit::Node> create(const std::string& name) const override;
+
+		/*!
+		@brief Creates a batch of instances of OrbitBenchmark::BenchmarkNode, one per name. The nodes are allocated from a
+		single slab of the pool, and their names from a single block.
+		@param names The names of the nodes.
+		@return The instances of OrbitBenchmark::BenchmarkNode.
+		*/
+		std::vector<std::shared_ptr<Orbit::Node>> create(const std::vector<std::string_view>& names) const override;
+
+		/*!
+		@brief Creates a batch of instances of OrbitBenchmark::BenchmarkNode, one per archetype, from a single slab of the pool.
+		@param archetypes The archetypes of the nodes.
+		@return The instances of OrbitBenchmark::BenchmarkNode.
+		*/
+		std::vector<std::shared_ptr<Orbit::Node>> create(const std::vector<std::shared_ptr<const Orbit::Node::Archetype>>& archetypes) const override;
+
+		using NodeFactory::create;
+
+	private:
+		/*! The model used by instances of BenchmarkNode. */
+		const std::shared_ptr<Orbit::Model> _model;
+		/*! The pool the instances of BenchmarkNode are allocated from. Mutable, as creating nodes is logically const. */
+		mutable Orbit::NodePool<BenchmarkNode> _pool;
+	};
+}
+
+#endif //ORBITBENCHMARK_FACTORIES_BENCHMARKNODEFACTORY_H
\ No newline at end of file
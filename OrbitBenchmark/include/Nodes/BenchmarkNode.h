@@ -0,0 +1,68 @@
+/*! @file Nodes/BenchmarkNode.h */
+
+#ifndef ORBITBENCHMARK_NODES_BENCHMARKNODE_H
+#define ORBITBENCHMARK_NODES_BENCHMARKNODE_H
+#pragma once
+
+#include <Game/CompositeTree/Node.h>
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Node filling the benchmarks' trees. Stands still: benchmarks measure how nodes are reached, not what they do.
+	*/
+	class BenchmarkNode final : public Orbit::Node
+	{
+	public:
+		/*!
+		@brief Initializes the node with the name and model in parameter.
+		@param input The input handler reference to use by the node.
+		@param name The name of the node, for lookup purposes.
+		@param model The model to be adopted by the node.
+		*/
+		explicit BenchmarkNode(const Orbit::Input& input, const std::string& name, const std::shared_ptr<Orbit::Model>& model);
+
+		/*!
+		@brief Initializes the node as an instance of a prefab.
+		@param input The input handler reference to use by the node.
+		@param archetype The archetype shared with the other instances.
+		*/
+		explicit BenchmarkNode(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype);
+
+		/*!
+		@brief Move constructor for the class. Calls the base class's move constructor.
+		@param rhs The right hand side of the operation.
+		*/
+		BenchmarkNode(BenchmarkNode&& rhs);
+
+		/*!
+		@brief Move assignment operator for the class. Calls the base class's move assignment operator.
+		@param rhs The right hand side of the operation.
+		@return A reference to this.
+		*/
+		BenchmarkNode& operator=(BenchmarkNode&& rhs);
+
+		BenchmarkNode(const BenchmarkNode&) = delete;
+		BenchmarkNode& operator=(const BenchmarkNode&) = delete;
+
+		/*!
+		@brief Returns a cloned instance of the node.
+		@return A cloned instance of the node.
+		*/
+		std::shared_ptr<Orbit::Node> clone() const override;
+
+		/*!
+		@brief Returns an instance of the node, sharing its archetype, allocated along with the rest of the batch.
+		@param allocator The allocator of the batch of instances.
+		@return An instance of the node.
+		*/
+		std::shared_ptr<Orbit::Node> instantiate(Orbit::InstanceAllocator& allocator) const override;
+
+		/*!
+		@brief Does nothing: the node stands still.
+		*/
+		void update(std::chrono::nanoseconds /*elapsedTime*/) override;
+	};
+}
+
+#endif //ORBITBENCHMARK_NODES_BENCHMARKNODE_H
\ No newline at end of file
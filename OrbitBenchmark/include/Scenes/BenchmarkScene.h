@@ -0,0 +1,59 @@
+/*! @file Scenes/BenchmarkScene.h */
+
+#ifndef ORBITBENCHMARK_SCENES_BENCHMARKSCENE_H
+#define ORBITBENCHMARK_SCENES_BENCHMARKSCENE_H
+#pragma once
+
+#include <Game/Scene.h>
+
+namespace OrbitBenchmark
+{
+	/*!
+	@brief Scene the benchmarks run on: a cube of benchmark nodes sharing a single model, evenly spread out at the root of
+	the tree.
+	*/
+	class BenchmarkScene final : public Orbit::Scene
+	{
+	public:
+		/*!
+		@brief Constructor for the class.
+		@param nodeCount The amount of nodes in the scene.
+		*/
+		explicit BenchmarkScene(size_t nodeCount);
+
+		/*!
+		@brief Destructor for the class.
+		*/
+		virtual ~BenchmarkScene() = default;
+
+		/*!
+		@brief Loads in the scene's node factory and model.
+		*/
+		void loadFactories(const Orbit::Input& input) override;
+
+		/*!
+		@brief Places the scene's nodes.
+		@param tree The tree containing the nodes.
+		*/
+		void load(Orbit::CompositeTree& tree) override;
+
+		/*!
+		@brief Unloads the scene's specific data.
+		*/
+		void unload() override;
+
+		/*!
+		@brief Getter for the length of the side of the cube the nodes are spread over.
+		@return The length of the cube's side.
+		*/
+		float extent() const;
+
+	private:
+		/*! The amount of nodes in the scene. */
+		size_t _nodeCount;
+		/*! The amount of nodes along each side of the cube. */
+		size_t _side;
+	};
+}
+
+#endif //ORBITBENCHMARK_SCENES_BENCHMARKSCENE_H
\ No newline at end of file
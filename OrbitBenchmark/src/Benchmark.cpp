@@ -0,0 +1,27 @@
+/*! @file Benchmark.cpp */
+
+#include "Benchmark.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	/*! Where kept results go. Volatile, so that writing to it is never optimized away. */
+	volatile uint64_t keptValue = 0;
+}
+
+void OrbitBenchmark::report(const std::string& name, std::chrono::nanoseconds time, size_t operations)
+{
+	double milliseconds = std::chrono::duration<double, std::milli>(time).count();
+	double nanosecondsPerOperation = operations ? double(time.count()) / double(operations) : 0.;
+
+	std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(12) << milliseconds << " ms" << std::setprecision(2) << std::setw(12) << nanosecondsPerOperation << " ns/op"
+		<< std::endl;
+}
+
+void OrbitBenchmark::keep(uint64_t value)
+{
+	keptValue = keptValue + value;
+}
\ No newline at end of file
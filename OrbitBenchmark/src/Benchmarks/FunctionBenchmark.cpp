@@ -0,0 +1,61 @@
+/*! @file Benchmarks/FunctionBenchmark.cpp */
+
+#include "Benchmarks/FunctionBenchmark.h"
+
+#include "Benchmark.h"
+
+#include <Task/InplaceFunction.h>
+
+#include <functional>
+#include <vector>
+
+using namespace OrbitBenchmark;
+
+namespace
+{
+	/*! The amount of callables built and called per run. */
+	constexpr size_t Count = 1000000;
+	/*! The amount of runs per case. */
+	constexpr size_t Runs = 5;
+
+	/*!
+	@brief Times building Count callables and moving them into place, then calling them.
+	@tparam Function The type of the callables.
+	@tparam Job The type of the callable to copy.
+	@param name The name of the callable type, for the report.
+	@param job The callable to copy.
+	*/
+	template<typename Function, typename Job>
+	void benchmarkFunction(const std::string& name, const Job& job)
+	{
+		std::vector<Function> functions(Count);
+
+		report(name + " create + move", measure(Runs, [&functions, &job]() {
+			for (Function& function : functions)
+			{
+				Function created(job);
+				function = std::move(created);
+			}
+		}), Count);
+
+		report(name + " call", measure(Runs, [&functions]() {
+			for (const Function& function : functions)
+				function();
+		}), Count);
+	}
+}
+
+void OrbitBenchmark::runFunctionBenchmark()
+{
+	// About what a loop or a job captures: more than some standard libraries keep inline in a std::function.
+	uint64_t values[4] = { 1, 2, 3, 4 };
+	uint64_t total = 0;
+	auto job = [values, &total]() {
+		total += values[0] + values[3];
+	};
+
+	benchmarkFunction<std::function<void()>>("std::function", job);
+	benchmarkFunction<Orbit::InplaceFunction<void()>>("InplaceFunction", job);
+
+	keep(total);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*! @file Benchmarks/SceneFileBenchmark.cpp */
+
+#include "Benchmarks/SceneFileBenchmark.h"
+
+#include "Benchmark.h"
+#include "Nodes/BenchmarkNode.h"
+#include "Scenes/BenchmarkScene.h"
+
+#include <Game/CompositeTree/CompositeTree.h>
+#include <Input/Input.h>
+
+#include <cstdio>
+
+using namespace OrbitBenchmark;
+
+namespace
+{
+	/*! The amount of nodes in the scene. */
+	constexpr size_t NodeCount = 100000;
+	/*! The amount of runs per case. */
+	constexpr size_t Runs = 5;
+	/*! The file the scene is written to, removed once done. */
+	const char* const ScenePath = "Benchmark.scene";
+}
+
+void OrbitBenchmark::runSceneFileBenchmark()
+{
+	Orbit::Input input;
+	BenchmarkScene scene(NodeCount);
+	scene.loadFactories(input);
+
+	std::shared_ptr<Orbit::CompositeTree> tree = std::make_shared<Orbit::CompositeTree>();
+	scene.load(*tree);
+
+	report("Write", measure(Runs, [&scene, &tree]() {
+		scene.saveNodes(ScenePath, *tree);
+	}), NodeCount);
+
+	uint64_t total = 0;
+
+	report("Load", measure(Runs, [&scene, &total]() {
+		total += scene.loadNodes(ScenePath).size();
+	}), NodeCount);
+
+	// What a level load does: the nodes are only usable once in a tree.
+	report("Load into a tree", measure(Runs, [&scene, &total]() {
+		std::shared_ptr<Orbit::CompositeTree> loadedTree = std::make_shared<Orbit::CompositeTree>();
+		loadedTree->addChildren(scene.loadNodes(ScenePath));
+		total += loadedTree->nodesOfType(typeid(BenchmarkNode)).size();
+	}), NodeCount);
+
+	report("Build in code into a tree", measure(Runs, [&scene, &total]() {
+		std::shared_ptr<Orbit::CompositeTree> builtTree = std::make_shared<Orbit::CompositeTree>();
+		scene.load(*builtTree);
+		total += builtTree->nodesOfType(typeid(BenchmarkNode)).size();
+	}), NodeCount);
+
+	keep(total);
+	scene.unload();
+	std::remove(ScenePath);
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+/*! @file Benchmarks/SpatialIndexBenchmark.cpp */
+
+#include "Benchmarks/SpatialIndexBenchmark.h"
+
+#include "Benchmark.h"
+#include "Scenes/BenchmarkScene.h"
+
+#include <Game/CompositeTree/CompositeTree.h>
+#include <Game/SpatialIndex.h>
+#include <Input/Input.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace OrbitBenchmark;
+
+namespace
+{
+	/*! The amount of nodes in the tree. */
+	constexpr size_t NodeCount = 100000;
+	/*! The amount of queries of each kind per run. */
+	constexpr size_t QueryCount = 100;
+	/*! The amount of runs per case. */
+	constexpr size_t Runs = 3;
+	/*! The amount of nodes nearest queries look for. */
+	constexpr size_t NearestCount = 8;
+
+	/*!
+	@brief A ray, by origin and normalized direction.
+	*/
+	struct Ray
+	{
+		/*! The ray's origin. */
+		glm::vec3 origin;
+		/*! The ray's direction, normalized. */
+		glm::vec3 direction;
+	};
+
+	/*!
+	@brief Finds the distance along a ray at which it enters a box, the way the spatial index does.
+	@param box The box.
+	@param ray The ray.
+	@return The distance along the ray, or infinity if the ray misses the box.
+	*/
+	float intersectRay(const Orbit::AABB& box, const Ray& ray)
+	{
+		glm::vec3 inverseDirection(1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z);
+		glm::vec3 near = (box.min - ray.origin) * inverseDirection;
+		glm::vec3 far = (box.max - ray.origin) * inverseDirection;
+
+		glm::vec3 entry = glm::min(near, far);
+		glm::vec3 exit = glm::max(near, far);
+
+		float enter = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.f));
+		float leave = std::min(std::min(exit.x, exit.y), exit.z);
+
+		return enter <= leave ? enter : std::numeric_limits<float>::infinity();
+	}
+}
+
+void OrbitBenchmark::runSpatialIndexBenchmark()
+{
+	Orbit::Input input;
+	BenchmarkScene scene(NodeCount);
+	scene.loadFactories(input);
+
+	std::shared_ptr<Orbit::CompositeTree> tree = std::make_shared<Orbit::CompositeTree>();
+	scene.load(*tree);
+
+	const Orbit::SpatialIndex& index = tree->spatialIndex();
+	std::vector<const Orbit::Node*> nodes;
+	tree->forEach([&nodes](const Orbit::Node& node) {
+		nodes.push_back(&node);
+	});
+
+	// The same queries for both sides, each reaching a few dozen nodes.
+	float extent = scene.extent();
+	float reach = extent / 20.f;
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> coordinate(0.f, extent);
+	std::uniform_real_distribution<float> component(-1.f, 1.f);
+
+	std::vector<glm::vec3> points(QueryCount);
+	std::vector<Ray> rays(QueryCount);
+	for (size_t query = 0; query < QueryCount; query++)
+	{
+		points[query] = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+
+		glm::vec3 direction(component(random), component(random), component(random));
+		rays[query] = { points[query], glm::normalize(direction + glm::vec3(0.f, 0.f, 1e-3f)) };
+	}
+
+	uint64_t total = 0;
+
+	report("Box, spatial index", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+			index.queryBox(Orbit::AABB(point - glm::vec3(reach), point + glm::vec3(reach)), [&total](Orbit::Node&) {
+				total++;
+			});
+	}), QueryCount);
+
+	report("Box, brute force", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+		{
+			Orbit::AABB box(point - glm::vec3(reach), point + glm::vec3(reach));
+			for (const Orbit::Node* node : nodes)
+				if (node->worldBounds().overlaps(box))
+					total++;
+		}
+	}), QueryCount);
+
+	report("Sphere, spatial index", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+			index.querySphere(point, reach, [&total](Orbit::Node&) {
+				total++;
+			});
+	}), QueryCount);
+
+	report("Sphere, brute force", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+			for (const Orbit::Node* node : nodes)
+				if (node->worldBounds().distanceSquared(point) <= reach * reach)
+					total++;
+	}), QueryCount);
+
+	// Closest hit along the ray, as picking does.
+	report("Ray, spatial index", measure(Runs, [&]() {
+		for (const Ray& ray : rays)
+			index.raycast(ray.origin, ray.direction, extent, [&total](Orbit::Node&, float distance) {
+				total++;
+				return distance;
+			});
+	}), QueryCount);
+
+	report("Ray, brute force", measure(Runs, [&]() {
+		for (const Ray& ray : rays)
+		{
+			float closest = extent;
+			for (const Orbit::Node* node : nodes)
+				closest = std::min(closest, intersectRay(node->worldBounds(), ray));
+
+			total += closest < extent;
+		}
+	}), QueryCount);
+
+	report("Nearest, spatial index", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+			total += index.nearest(point, NearestCount).size();
+	}), QueryCount);
+
+	std::vector<std::pair<float, const Orbit::Node*>> distances(nodes.size());
+	report("Nearest, brute force", measure(Runs, [&]() {
+		for (const glm::vec3& point : points)
+		{
+			for (size_t node = 0; node < nodes.size(); node++)
+				distances[node] = { nodes[node]->worldBounds().distanceSquared(point), nodes[node] };
+
+			std::partial_sort(distances.begin(), distances.begin() + NearestCount, distances.end());
+			total += NearestCount;
+		}
+	}), QueryCount);
+
+	keep(total);
+	scene.unload();
+}
\ No newline at end of file
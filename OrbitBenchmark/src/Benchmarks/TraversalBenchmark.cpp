@@ -0,0 +1,77 @@
+/*! @file Benchmarks/TraversalBenchmark.cpp */
+
+#include "Benchmarks/TraversalBenchmark.h"
+
+#include "Benchmark.h"
+#include "Nodes/BenchmarkNode.h"
+#include "Scenes/BenchmarkScene.h"
+
+#include <Game/CompositeTree/CompositeTree.h>
+#include <Game/CompositeTree/Visitor.h>
+#include <Input/Input.h>
+
+using namespace OrbitBenchmark;
+
+namespace
+{
+	/*! The amount of nodes in the tree. */
+	constexpr size_t NodeCount = 100000;
+	/*! The amount of runs per case. */
+	constexpr size_t Runs = 20;
+
+	/*!
+	@brief Visitor doing the same work as the lambdas passed to the tree, through the virtual visitor interface.
+	*/
+	class ModelMatrixVisitor final : public Orbit::Visitor
+	{
+	public:
+		/*!
+		@brief Reads the node's model and model matrix.
+		@param node The node to visit.
+		*/
+		void visitElement(Orbit::Node* node) override
+		{
+			if (!node->hasModel())
+				return;
+
+			std::shared_ptr<Orbit::Model> model = node->getModel();
+			total += model->getIndices().size() + static_cast<uint64_t>(node->modelMatrix()[3].x);
+		}
+
+		/*! The sum of what was read. */
+		uint64_t total = 0;
+	};
+}
+
+void OrbitBenchmark::runTraversalBenchmark()
+{
+	Orbit::Input input;
+	BenchmarkScene scene(NodeCount);
+	scene.loadFactories(input);
+
+	std::shared_ptr<Orbit::CompositeTree> tree = std::make_shared<Orbit::CompositeTree>();
+	scene.load(*tree);
+
+	ModelMatrixVisitor visitor;
+	report("Visitor", measure(Runs, [&tree, &visitor]() {
+		tree->acceptVisitor(&visitor);
+	}), NodeCount);
+
+	uint64_t total = 0;
+	auto readNode = [&total](const Orbit::Node& node) {
+		const std::shared_ptr<Orbit::Model>& model = node.model();
+		if (model)
+			total += model->getIndices().size() + static_cast<uint64_t>(node.modelMatrix()[3].x);
+	};
+
+	report("CompositeTree::forEach", measure(Runs, [&tree, &readNode]() {
+		tree->forEach(readNode);
+	}), NodeCount);
+
+	report("CompositeTree::forEachNodeOfType", measure(Runs, [&tree, &readNode]() {
+		tree->forEachNodeOfType<BenchmarkNode>(readNode);
+	}), NodeCount);
+
+	keep(visitor.total + total);
+	scene.unload();
+}
\ No newline at end of file
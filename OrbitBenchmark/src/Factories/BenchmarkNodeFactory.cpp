@@ -0,0 +1,53 @@
+/*! @file Factories/BenchmarkNodeFactory.cpp */
+
+#include "Factories/BenchmarkNodeFactory.h"
+
+#include <Game/Factories/InstanceAllocator.h>
+
+using namespace OrbitBenchmark;
+
+BenchmarkNodeFactory::BenchmarkNodeFactory(const Orbit::Input& input, std::shared_ptr<Orbit::Model> model)
+	: NodeFactory(input), _model(model)
+{
+}
+
+std::shared_ptr<Orbit::Node> BenchmarkNodeFactory::create() const
+{
+	return _pool.create(_input, "BenchmarkNode", _model);
+}
+
+std::shared_ptr<Orbit::Node> BenchmarkNodeFactory::create(const std::string& name) const
+{
+	return _pool.create(_input, name, _model);
+}
+
+std::vector<std::shared_ptr<Orbit::Node>> BenchmarkNodeFactory::create(const std::vector<std::string_view>& names) const
+{
+	std::vector<std::shared_ptr<const Orbit::Node::Archetype>> archetypes;
+	archetypes.reserve(names.size());
+
+	// The nodes' names live in their archetypes, allocated in a single block as well.
+	Orbit::InstanceAllocator allocator(names.size() * 2 * sizeof(Orbit::Node::Archetype));
+	for (std::string_view name : names)
+	{
+		std::shared_ptr<Orbit::Node::Archetype> archetype = allocator.create<Orbit::Node::Archetype>();
+		archetype->name = name;
+		archetype->model = _model;
+
+		archetypes.push_back(std::move(archetype));
+	}
+
+	return create(archetypes);
+}
+
+std::vector<std::shared_ptr<Orbit::Node>> BenchmarkNodeFactory::create(const std::vector<std::shared_ptr<const Orbit::Node::Archetype>>& archetypes) const
+{
+	std::vector<std::shared_ptr<Orbit::Node>> nodes;
+	nodes.reserve(archetypes.size());
+	_pool.reserve(archetypes.size());
+
+	for (const std::shared_ptr<const Orbit::Node::Archetype>& archetype : archetypes)
+		nodes.push_back(_pool.create(_input, archetype));
+
+	return nodes;
+}
\ No newline at end of file
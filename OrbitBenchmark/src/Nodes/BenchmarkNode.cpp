@@ -0,0 +1,42 @@
+/*! @file Nodes/BenchmarkNode.cpp */
+
+#include "Nodes/BenchmarkNode.h"
+
+#include <Game/Factories/InstanceAllocator.h>
+
+using namespace OrbitBenchmark;
+
+BenchmarkNode::BenchmarkNode(const Orbit::Input& input, const std::string& name, const std::shared_ptr<Orbit::Model>& model)
+	: Node(input, name, model)
+{
+}
+
+BenchmarkNode::BenchmarkNode(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype)
+	: Node(input, archetype)
+{
+}
+
+BenchmarkNode::BenchmarkNode(BenchmarkNode&& rhs)
+	: Node(std::move(rhs))
+{
+}
+
+BenchmarkNode& BenchmarkNode::operator=(BenchmarkNode&& rhs)
+{
+	Node::operator=(std::move(rhs));
+	return *this;
+}
+
+std::shared_ptr<Orbit::Node> BenchmarkNode::clone() const
+{
+	return std::make_shared<BenchmarkNode>(getInput(), getName(), getModel());
+}
+
+std::shared_ptr<Orbit::Node> BenchmarkNode::instantiate(Orbit::InstanceAllocator& allocator) const
+{
+	return allocator.create<BenchmarkNode>(getInput(), archetype());
+}
+
+void BenchmarkNode::update(std::chrono::nanoseconds /*elapsedTime*/)
+{
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*! @file Scenes/BenchmarkScene.cpp */
+
+#include "Scenes/BenchmarkScene.h"
+
+#include "Factories/BenchmarkNodeFactory.h"
+#include "Nodes/BenchmarkNode.h"
+
+#include <Game/CompositeTree/CompositeTree.h>
+
+#include <cmath>
+
+using namespace OrbitBenchmark;
+
+namespace
+{
+	/*! The distance between two neighbouring nodes. */
+	constexpr float Spacing = 2.f;
+}
+
+BenchmarkScene::BenchmarkScene(size_t nodeCount)
+	: _nodeCount(nodeCount), _side(static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(nodeCount)))))
+{
+}
+
+void BenchmarkScene::loadFactories(const Orbit::Input& input)
+{
+	// No texture: nothing is rendered.
+	std::shared_ptr<Orbit::Model> model = std::make_shared<Orbit::Model>(std::vector<Orbit::Vertex>{
+		{ { -0.5, -0.5, 0 }, { 0, 1 }, { 0, 0, 0 }, { 1, 0, 0, 1 } },
+		{ { 0.5, -0.5, 0 }, { 1, 1 }, { 0, 0, 0 }, { 0, 1, 0, 1 } },
+		{ { 0.5, 0.5, 0 }, { 1, 0 }, { 0, 0, 0 }, { 0, 0, 1, 1 } },
+
+		{ { 0.5, 0.5, 0 }, { 1, 0 }, { 0, 0, 0 }, { 0, 0, 1, 1 } },
+		{ { -0.5, 0.5, 0 }, { 0, 0 }, { 0, 0, 0 }, { 1, 1, 1, 1 } },
+		{ { -0.5, -0.5, 0 }, { 0, 1 }, { 0, 0, 0 }, { 1, 0, 0, 1 } }
+	});
+
+	storeModel("Quad", model);
+	storeFactory<BenchmarkNode>("BenchmarkNode", std::make_unique<BenchmarkNodeFactory>(input, model));
+}
+
+void BenchmarkScene::load(Orbit::CompositeTree& tree)
+{
+	size_t side = _side;
+	tree.addChildren(createNodes<BenchmarkNode>("Node", _nodeCount, [side](BenchmarkNode& node, size_t index) {
+		node.setPosition(Spacing * glm::vec3(static_cast<float>(index % side), static_cast<float>(index / side % side),
+			static_cast<float>(index / (side * side))));
+	}));
+}
+
+void BenchmarkScene::unload()
+{
+}
+
+float BenchmarkScene::extent() const
+{
+	return Spacing * _side;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*! @file main.cpp */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "Benchmarks/FunctionBenchmark.h"
+#include "Benchmarks/SceneFileBenchmark.h"
+#include "Benchmarks/SpatialIndexBenchmark.h"
+#include "Benchmarks/TraversalBenchmark.h"
+
+using namespace OrbitBenchmark;
+
+/*!
+@brief Main function of the benchmarks. Runs the benchmarks named in the arguments, or every benchmark if none is named.
+@param argc The amount of arguments.
+@param argv The argument strings.
+*/
+int main(int argc, char* argv[])
+{
+	const std::vector<std::pair<const char*, void(*)()>> benchmarks = {
+		{ "function", runFunctionBenchmark },
+		{ "traversal", runTraversalBenchmark },
+		{ "spatialindex", runSpatialIndexBenchmark },
+		{ "scenefile", runSceneFileBenchmark },
+	};
+
+	for (int arg = 1; arg < argc; arg++)
+	{
+		auto named = [&argv, arg](const std::pair<const char*, void(*)()>& benchmark) {
+			return std::strcmp(benchmark.first, argv[arg]) == 0;
+		};
+
+		if (std::none_of(benchmarks.begin(), benchmarks.end(), named))
+		{
+			std::cerr << "Unknown benchmark: " << argv[arg] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	try
+	{
+		for (const std::pair<const char*, void(*)()>& benchmark : benchmarks)
+		{
+			bool named = argc < 2;
+			for (int arg = 1; arg < argc; arg++)
+				named = named || std::strcmp(benchmark.first, argv[arg]) == 0;
+
+			if (!named)
+				continue;
+
+			std::cout << "[" << benchmark.first << "]" << std::endl;
+			benchmark.second();
+		}
+	}
+	catch (std::exception& ex)
+	{
+		std::cerr << "Caught exception: " << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
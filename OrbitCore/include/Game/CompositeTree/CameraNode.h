@@ -59,6 +59,13 @@ namespace Orbit
 		*/
 		ORBIT_CORE_API std::shared_ptr<Node> clone() const override;
 
+		/*!
+		@brief Throws an exception, as cameras are not meant to be part of a prefab.
+		@throw std::runtime_error Throws every time.
+		@param allocator The allocator of the batch of instances.
+		*/
+		ORBIT_CORE_API std::shared_ptr<Node> instantiate(InstanceAllocator& allocator) const override;
+
 		/*!
 		@brief Does nothing.
 		@param elapsedTime The elapsed time since the last update cycle.
@@ -33,15 +33,20 @@ namespace Orbit
 		ORBIT_CORE_API explicit CompositeNode(const Input& input, const std::string& name);
 
 		/*!
-		@brief Move constructor for the class. Moves the children as to not have multiple node ownerships.
+		@brief Move constructor for the class. Moves the children as to not have multiple node ownerships. The moved
+		children are detached from their tree.
 		@param rhs the node to move.
 		*/
 		ORBIT_CORE_API CompositeNode(CompositeNode&& rhs);
 
-		ORBIT_CORE_API ~CompositeNode() = default;
+		/*!
+		@brief Destructor for the class. Children kept alive elsewhere are left without a parent.
+		*/
+		ORBIT_CORE_API ~CompositeNode();
 
 		/*!
-		@brief Move assignment operator for the class. Moves the children as to not have multiple node ownerships.
+		@brief Move assignment operator for the class. Moves the children as to not have multiple node ownerships. The
+		moved children are detached from their tree.
 		@param rhs the node to move.
 		@return A reference to this.
 		*/
@@ -56,33 +61,89 @@ namespace Orbit
 		*/
 		ORBIT_CORE_API void acceptVisitor(Visitor* visitor) override;
 
-		/*! 
-		@brief A method to destroy a node. Recursively destroys child nodes.
+		/*!
+		@brief Statically dispatched counterpart of acceptVisitor(): calls a function on the nodes under this one, depth
+		first. Like visitors, the function is passed the leaf nodes, while composite nodes are only walked into. There is
+		no virtual call per node, and the function can be inlined; mods (which only know the Visitor interface) keep going
+		through acceptVisitor().
+		@tparam Function The type of the function, taking a Node&. Must not add or remove nodes.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void forEach(Function&& function)
+		{
+			for (const std::shared_ptr<Node>& child : _children)
+			{
+				if (child->isComposite())
+					static_cast<CompositeNode&>(*child).forEach(function);
+				else
+					function(*child);
+			}
+		}
+
+		/*!
+		@copydoc Orbit::CompositeNode::forEach()
+		*/
+		template<typename Function>
+		void forEach(Function&& function) const
+		{
+			for (const std::shared_ptr<Node>& child : _children)
+			{
+				if (child->isComposite())
+					static_cast<const CompositeNode&>(*child).forEach(function);
+				else
+					function(static_cast<const Node&>(*child));
+			}
+		}
+
+		/*!
+		@brief Attaches the node to a tree, then its children.
+		@param tree The tree the node is now part of.
 		*/
-		ORBIT_CORE_API void destroy() override;
+		ORBIT_CORE_API void attach(CompositeTree& tree) override;
 
 		/*!
-		@brief Updates the node. Calls the update method for child nodes.
+		@brief Detaches the node's children from their tree, then the node itself.
+		*/
+		ORBIT_CORE_API void detach() override;
+
+		/*!
+		@brief Updates the node. Outside of a tree, calls the update method for child nodes. Within a tree, does nothing:
+		children are updated by the tree's scheduler rather than through their parent (see CompositeTree::update()), and
+		the tree only calls this on composite nodes that opted in (see setScheduled()). Overrides may therefore still call
+		this, without updating the children twice.
 		@param elapsedTime The elapsed time since the last update cycle.
 		*/
 		ORBIT_CORE_API virtual void update(std::chrono::nanoseconds elapsedTime);
 
 		/*!
-		@brief Adds a child to this node's children.
+		@brief Adds a child to this node's children. The child is attached to this node's tree, if any.
 		@throw std::runtime_error Throws if the child in param is nullptr.
-		@throw std::runtime_error Throws if the child in param is already in the child hierarchy.
+		@throw std::runtime_error Throws if the child in param is already in the child hierarchy, if its name (or the name
+		of one of its descendants) is already taken in this node's tree, or if it already has a parent.
 		@param child the child to add.
 		*/
 		ORBIT_CORE_API void addChild(std::shared_ptr<Node> child);
 
 		/*!
-		@brief Removes a child at the first level. If this child is not found, nothing is done.
+		@brief Adds a batch of children to this node's children, attaching them to this node's tree, if any. Checks the
+		whole batch at once rather than child by child: either every child is added, or none is.
+		@throw std::runtime_error Throws if any child is nullptr, if two nodes of the incoming subtrees share a name or one
+		of their names is already taken (in this node's tree, or in this node's hierarchy outside of a tree), or if a child
+		already has a parent.
+		@param children The children to add.
+		*/
+		ORBIT_CORE_API void addChildren(const std::vector<std::shared_ptr<Node>>& children);
+
+		/*!
+		@brief Removes a child at the first level, detaching it, in constant time. If this child is not found, nothing is
+		done. The last child takes the removed child's place.
 		@param child the child to remove.
 		*/
 		ORBIT_CORE_API void removeChild(std::shared_ptr<Node> child);
 
 		/*!
-		@brief Clears all children from the composite node.
+		@brief Clears all children from the composite node, detaching them.
 		*/
 		ORBIT_CORE_API void clearChildren();
 
@@ -99,6 +160,11 @@ namespace Orbit
 		ORBIT_CORE_API std::shared_ptr<const Node> find(std::string name) const override;
 
 	protected:
+		/*!
+		@brief Tears the node down along with its children, which are removed (and detached) without being destroyed.
+		*/
+		ORBIT_CORE_API void teardown() override;
+
 		/*!
 		@brief Returns a locked version of the parent.
 		@return the node's parent, or nullptr if none.
@@ -119,17 +185,52 @@ namespace Orbit
 
 		/*!
 		@brief Moves the children in parameter to the children in the tree. Essentially destroys the children
-		in the tree in order to set the new children.
+		in the tree in order to set the new children, which are attached to this node's tree, if any.
 		@param children the children to move.
 		*/
 		ORBIT_CORE_API void moveChildren(std::vector<std::shared_ptr<Node>>&& children);
 
+		/*!
+		@brief Opts the node in to (or out of) being updated by its tree's scheduler, like a leaf node. Within a tree,
+		composite nodes are otherwise never updated: nodes overriding update() call this, usually from their constructor.
+		@throw std::runtime_error Throws if the node's tree is updating.
+		@param scheduled Whether or not the node's tree should update the node.
+		*/
+		ORBIT_CORE_API void setScheduled(bool scheduled);
+
 	private:
-		/*! A weak reference to the node's parent. */
-		std::weak_ptr<CompositeNode> _parent;
+		friend class CompositeTree;
+		friend class Prefab;
+		friend class SceneFile;
+
+		/*!
+		@brief Checks that the names of incoming subtrees are free: unique among themselves, and not taken in the node's tree
+		(or, outside of a tree, in the node's hierarchy). Nodes below the roots of prefab instances are left out, as their
+		names are only unique within their instance (see Node::Archetype::scopedName).
+		@throw std::runtime_error Throws if a name is taken.
+		@param subtrees The roots of the incoming subtrees.
+		@param count The amount of subtrees.
+		*/
+		void checkNames(const std::shared_ptr<Node>* subtrees, size_t count) const;
+
+		/*!
+		@brief Appends a child to the node's children, recording its parent and position. Does not attach it.
+		@param child The child to append.
+		*/
+		void insertChild(std::shared_ptr<Node> child);
+
+		/*!
+		@brief Removes a child from the node's children in constant time. Does not detach it.
+		@param child The child to remove. Must be one of the node's children.
+		@return The removed child.
+		*/
+		std::shared_ptr<Node> extractChild(Node& child);
+
 		/*! A list of the children owned by the node. */
 		std::vector<std::shared_ptr<Node>> _children;
+		/*! Whether or not the node's tree updates the node, see setScheduled(). */
+		bool _scheduled = false;
 	};
 }
 
-#endif //GAME_COMPOSITETREE_COMPOSITENODE_H
+#endif //GAME_COMPOSITETREE_COMPOSITENODE_H
\ No newline at end of file
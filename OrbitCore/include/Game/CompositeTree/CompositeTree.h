@@ -7,13 +7,35 @@
 #include "CompositeNode.h"
 #include "CameraNode.h"
 
+#include "Game/EpochManager.h"
+#include "Game/SpatialIndex.h"
+#include "Game/UpdateScheduler.h"
+#include "Task/Executor.h"
 #include "Util.h"
 
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
 namespace Orbit
 {
 	/*!
 	@brief A concrete specialization of the composite tree structure. Simulates a root node and gives access
-	to tree members (via visitor methods).
+	to tree members (via visitor methods). Owns the timer wheel its nodes schedule their timers on, along with indices of
+	its live nodes by name and by concrete type, maintained as nodes are attached, detached and destroyed.
+	Structural changes requested during the update (spawning, reparenting and destroying nodes) are queued from any thread,
+	then applied as a single batch at the end of the tick, so that no node list changes while it is being iterated over.
+	Nodes leaving the tree are retired rather than released right away: readers on other threads may keep using the
+	nodes they reached from within an epoch (see enterEpoch()), which are only freed once every such reader is done.
+	The tree also keeps its nodes flattened in pre-order, along with the extent of each subtree, so that whole-tree passes
+	iterate over an array rather than chase pointers from parent to child, and indexes them spatially, so that queries
+	over a region of the scene only look at the nodes around it.
+	Leaf nodes are updated through the tree's scheduler rather than by walking the hierarchy: each tick only updates the
+	nodes due on it, according to the period they ask for (see Node::updatePeriod()). Composite nodes are only scheduled
+	when they opt in (see CompositeNode::setScheduled()).
 	*/
 	class CompositeTree final : public CompositeNode
 	{
@@ -24,18 +46,20 @@ namespace Orbit
 		ORBIT_CORE_API CompositeTree();
 		
 		/*!
-		@brief The class's destructor.
+		@brief The class's destructor. Detaches the nodes before the timer wheel goes away.
 		*/
-		ORBIT_CORE_API virtual ~CompositeTree() = default;
+		ORBIT_CORE_API virtual ~CompositeTree();
 
 		/*!
-		@brief Move constructor for the class. Moves rhs's child nodes and invalidates rhs.
+		@brief Move constructor for the class. Moves rhs's child nodes and invalidates rhs. The nodes' timers are cancelled,
+		and scheduled again on this tree's wheel through Node::onAttached().
 		@param rhs the tree to move.
 		*/
 		ORBIT_CORE_API CompositeTree(CompositeTree&& rhs);
 
 		/*!
-		@brief Move assignment operator for the class. Moves rhs's child nodes and invalidates rhs.
+		@brief Move assignment operator for the class. Moves rhs's child nodes and invalidates rhs. The nodes' timers are
+		cancelled, and scheduled again on this tree's wheel through Node::onAttached().
 		@param rhs The tree to move.
 		@return A reference to this.
 		*/
@@ -52,7 +76,153 @@ namespace Orbit
 		ORBIT_CORE_API std::shared_ptr<Node> clone() const override;
 
 		/*!
-		@brief Gets a camera present in the tree's hierarchy, if any.
+		@brief Creates an empty tree, from the allocator of a batch of prefab instances.
+		@param allocator The allocator of the batch of instances.
+		@return The new tree.
+		*/
+		ORBIT_CORE_API std::shared_ptr<Node> instantiate(InstanceAllocator& allocator) const override;
+
+		/*!
+		@brief Returns the node with the name in parameter, if it is in the tree. Constant time, through the tree's index.
+		@param name The name of the node to be found.
+		@return The found node, or nullptr if not found.
+		*/
+		ORBIT_CORE_API std::shared_ptr<Node> find(std::string name) override;
+
+		/*!
+		@copydoc Orbit::CompositeTree::find(std::string)
+		*/
+		ORBIT_CORE_API std::shared_ptr<const Node> find(std::string name) const override;
+
+		/*!
+		@brief Returns the live nodes of a given concrete type (subclasses are indexed under their own type).
+		@param type The type of the nodes.
+		@return The nodes of this type, in no particular order. Invalidated when nodes are attached or detached.
+		*/
+		ORBIT_CORE_API const std::vector<Node*>& nodesOfType(std::type_index type) const;
+
+		/*!
+		@brief Calls a function on every live node of concrete type T. Constant time per node.
+		@tparam T The type of the nodes.
+		@tparam Function The type of the function, taking a T&. Must not attach or detach nodes.
+		@param function The function to call.
+		*/
+		template<typename T, typename Function>
+		void forEachNodeOfType(Function&& function) const
+		{
+			static_assert(std::is_base_of<Node, T>::value, "Only nodes are indexed by type!");
+
+			for (Node* node : nodesOfType(typeid(T)))
+				function(static_cast<T&>(*node));
+		}
+
+		/*!
+		@brief Calls a function on the tree's leaf nodes, like CompositeNode::forEach() and in the same order, but walking
+		the tree's pre-order array linearly (prefetching ahead) instead of recursing through the children lists.
+		@tparam Function The type of the function, taking a Node&. Must not add or remove nodes.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void forEach(Function&& function)
+		{
+			refreshPreorder();
+			forEachInRange(0, _preorder.size(), function);
+		}
+
+		/*!
+		@brief Calls a function on the leaf nodes of one of the tree's subtrees, in pre-order, through the tree's pre-order
+		array. A subtree's nodes are contiguous in the array: no other node is looked at.
+		@throw std::runtime_error Throws if the subtree's root is not in this tree.
+		@tparam Function The type of the function, taking a Node&. Must not add or remove nodes.
+		@param subtree The root of the subtree.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void forEachInSubtree(const CompositeNode& subtree, Function&& function)
+		{
+			if (&subtree == this)
+				return forEach(function);
+
+			if (subtree.tree() != this)
+				throw std::runtime_error("The subtree is not part of this tree!");
+
+			refreshPreorder();
+
+			size_t rootIndex = slotOf(subtree).preorderIndex;
+			forEachInRange(rootIndex + 1, _preorder[rootIndex].subtreeEnd, function);
+		}
+
+		/*!
+		@brief Updates the tree's leaf nodes due on this tick, through the tree's update scheduler (composite nodes are only
+		updated themselves when they opt in, see CompositeNode::setScheduled()), publishes the new state (see Orbit::Node) of those nodes and of the nodes set from outside of
+		the update once they are all done, and applies the structural changes queued in the meantime. The pre-order array
+		is then brought up to date, and so are the model matrices of the subtrees that moved. Last, the retired nodes no
+		reader can still be using are freed.
+		@see Orbit::CompositeTree::applyMutations()
+		@param elapsedTime The elapsed time since the last update cycle.
+		*/
+		ORBIT_CORE_API void update(std::chrono::nanoseconds elapsedTime) override;
+
+		/*!
+		@brief Queues a node to be added to the tree at the end of the tick. Safe to call from any thread.
+		@param node The node to add.
+		@param parent The node's future parent, or nullptr to add it at the root. Must be in the tree by the time the batch is
+		applied, or the node is dropped.
+		*/
+		ORBIT_CORE_API void spawn(std::shared_ptr<Node> node, std::shared_ptr<CompositeNode> parent = nullptr);
+
+		/*!
+		@brief Queues a node of the tree to be moved under another parent at the end of the tick. The node stays attached
+		(and keeps its timers) while it moves. Safe to call from any thread.
+		@param node The node to move.
+		@param parent The node's new parent, or nullptr to move it to the root. The move is dropped if either node is
+		destroyed by the time the batch is applied, or if the parent is in the node's own subtree.
+		*/
+		ORBIT_CORE_API void reparent(std::shared_ptr<Node> node, std::shared_ptr<CompositeNode> parent = nullptr);
+
+		/*!
+		@brief Applies the queued structural changes, in the order they were queued. Removals take constant time each, so
+		that a batch of k changes costs O(k) regardless of the size of the tree. Called at the end of update(); operations
+		queued while the batch is applied (e.g. by nodes' onAttached()) are applied as part of the same batch.
+		@throw std::runtime_error Throws the first error raised while adding a spawned node (see CompositeNode::addChild()).
+		The rest of the batch is still applied before throwing.
+		*/
+		ORBIT_CORE_API void applyMutations();
+
+		/*!
+		@brief Enters the tree's current epoch, for readers on other threads. Nodes reached while the guard lives (through
+		find(), nodesOfType(), a visitor...) stay allocated until it is gone, even if they leave the tree in the meantime.
+		The guard only protects the nodes' memory: the tree's indices and pre-order array, and the nodes' published state
+		and matrices (rewritten by update()), are still only to be read when the tree is not being updated. The engine's
+		own readers (i.e. the model collection) run after the update on the same tick, and need no guard. Safe to call
+		from any thread.
+		@return A guard pinning the epoch, which must not outlive the tree.
+		*/
+		ORBIT_CORE_API EpochGuard enterEpoch();
+
+		/*!
+		@brief Sets the executor over which the tree's nodes are updated. The nodes due on a tick are split in chunks of
+		grainSize nodes, spread over the executor's threads; nodes must then follow the rules of Node::update().
+		@param executor The executor on which to update nodes, or nullptr to update them serially on the calling thread.
+		@param grainSize The amount of nodes updated by a single job.
+		*/
+		ORBIT_CORE_API void setUpdateExecutor(Executor* executor, size_t grainSize = 64);
+
+		/*!
+		@brief Getter for the executor over which the tree's nodes are updated.
+		@return The tree's update executor, or nullptr if the tree updates serially.
+		*/
+		ORBIT_CORE_API Executor* updateExecutor() const;
+
+		/*!
+		@brief Getter for the amount of nodes updated by a single job, when updating in parallel.
+		@return The update grain size.
+		*/
+		ORBIT_CORE_API size_t updateGrainSize() const;
+
+		/*!
+		@brief Gets a camera present in the tree's hierarchy, if any. Constant time, through the tree's name index: camera
+		nodes (including subclasses of CameraNode) are named "CAMERA".
 		@see Orbit::CameraNode
 		@return The tree's camera, or nullptr if not found.
 		*/
@@ -62,7 +232,246 @@ namespace Orbit
 		@copydoc Orbit::CompositeTree::getCamera()
 		*/
 		ORBIT_CORE_API std::shared_ptr<const CameraNode> getCamera() const;
+
+		/*!
+		@brief Getter for the tree's spatial index, holding every node of the tree by its world-space bounds: its model's
+		bounds if it has a model, its position otherwise. Brought up to date at the end of each tick, along with the nodes'
+		model matrices, so that queries see the nodes as published.
+		@return A reference to the tree's spatial index.
+		*/
+		ORBIT_CORE_API const SpatialIndex& spatialIndex() const;
+
+		/*!
+		@brief Getter for the tree's update scheduler, holding the tree's leaf nodes by the period they ask to be updated at.
+		@return A reference to the tree's update scheduler.
+		*/
+		ORBIT_CORE_API const UpdateScheduler& updateScheduler() const;
+
+		/*!
+		@brief Getter for the tree's timer wheel, on which the tree's nodes and the current scene schedule their timers.
+		Advanced by the game's update tick.
+		@return A reference to the tree's timer wheel.
+		*/
+		using Node::timers;
+
+	private:
+		friend class CompositeNode;
+		friend class Node;
+
+		/*! How many nodes ahead of the current one traversals prefetch. */
+		static constexpr size_t PrefetchDistance = 8;
+
+		/*!
+		@brief A node of the pre-order array.
+		*/
+		struct PreorderEntry
+		{
+			/*! The node. */
+			Node* node;
+			/*! One past the index of the node's last descendant: the node's subtree spans [index, subtreeEnd). */
+			size_t subtreeEnd;
+			/*! Whether or not the node is a composite node, so that traversals skip those without touching them. */
+			bool composite;
+		};
+
+		/*!
+		@brief The bookkeeping of a node of the tree, which only means something within the tree: kept here rather than
+		in the node, so that nodes stay small, and reused once the node leaves the tree.
+		*/
+		struct NodeSlot
+		{
+			/*! The node's position in the pre-order array. */
+			size_t preorderIndex = 0;
+			/*! The node's position in the index of nodes of its type. */
+			size_t typeIndexPosition = 0;
+			/*! The node's proxy in the spatial index, or SpatialIndex::NoProxy for the tree itself. */
+			SpatialIndex::Proxy spatialProxy = SpatialIndex::NoProxy;
+			/*! Whether or not the node's local matrix (or its place in the hierarchy) changed since its model matrix was computed. */
+			bool transformDirty = false;
+			/*! Whether or not the node is queued for its state to be published. Protected by _publishMutex. */
+			bool publishQueued = false;
+			/*! The node's timers, cancelled along with the node. */
+			std::vector<TimerHandle> timers;
+		};
+
+		/*!
+		@brief Getter for the bookkeeping of a node of the tree.
+		@param node The node, attached to the tree.
+		@return The node's slot.
+		*/
+		NodeSlot& slotOf(const Node& node)
+		{
+			return _nodeSlots[node._treeSlot];
+		}
+
+		/*!
+		@brief Calls a function on the leaf nodes of a range of the pre-order array.
+		@tparam Function The type of the function, taking a Node&.
+		@param begin The first index of the range.
+		@param end One past the last index of the range.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void forEachInRange(size_t begin, size_t end, Function& function)
+		{
+			for (size_t index = begin; index < end; index++)
+			{
+				if (index + PrefetchDistance < end)
+					prefetch(_preorder[index + PrefetchDistance].node);
+
+				const PreorderEntry& entry = _preorder[index];
+				if (!entry.composite)
+					function(*entry.node);
+			}
+		}
+
+		/*!
+		@brief Publishes the state of the nodes updated on this tick, and of those queued through queuePublish(). Other
+		nodes cannot have changed. Nodes both updated and queued are published once. The nodes whose transform changed are
+		recorded as moved.
+		*/
+		void publishStates();
+
+		/*!
+		@brief Queues a node for its state to be published at the end of the tick, after one of its setters was called.
+		Nodes setting their own state from within their update are left out: they are published anyway.
+		@param node The node.
+		@param moved Whether or not the node's world bounds need to be brought up to date even if its transform did not
+		change, e.g. after it changed model.
+		*/
+		void queuePublish(Node& node, bool moved = false);
+
+		/*!
+		@brief Recomputes the model matrices of the nodes that moved, along with their descendants, and moves them in the
+		spatial index. Only the subtrees of the moved nodes are walked, taken in pre-order so that nested subtrees are
+		walked once: the cost of the pass depends on what moved, not on the size of the tree.
+		*/
+		void updateModelMatrices();
+
+		/*!
+		@brief Recomputes the model matrices of a range of the pre-order array, parents first, and moves the nodes in the
+		spatial index.
+		@param begin The first index of the range.
+		@param end One past the last index of the range.
+		*/
+		void updateModelMatrices(size_t begin, size_t end);
+
+		/*!
+		@brief Recomputes the world-space bounds of a node, from its model matrix.
+		@param node The node.
+		@return The node's model's bounds, transformed; or the node's position if it has no model.
+		*/
+		static const AABB& updateWorldBounds(Node& node);
+
+		/*!
+		@brief Marks the pre-order array as out of date, after a change in the tree's structure.
+		*/
+		void invalidatePreorder();
+
+		/*!
+		@brief Rebuilds the pre-order array if the tree's structure changed since it was last built.
+		*/
+		ORBIT_CORE_API void refreshPreorder();
+
+		/*!
+		@brief A queued structural change.
+		*/
+		struct Mutation
+		{
+			/*! The type of change. */
+			enum class Type
+			{
+				Spawn,
+				Reparent,
+				Destroy
+			};
+
+			/*! The type of change. */
+			Type type;
+			/*! The node to spawn, move or destroy. */
+			std::shared_ptr<Node> node;
+			/*! The node's parent once spawned or moved, or nullptr for the root. */
+			std::shared_ptr<CompositeNode> parent;
+		};
+
+		/*!
+		@brief Queues a destroyed node to be torn down at the end of the tick. Called by Node::destroy().
+		@param node The node to tear down.
+		*/
+		void deferDestroy(std::shared_ptr<Node> node);
+
+		/*!
+		@brief Queues a structural change.
+		@param mutation The change to queue.
+		*/
+		void queueMutation(Mutation&& mutation);
+
+		/*!
+		@brief Applies a single queued change.
+		@param mutation The change to apply.
+		*/
+		void applyMutation(Mutation& mutation);
+
+		/*!
+		@brief Adds a newly attached node to the tree's indices. Called by Node::attach().
+		@param node The node to add.
+		*/
+		void registerNode(Node& node);
+
+		/*!
+		@brief Removes a detached node from the tree's indices, and retires it. Called by Node::detach().
+		@param node The node to remove.
+		*/
+		void unregisterNode(Node& node);
+
+		/*! The wheel running the timers of the tree's nodes. */
+		TimerWheel _timerWheel;
+
+		/*! The bookkeeping of the tree's nodes, the tree itself included, indexed by the nodes' slots. Grown under _publishMutex. */
+		std::vector<NodeSlot> _nodeSlots;
+		/*! The slots of the nodes that left the tree, to give to the next nodes added. */
+		std::vector<uint32_t> _freeNodeSlots;
+
+		/*! The executor over which nodes are updated, or nullptr to update them serially. */
+		Executor* _updateExecutor = nullptr;
+		/*! The amount of nodes updated by a single job. */
+		size_t _updateGrainSize = 64;
+
+		/*! Mutex protecting the queue of structural changes. */
+		std::mutex _mutationsMutex;
+		/*! The structural changes to apply at the end of the tick. */
+		std::vector<Mutation> _mutations;
+
+		/*! Whether or not the tree's nodes are being updated. */
+		bool _updatingNodes = false;
+		/*! Mutex protecting the queue of nodes to publish. */
+		std::mutex _publishMutex;
+		/*! The nodes set through their setters since the last tick, to publish at the end of the tick. */
+		std::vector<Node*> _publishQueue;
+		/*! The nodes published on the current tick. */
+		std::vector<Node*> _published;
+		/*! The nodes that may have moved since the model matrices were last updated. */
+		std::vector<Node*> _movedNodes;
+
+		/*! Index of the tree's nodes by name. */
+		std::unordered_map<std::string, Node*> _nodesByName;
+		/*! Index of the tree's nodes by concrete type. Nodes' slots know their position, so that they are removed in constant time. */
+		std::unordered_map<std::type_index, std::vector<Node*>> _nodesByType;
+
+		/*! The tree's nodes (except the tree itself) in pre-order, with the extents of their subtrees. */
+		std::vector<PreorderEntry> _preorder;
+		/*! Whether or not the tree's structure changed since the pre-order array was built. */
+		bool _preorderDirty = false;
+
+		/*! The tree's nodes (except the tree itself), by world-space bounds. */
+		SpatialIndex _spatialIndex;
+
+		/*! The tree's leaf nodes (and scheduled composite nodes), spread over ticks by update period. */
+		UpdateScheduler _updateScheduler;
+
+		/*! The nodes that left the tree, kept alive until their readers are done. Last, so that they go away first. */
+		EpochManager _epochs;
 	};
 }
 
-#endif //GAME_COMPOSITETREE_COMPOSITETREE_H
+#endif //GAME_COMPOSITETREE_COMPOSITETREE_H
\ No newline at end of file
@@ -4,30 +4,81 @@
 #define GAME_COMPOSITETREE_NODE_H
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <chrono>
-#include <mutex>
+#include <vector>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "Game/SpatialIndex.h"
+#include "Game/TimerWheel.h"
 #include "Util.h"
 
 namespace Orbit
 {
+	class CompositeNode;
+	class CompositeTree;
+	class InstanceAllocator;
 	class Model;
 	class Input;
+	class Prefab;
+	class UpdateScheduler;
 	class Visitor;
 
 	/*!
 	@brief A simple abstract node class to use with higher-level Composite and Visitor models,
 	with obligatory Visitor support.
+	Transforms are double-buffered: a node writes its next state (_position, _rotation and _scale, or the setters) while
+	the getters return the state published at the end of the previous tick. During a tick, nodes therefore see each
+	other as they were at the end of the last one, whatever order (or thread) they are updated in.
+	Transforms are relative to the node's parent. The resulting world matrix is cached, and only recomputed by the tree
+	when the node or one of its ancestors moved: static parts of the scene cost no matrix work.
+	A node's name, model and default transform make up its archetype, which the instances of a prefab share (see
+	Orbit::Prefab): a node only copies its archetype the first time it changes its name or model.
+	Within a tree, nodes are not necessarily updated on every tick: each one asks for an update period, possibly depending
+	on its distance to the camera, and the tree spreads the nodes' updates over the ticks accordingly.
+	Bookkeeping only meaningful within a tree (index positions, spatial proxy, scheduling, timers and per-tick flags) is
+	kept by the tree, in arrays indexed by the node's slot, rather than in the node: on 64-bit builds, a node weighs 320
+	bytes (down from 392), most of them its transforms and matrices.
 	*/
 	class Node : public std::enable_shared_from_this<Node>
 	{
 	public:
+		/*!
+		@brief A node's transform, as published at the end of a tick.
+		*/
+		struct Transform
+		{
+			/*! The node's position. */
+			glm::vec3 position;
+			/*! The node's rotation. */
+			glm::quat rotation;
+			/*! The node's scale. */
+			float scale = 1.f;
+		};
+
+		/*!
+		@brief The immutable part of a node, shared by the instances of a prefab.
+		*/
+		struct Archetype
+		{
+			/*! The node's name. */
+			std::string name;
+			/*! The node's model. */
+			std::shared_ptr<Model> model;
+			/*! The node's default transform. */
+			Transform transform;
+			/*! The local matrix matching the default transform. */
+			glm::mat4 localMatrix{ 1.f };
+			/*! Whether or not the name is only unique within the node's prefab instance, for nodes below an instance's root.
+			Such nodes are left out of their tree's name index: find them from their instance's root. */
+			bool scopedName = false;
+		};
+
 		/*!
 		@brief The class's constructor, for a node where input is not required.
 		@param name The name applied to the node to enable named searching.
@@ -44,7 +95,8 @@ namespace Orbit
 		ORBIT_CORE_API explicit Node(const Input& input, const std::string& name, const std::shared_ptr<Model>& model = nullptr);
 
 		/*!
-		@brief Move constructor for the class. Required by derived classes.
+		@brief Move constructor for the class. Required by derived classes. Timers, tree membership and the instance id stay
+		with rhs, as they refer to it: the new node starts out detached, with an id of its own.
 		@param rhs The node to move.
 		*/
 		ORBIT_CORE_API Node(Node&& rhs);
@@ -52,7 +104,9 @@ namespace Orbit
 		ORBIT_CORE_API virtual ~Node() = default;
 
 		/*!
-		@brief Move assignment operator for the class. Required by derived classes.
+		@brief Move assignment operator for the class. Required by derived classes (and by Orbit::NodePool, which recycles
+		nodes by assigning them a freshly constructed state). Cancels this node's timers and detaches it; rhs keeps its own
+		timers. The node takes rhs's instance id, rhs getting a new one.
 		@param rhs The node to move.
 		@return A reference to this.
 		*/
@@ -74,23 +128,104 @@ namespace Orbit
 		virtual std::shared_ptr<Node> clone() const = 0;
 
 		/*!
-		@brief An abstract method to enable updating on a node, based around a cycle.
-		@param elapsedTime The elapsed time since the last update cycle.
+		@brief An abstract method to create an instance of the node, when it is part of a prefab's template: a detached
+		node of the same type, without children, sharing the node's archetype. Node types construct their instances from
+		archetype() through the allocator, so that a whole batch of instances takes a single allocation.
+		@see Orbit::Prefab
+		@param allocator The allocator of the batch of instances.
+		@return The new instance.
+		*/
+		virtual std::shared_ptr<Node> instantiate(InstanceAllocator& allocator) const = 0;
+
+		/*!
+		@brief An abstract method to enable updating on a node, based around a cycle. Nodes may be updated concurrently
+		when the tree updates in parallel: an update may read anything published by other nodes, but only write the
+		node's own state. Structural changes go through the tree's deferred operations (destroy(), CompositeTree::spawn()
+		and CompositeTree::reparent()), and timers belong in timer callbacks.
+		Within a tree, only leaf nodes are updated by default, by the tree's scheduler rather than through their parent:
+		composite nodes overriding this have to opt in (see CompositeNode::setScheduled()).
+		@see Orbit::CompositeTree::setUpdateExecutor()
+		@param elapsedTime The elapsed time since the node's last update, which may span several ticks (see updatePeriod()).
 		*/
 		virtual void update(std::chrono::nanoseconds elapsedTime) = 0;
 
 		/*!
-		@brief A virtual method to destroy a node. By default, only sets the destroyed property
-		to true.
+		@brief Returns the period at which the node asks to be updated. Returns the period set through setUpdatePeriod() by
+		default; node types override it to be updated less often the further they are from the camera. Called by the tree
+		after each of the node's updates (and when the node is attached), so it must be cheap.
+		@see Orbit::UpdateScheduler
+		@param cameraDistance The distance from the node to the tree's camera, or 0 if the tree has no camera.
+		@return The node's update period. Zero to be updated on every tick.
+		*/
+		ORBIT_CORE_API virtual std::chrono::nanoseconds updatePeriod(float cameraDistance) const;
+
+		/*!
+		@brief Setter for the period at which the node asks to be updated. Within a tree, the node's update() is then passed
+		the time elapsed since its own last update. Takes effect after the node's next update. To be called by the node
+		itself, or outside of the tree's update.
+		@param period The node's update period. Zero to be updated on every tick.
+		*/
+		ORBIT_CORE_API void setUpdatePeriod(std::chrono::nanoseconds period);
+
+		/*!
+		@brief A virtual method to destroy a node. Sets the destroyed property to true right away, so that the node is no
+		longer updated, then tears it down. Within a tree, the tear-down is deferred to the tree's next batch of
+		structural changes, so that destroy() is safe to call from any thread during the tree's update.
+		@see Orbit::Node::teardown()
 		*/
 		ORBIT_CORE_API virtual void destroy();
 
+		/*!
+		@brief Attaches the node to a tree: registers it in the tree's indices, then calls onAttached(). Called by
+		composite nodes when the node is added to an attached parent. Destroyed nodes are not attached.
+		@param tree The tree the node is now part of.
+		*/
+		ORBIT_CORE_API virtual void attach(CompositeTree& tree);
+
+		/*!
+		@brief Detaches the node from its tree, removing it from the tree's indices and cancelling its timers. Called by
+		composite nodes when the node is removed from its parent.
+		*/
+		ORBIT_CORE_API virtual void detach();
+
+		/*!
+		@brief Returns whether or not the node is attached to a tree.
+		@return Whether or not the node is attached.
+		*/
+		ORBIT_CORE_API bool attached() const;
+
+		/*!
+		@brief Getter for the node's parent.
+		@return The composite node holding this node, or nullptr if it has none.
+		*/
+		ORBIT_CORE_API CompositeNode* parent() const;
+
 		/*!
 		@brief Getter for the node's name.
 		@return The name of the node.
 		*/
 		ORBIT_CORE_API std::string getName() const;
 
+		/*!
+		@brief Returns whether or not the node is a composite node, i.e. derives from Orbit::CompositeNode.
+		@return Whether or not the node is a composite node.
+		*/
+		bool isComposite() const
+		{
+			return _composite;
+		}
+
+		/*!
+		@brief Getter for the node's instance id, unique among the nodes of the process. A move-constructed node gets a new
+		id; a move-assigned node takes rhs's, rhs getting a new one, so that a node recycled by a pool is given the id of the
+		fresh state assigned to it. Lets the renderer match instances from one frame to the next.
+		@return The node's instance id.
+		*/
+		uint64_t instanceId() const
+		{
+			return _instanceId;
+		}
+
 		/*!
 		@brief Getter for the node's destroyed property.
 		@see destroy()
@@ -111,47 +246,96 @@ namespace Orbit
 		ORBIT_CORE_API virtual std::shared_ptr<const Node> find(std::string name) const;
 
 		/*!
-		@brief Getter for the node's position.
-		@return The node's position.
+		@brief Getter for the node's published position.
+		@return The node's position, as of the end of the last tick.
 		*/
 		ORBIT_CORE_API glm::vec3 position() const;
 
 		/*!
-		@brief Getter for the node's rotation.
-		@return The node's rotation.
+		@brief Getter for the node's published rotation.
+		@return The node's rotation, as of the end of the last tick.
 		*/
 		ORBIT_CORE_API glm::quat rotation() const;
 
 		/*!
-		@brief Getter for the node's scale.
-		@return The node's scale.
+		@brief Getter for the node's published scale.
+		@return The node's scale, as of the end of the last tick.
 		*/
 		ORBIT_CORE_API float scale() const;
 
 		/*!
-		@brief Computes the model matrix for this node, using the node's position, rotation and scale properties.
+		@brief Getter for the node's published transform.
+		@return The node's transform, as of the end of the last tick.
+		*/
+		ORBIT_CORE_API const Transform& transform() const;
+
+		/*!
+		@brief Getter for the node's local matrix, built from the node's published position, rotation and scale.
+		@return The node's matrix, relative to its parent.
+		*/
+		ORBIT_CORE_API const glm::mat4& localMatrix() const;
+
+		/*!
+		@brief Builds the local matrix of a transform, e.g. to fill in an archetype's along with its default transform.
+		@param transform The transform.
+		@return The matrix, translating, then rotating, then scaling.
+		*/
+		ORBIT_CORE_API static glm::mat4 buildLocalMatrix(const Transform& transform);
+
+		/*!
+		@brief Getter for the node's model (i.e. world) matrix: its parent's model matrix times its local matrix. Brought up
+		to date by the tree at the end of each tick, or when the node is attached. Outside of a tree, this is the node's
+		local matrix.
 		@return The node's model matrix.
 		*/
-		ORBIT_CORE_API glm::mat4 modelMatrix() const;
+		ORBIT_CORE_API const glm::mat4& modelMatrix() const;
 
 		/*!
-		@brief Setter for the node's position.
+		@brief Getter for the node's world-space bounds: its model's bounds once transformed by its model matrix, or its
+		position if it has no model. Brought up to date by the tree along with the model matrix; meaningless outside of a
+		tree.
+		@return The node's world-space bounds.
+		*/
+		const AABB& worldBounds() const
+		{
+			return _worldBounds;
+		}
+
+		/*!
+		@brief Setter for the node's next position, published at the end of the tick (or right away, outside of a tree).
+		To be called by the node itself, or outside of the tree's update.
 		@param newPos The node's new position.
 		*/
 		ORBIT_CORE_API void setPosition(const glm::vec3& newPos);
 
 		/*!
-		@brief Setter for the node's rotation.
+		@brief Setter for the node's next rotation, published at the end of the tick (or right away, outside of a tree).
+		To be called by the node itself, or outside of the tree's update.
 		@param newRot The node's new rotation.
 		*/
 		ORBIT_CORE_API void setRotation(const glm::quat& newRot);
 
 		/*!
-		@brief Setter for the node's scale.
+		@brief Setter for the node's next scale, published at the end of the tick (or right away, outside of a tree). To
+		be called by the node itself, or outside of the tree's update.
 		@param newScale The node's new scale.
 		*/
 		ORBIT_CORE_API void setScale(float newScale);
 
+		/*!
+		@brief Setter for the node's next position, rotation and scale at once, published at the end of the tick (or right
+		away, outside of a tree). To be called by the node itself, or outside of the tree's update.
+		@param newTransform The node's new transform.
+		*/
+		ORBIT_CORE_API void setTransform(const Transform& newTransform);
+
+		/*!
+		@brief Setter for the node's model. Copies the node's archetype first if other instances share it. To be called by
+		the node itself, or outside of the tree's update.
+		@param model The node's new model.
+		*/
+		ORBIT_CORE_API void setModel(const std::shared_ptr<Model>& model);
+
 		/*!
 		@brief Checks if the node has a model assigned.
 		@return Whether the node has a model or not.
@@ -164,21 +348,90 @@ namespace Orbit
 		*/
 		ORBIT_CORE_API std::shared_ptr<Model> getModel() const;
 
+		/*!
+		@brief Non-owning getter for the node's model, for hot paths: the shared pointer is not copied.
+		@return A reference to the node's model, valid for as long as the node (and nullptr if it has none).
+		*/
+		const std::shared_ptr<Model>& model() const
+		{
+			return _archetype->model;
+		}
+
 	protected:
+		/*!
+		@brief Constructor for prefab instances, for a node where input is not required. The node starts out with its
+		archetype's default transform.
+		@param archetype The archetype to share.
+		*/
+		ORBIT_CORE_API explicit Node(const std::shared_ptr<const Archetype>& archetype);
+
+		/*!
+		@brief Constructor for prefab instances, for a node where input is needed. The node starts out with its
+		archetype's default transform.
+		@param input A reference to the input handler of the game.
+		@param archetype The archetype to share.
+		*/
+		ORBIT_CORE_API explicit Node(const Input& input, const std::shared_ptr<const Archetype>& archetype);
+
+		/*!
+		@brief Getter for the node's archetype, to construct instances of the node from.
+		@return The node's archetype.
+		*/
+		ORBIT_CORE_API const std::shared_ptr<const Archetype>& archetype() const;
+
 		/*!
 		@brief Sets a value to the destroyed property. Preferred way to set it.
 		@param value the value to set.
 		*/
 		ORBIT_CORE_API void setDestroyed(bool value);
 
+		/*!
+		@brief Tears a destroyed node down: removes it from its parent, detaches it from its tree and cancels its timers.
+		@see Orbit::Node::destroy()
+		*/
+		ORBIT_CORE_API virtual void teardown();
+
 		/*!
 		@brief Getter for a reference to the node's input handler, passed along during construction.
 		@return A reference to the node's input handler.
 		*/
 		ORBIT_CORE_API const Input& getInput() const;
 
-		/*! Mutex to be used to control access to this object. */
-		mutable std::mutex _mutex;
+		/*!
+		@brief Called once the node is attached to a tree. Nodes schedule their initial timers here. Does nothing by
+		default.
+		*/
+		ORBIT_CORE_API virtual void onAttached();
+
+		/*!
+		@brief Schedules a callback to run once, after a delay of simulated time. The timer is owned by the node: it is
+		cancelled when the node is destroyed or detached.
+		@throw std::runtime_error Throws if the node is not attached to a tree.
+		@param delay The delay after which to run the callback.
+		@param callback The callback to run.
+		*/
+		ORBIT_CORE_API void scheduleTimer(std::chrono::nanoseconds delay, TimerWheel::Callback callback);
+
+		/*!
+		@brief Schedules a callback to run periodically, in simulated time. The timer is owned by the node: it is cancelled
+		when the node is destroyed or detached.
+		@throw std::runtime_error Throws if the node is not attached to a tree.
+		@param period The time between two runs of the callback.
+		@param callback The callback to run.
+		*/
+		ORBIT_CORE_API void scheduleRepeatingTimer(std::chrono::nanoseconds period, TimerWheel::Callback callback);
+
+		/*!
+		@brief Cancels all of the node's timers.
+		*/
+		ORBIT_CORE_API void cancelTimers();
+
+		/*!
+		@brief Getter for the timer wheel of the node's tree, for timers whose handles the node keeps itself.
+		@throw std::runtime_error Throws if the node is not attached to a tree.
+		@return A reference to the node's timer wheel.
+		*/
+		ORBIT_CORE_API TimerWheel& timers() const;
 
 		/*!
 		@brief Simple extension method to add functionality to shared_from_this() functionality.
@@ -193,23 +446,89 @@ namespace Orbit
 			return std::static_pointer_cast<Derived>(shared_from_this());
 		}
 
-		/*! The node's position. */
+		/*! The node's next position. */
 		glm::vec3 _position;
-		/*! The node's rotation. */
+		/*! The node's next rotation. */
 		glm::quat _rotation;
-		/*! The node's scale. */
+		/*! The node's next scale. */
 		float _scale = 1.f;
 
+		/*!
+		@brief Getter for the tree the node is attached to.
+		@return The node's tree, or nullptr if it is not attached.
+		*/
+		ORBIT_CORE_API CompositeTree* tree() const;
+
 	private:
-		/*! The status of the node's destruction. */
-		bool _destroyed = false;
+		friend class CompositeNode;
+		friend class CompositeTree;
+		friend class NodeFactory;
+		friend class Prefab;
+		friend class UpdateScheduler;
+
+		/*!
+		@brief Shares an archetype, starting over from its default transform.
+		@param archetype The archetype to share.
+		*/
+		void adoptArchetype(const std::shared_ptr<const Archetype>& archetype);
+
+		/*!
+		@brief Gives the node an archetype of its own, copying the shared one, so that it can be modified.
+		@return The node's own archetype.
+		*/
+		Archetype& ownArchetype();
+
+		/*!
+		@brief Publishes the node's next state right away outside of a tree, or has the tree publish it at the end of the
+		tick. Called by the setters.
+		*/
+		void stateChanged();
+
+		/*!
+		@brief Publishes the node's next state, making it visible through the getters. Called by the tree at the end of a
+		tick, once every node is done updating, for the nodes updated on the tick and those set through the setters. If the
+		transform changed, the local matrix is rebuilt and the node is flagged for its tree to update the model matrices of
+		its subtree.
+		*/
+		void publishState();
+
+		/*!
+		@brief Hands out the id of a new node.
+		@return A new instance id.
+		*/
+		static uint64_t newInstanceId();
+
+		/*! The status of the node's destruction. Atomic, as it is checked concurrently during parallel updates. */
+		std::atomic<bool> _destroyed{ false };
+		/*! The node's state as of the end of the last tick. */
+		Transform _published;
+		/*! The node's matrix relative to its parent, matching the published state. */
+		glm::mat4 _localMatrix{ 1.f };
+		/*! The node's cached model matrix. */
+		glm::mat4 _worldMatrix{ 1.f };
+		/*! The node's cached world-space bounds, matching its model matrix. */
+		AABB _worldBounds;
 		/*! The node's input handler pointer, allowing nullptr and copy semantics. */
 		const Input* _input = nullptr;
-		/*! The node's name. */
-		std::string _name;
-		/*! The node's model. */
-		std::shared_ptr<Model> _model;
+		/*! The node's name, model and default transform, possibly shared with other instances. Never null. */
+		std::shared_ptr<const Archetype> _archetype;
+
+		/*! Whether or not the node is a composite node. Set by Orbit::CompositeNode's constructors. */
+		bool _composite = false;
+		/*! The node's slot in its tree's bookkeeping arrays, only meaningful while the node is in a tree. */
+		uint32_t _treeSlot = 0;
+		/*! The node's instance id. */
+		uint64_t _instanceId = newInstanceId();
+
+		/*! The tree the node is in, or nullptr when it is not in a tree. */
+		CompositeTree* _tree = nullptr;
+		/*! The node's parent, owning it. nullptr if the node has none. */
+		CompositeNode* _parent = nullptr;
+		/*! The node's position in its parent's children, so that it is removed in constant time. */
+		size_t _childPosition = 0;
+		/*! The period at which the node asks to be updated, zero for every tick. */
+		std::chrono::nanoseconds _updatePeriod = std::chrono::nanoseconds::zero();
 	};
 }
 
-#endif //GAME_COMPOSITETREE_NODE_H
+#endif //GAME_COMPOSITETREE_NODE_H
\ No newline at end of file
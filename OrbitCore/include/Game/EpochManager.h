@@ -0,0 +1,170 @@
+/*! @file Game/EpochManager.h */
+
+#ifndef GAME_EPOCHMANAGER_H
+#define GAME_EPOCHMANAGER_H
+#pragma once
+
+#include "Util.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace Orbit
+{
+	class EpochManager;
+
+	/*!
+	@brief Pins the epoch a reader entered in, for as long as the guard lives. Objects retired from then on are not freed
+	until the guard is gone, so that the reader may keep using the raw pointers it picked up along the way.
+	@note Guards must not outlive their manager.
+	*/
+	class EpochGuard final
+	{
+	public:
+		/*!
+		@brief Builds an empty guard, pinning nothing.
+		*/
+		EpochGuard() = default;
+
+		/*!
+		@brief Destructor for the class. Leaves the epoch.
+		*/
+		~EpochGuard()
+		{
+			leave();
+		}
+
+		/*!
+		@brief Move constructor for the class. Takes over the other guard's pin.
+		@param rhs The guard to move.
+		*/
+		EpochGuard(EpochGuard&& rhs) noexcept
+			: _slot(rhs._slot)
+		{
+			rhs._slot = nullptr;
+		}
+
+		/*!
+		@brief Move assignment operator for the class. Leaves the current epoch, then takes over the other guard's pin.
+		@param rhs The guard to move.
+		@return A reference to this.
+		*/
+		EpochGuard& operator=(EpochGuard&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				leave();
+				_slot = rhs._slot;
+				rhs._slot = nullptr;
+			}
+
+			return *this;
+		}
+
+		EpochGuard(const EpochGuard&) = delete;
+		EpochGuard& operator=(const EpochGuard&) = delete;
+
+		/*!
+		@brief Leaves the epoch early. Pointers picked up under the guard must no longer be used.
+		*/
+		ORBIT_CORE_API void leave() noexcept;
+
+	private:
+		friend class EpochManager;
+
+		/*!
+		@brief Builds a guard holding a reader slot.
+		@param slot The reader slot, holding the pinned epoch.
+		*/
+		explicit EpochGuard(std::atomic<uint64_t>* slot)
+			: _slot(slot)
+		{
+		}
+
+		/*! The reader slot held by the guard, or nullptr for empty guards. */
+		std::atomic<uint64_t>* _slot = nullptr;
+	};
+
+	/*!
+	@brief Epoch-based reclamation: lets readers on any thread hold on to raw pointers while the owning thread retires
+	the objects they point to. Retired objects are kept alive until every reader that could have reached them is gone.
+	Readers only pay for a compare-exchange and a couple of loads when entering, and a store when leaving; nothing is
+	locked.
+	@note Objects are retired and reclaimed by a single thread, the one owning the structure they were removed from.
+	Readers may enter from any thread, up to MaxReaders at once.
+	*/
+	class EpochManager final
+	{
+	public:
+		/*! The maximum amount of readers at once. Further readers wait for a slot to be freed. */
+		static constexpr size_t MaxReaders = 64;
+
+		/*!
+		@brief Constructor for the class.
+		*/
+		ORBIT_CORE_API EpochManager();
+
+		EpochManager(const EpochManager&) = delete;
+		EpochManager& operator=(const EpochManager&) = delete;
+
+		/*!
+		@brief Enters the current epoch. Safe to call from any thread.
+		@return A guard pinning the epoch until destroyed.
+		*/
+		ORBIT_CORE_API EpochGuard enter();
+
+		/*!
+		@brief Retires an object already made unreachable for new readers. Owning thread only.
+		@param object The object to retire. It is released once the readers that could have reached it are gone.
+		*/
+		ORBIT_CORE_API void retire(std::shared_ptr<const void> object);
+
+		/*!
+		@brief Moves to the next epoch, then releases the retired objects no reader can still be using. Owning thread
+		only, typically once per tick.
+		*/
+		ORBIT_CORE_API void reclaim();
+
+		/*!
+		@brief Getter for the amount of retired objects waiting on readers.
+		@return The amount of retired objects not yet released.
+		*/
+		ORBIT_CORE_API size_t retired() const;
+
+	private:
+		/*!
+		@brief A reader slot, on its own cache line so that readers do not contend with one another.
+		*/
+		struct alignas(64) Slot
+		{
+			/*! The epoch pinned by the slot's reader, or Inactive. */
+			std::atomic<uint64_t> epoch{ 0 };
+		};
+
+		/*!
+		@brief A retired object.
+		*/
+		struct Retired
+		{
+			/*! The epoch the object was retired in. */
+			uint64_t epoch;
+			/*! The object, kept alive until released. */
+			std::shared_ptr<const void> object;
+		};
+
+		/*! Marker for free reader slots. Epochs start at 1. */
+		static constexpr uint64_t Inactive = 0;
+
+		/*! The current epoch. */
+		alignas(64) std::atomic<uint64_t> _epoch{ 1 };
+		/*! The readers' slots. */
+		std::array<Slot, MaxReaders> _slots;
+		/*! The retired objects, oldest first. */
+		std::deque<Retired> _retired;
+	};
+}
+
+#endif //GAME_EPOCHMANAGER_H
\ No newline at end of file
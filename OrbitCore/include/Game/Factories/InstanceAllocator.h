@@ -0,0 +1,187 @@
+/*! @file Game/Factories/InstanceAllocator.h */
+
+#ifndef GAME_FACTORIES_INSTANCEALLOCATOR_H
+#define GAME_FACTORIES_INSTANCEALLOCATOR_H
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Orbit
+{
+	/*!
+	@brief Bump allocator handing out the nodes (and shared pointer control blocks) of a batch of prefab instances from a
+	single block of memory, sized up front when the batch's size is known. Nodes are never freed one by one: the block goes
+	away along with the last node allocated from it.
+	@note An allocator is used by one thread at a time; the nodes it creates may then go anywhere.
+	@see Orbit::Prefab
+	*/
+	class InstanceAllocator final
+	{
+	public:
+		/*!
+		@brief Constructor for the class.
+		@param capacity The size of the first block, in bytes. Further blocks are allocated (each twice as large as the
+		previous one) if the first one runs out.
+		*/
+		explicit InstanceAllocator(size_t capacity = 0)
+			: _arena(std::make_shared<Arena>(std::max<size_t>(capacity, MinimumBlockSize)))
+		{
+		}
+
+		/*!
+		@brief Creates a node (or any other object) in the allocator's block.
+		@tparam T The type of the object.
+		@tparam Args The types of the arguments of the object's constructor.
+		@param args The arguments of the object's constructor.
+		@return The object.
+		*/
+		template<typename T, typename... Args>
+		std::shared_ptr<T> create(Args&&... args)
+		{
+			return std::allocate_shared<T>(Allocator<T>(_arena), std::forward<Args>(args)...);
+		}
+
+		/*!
+		@brief Getter for the amount of memory handed out so far.
+		@return The amount of bytes allocated, padding included.
+		*/
+		size_t allocated() const
+		{
+			return _arena->allocated;
+		}
+
+	private:
+		/*! The size of the smallest block. */
+		static constexpr size_t MinimumBlockSize = 1024;
+
+		/*!
+		@brief The blocks the objects are allocated from, shared with their control blocks so that it outlives them.
+		*/
+		struct Arena
+		{
+			/*!
+			@brief Constructor for the class. Allocates the first block.
+			@param capacity The size of the first block.
+			*/
+			explicit Arena(size_t capacity)
+			{
+				addBlock(capacity);
+			}
+
+			/*!
+			@brief Allocates memory from the current block, moving on to a new block if it runs out.
+			@param size The amount of bytes.
+			@param alignment The alignment of the memory.
+			@return The memory.
+			*/
+			void* allocate(size_t size, size_t alignment)
+			{
+				uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+				if (aligned + size > reinterpret_cast<uintptr_t>(end))
+				{
+					addBlock(std::max(blockSize * 2, size + alignment));
+					aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+				}
+
+				unsigned char* memory = reinterpret_cast<unsigned char*>(aligned);
+				allocated += memory + size - cursor;
+				cursor = memory + size;
+				return memory;
+			}
+
+			/*!
+			@brief Allocates a new block, which allocations then come from.
+			@param size The size of the block.
+			*/
+			void addBlock(size_t size)
+			{
+				blocks.emplace_back(new unsigned char[size]);
+				blockSize = size;
+				cursor = blocks.back().get();
+				end = cursor + size;
+			}
+
+			/*! The blocks, freed along with the arena. */
+			std::vector<std::unique_ptr<unsigned char[]>> blocks;
+			/*! The size of the current block. */
+			size_t blockSize = 0;
+			/*! The next free byte of the current block. */
+			unsigned char* cursor = nullptr;
+			/*! The end of the current block. */
+			unsigned char* end = nullptr;
+			/*! The amount of bytes handed out so far. */
+			size_t allocated = 0;
+		};
+
+		/*!
+		@brief Standard allocator handing out the arena's memory.
+		@tparam U The type to allocate (the standard library's control block, once rebound).
+		*/
+		template<typename U>
+		struct Allocator
+		{
+			using value_type = U;
+
+			/*!
+			@brief Constructor for the class.
+			@param arena The arena to allocate from.
+			*/
+			explicit Allocator(std::shared_ptr<Arena> arena)
+				: arena(std::move(arena))
+			{
+			}
+
+			/*!
+			@brief Rebinding constructor for the class.
+			@param rhs The allocator to rebind.
+			*/
+			template<typename V>
+			Allocator(const Allocator<V>& rhs)
+				: arena(rhs.arena)
+			{
+			}
+
+			/*!
+			@brief Allocates storage for objects of type U from the arena.
+			@param count The amount of objects.
+			@return The storage.
+			*/
+			U* allocate(size_t count)
+			{
+				return static_cast<U*>(arena->allocate(count * sizeof(U), alignof(U)));
+			}
+
+			/*!
+			@brief Does nothing: the memory goes back along with the whole arena.
+			*/
+			void deallocate(U*, size_t)
+			{
+			}
+
+			template<typename V>
+			bool operator==(const Allocator<V>& rhs) const
+			{
+				return arena == rhs.arena;
+			}
+
+			template<typename V>
+			bool operator!=(const Allocator<V>& rhs) const
+			{
+				return arena != rhs.arena;
+			}
+
+			/*! The arena to allocate from. */
+			std::shared_ptr<Arena> arena;
+		};
+
+		/*! The arena, shared with the objects' control blocks. */
+		std::shared_ptr<Arena> _arena;
+	};
+}
+
+#endif //GAME_FACTORIES_INSTANCEALLOCATOR_H
\ No newline at end of file
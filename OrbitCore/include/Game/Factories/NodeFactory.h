@@ -6,12 +6,15 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <typeindex>
+#include <vector>
 
+#include "Game/CompositeTree/Node.h"
 #include "Util.h"
 
 namespace Orbit
 {
-	class Node;
 	class Input;
 
 	/*!
@@ -26,6 +29,11 @@ namespace Orbit
 		*/
 		ORBIT_CORE_API NodeFactory(const Input& input);
 
+		/*!
+		@brief Destructor for the class. Virtual, as scenes own their factories through pointers to this class.
+		*/
+		virtual ~NodeFactory() = default;
+
 		/*!
 		@brief Creates a new node instance.
 		@return A new node instance.
@@ -38,9 +46,56 @@ namespace Orbit
 		@return A new node instance with the name in param.*/
 		virtual std::shared_ptr<Node> create(const std::string& name) const = 0;
 
+		/*!
+		@brief Creates a batch of new node instances, one per name. Creates them one by one by default; factories override
+		it to allocate the whole batch at once.
+		@param names The names of the new nodes.
+		@return The new node instances, in the same order as their names.
+		*/
+		ORBIT_CORE_API virtual std::vector<std::shared_ptr<Node>> create(const std::vector<std::string_view>& names) const;
+
+		/*!
+		@brief Creates a batch of new node instances, one per archetype, each sharing its archetype (name, model and default
+		transform) rather than getting one from the factory. Used to load scene files. Creates the nodes one by one, then
+		hands them their archetype, by default; factories override it to construct the whole batch from the archetypes.
+		@param archetypes The archetypes of the new nodes.
+		@return The new node instances, in the same order as their archetypes.
+		*/
+		ORBIT_CORE_API virtual std::vector<std::shared_ptr<Node>> create(const std::vector<std::shared_ptr<const Node::Archetype>>& archetypes) const;
+
+		/*!
+		@brief Creates a batch of new node instances, named after a prefix followed by their index.
+		@param namePrefix The prefix of the names of the new nodes.
+		@param count The amount of nodes to create.
+		@return The new node instances.
+		*/
+		ORBIT_CORE_API std::vector<std::shared_ptr<Node>> create(const std::string& namePrefix, size_t count) const;
+
+		/*!
+		@brief Returns the slot of the factories of a node type, i.e. its index among the factories of a scene. Slots are
+		handed out in order, the first time a type asks for one, and stay the same for the whole process.
+		@tparam T The type of node.
+		@return The type's slot.
+		*/
+		template<typename T>
+		static size_t slot()
+		{
+			// Looked up once per type (and per module, each having its own copy of the static), then read directly.
+			static const size_t typeSlot = slot(typeid(T));
+			return typeSlot;
+		}
+
 	protected:
 		/*! A reference to the input handler for node creation. */
 		const Input& _input;
+
+	private:
+		/*!
+		@brief Returns the slot of a node type, handing out the next one if the type has none yet. Thread-safe.
+		@param type The type of node.
+		@return The type's slot.
+		*/
+		ORBIT_CORE_API static size_t slot(std::type_index type);
 	};
 }
 
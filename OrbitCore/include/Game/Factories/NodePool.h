@@ -0,0 +1,387 @@
+/*! @file Game/Factories/NodePool.h */
+
+#ifndef GAME_FACTORIES_NODEPOOL_H
+#define GAME_FACTORIES_NODEPOOL_H
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Game/CompositeTree/Node.h"
+
+namespace Orbit
+{
+	/*!
+	@brief Slab allocator and recycler for the nodes of a single type, meant to be owned by the type's factory.
+	Nodes are constructed in slabs of contiguous storage, and so are the control blocks of the shared pointers owning them.
+	Once the last reference to a destroyed node goes away, the node is kept aside rather than freed: the next call to
+	create() hands it out again, move-assigned a freshly constructed state. Once warm, churning through short-lived nodes
+	(bullets, particles...) does not go through the heap at all.
+	Nodes that go away without being destroyed are freed normally, their storage going back to the pool.
+	@note The pool is thread-safe: nodes may be created and released from any thread.
+	@tparam T The type of the nodes. Must be move-assignable, like every node is.
+	*/
+	template<typename T>
+	class NodePool final
+	{
+		static_assert(std::is_base_of<Node, T>::value, "Only nodes are pooled!");
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned nodes cannot be pooled!");
+
+	public:
+		/*!
+		@brief Constructor for the class.
+		@param slabSize The amount of nodes (and control blocks) allocated at once when the pool runs out of storage.
+		*/
+		explicit NodePool(size_t slabSize = 64)
+			: _state(std::make_shared<State>(slabSize))
+		{
+		}
+
+		/*!
+		@brief Destructor for the class. Frees the recycled nodes. Nodes still in use stay valid, and are freed normally
+		once released.
+		*/
+		~NodePool()
+		{
+			std::vector<T*> recycled;
+			{
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				_state->closed = true;
+				recycled.swap(_state->recycled);
+			}
+
+			for (T* node : recycled)
+				_state->release(node);
+		}
+
+		NodePool(const NodePool&) = delete;
+		NodePool& operator=(const NodePool&) = delete;
+
+		/*!
+		@brief Creates a node, reusing a recycled one if any.
+		@tparam Args The types of the arguments of the node's constructor.
+		@param args The arguments of the node's constructor.
+		@return The node.
+		*/
+		template<typename... Args>
+		std::shared_ptr<T> create(Args&&... args)
+		{
+			T* node = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				if (!_state->recycled.empty())
+				{
+					node = _state->recycled.back();
+					_state->recycled.pop_back();
+				}
+			}
+
+			if (node)
+			{
+				try
+				{
+					*node = T(std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					_state->release(node);
+					throw;
+				}
+			}
+			else
+			{
+				void* storage = _state->nodes.allocate(_state->mutex);
+
+				try
+				{
+					node = new (storage) T(std::forward<Args>(args)...);
+				}
+				catch (...)
+				{
+					_state->nodes.deallocate(_state->mutex, storage);
+					throw;
+				}
+			}
+
+			return std::shared_ptr<T>(node, Recycler{ _state }, ControlBlockAllocator<T>(_state));
+		}
+
+		/*!
+		@brief Makes room for a batch of nodes, so that creating them takes a single slab (plus one for their control
+		blocks) rather than one every slabSize nodes. Recycled nodes count towards the batch.
+		@param count The amount of nodes about to be created.
+		*/
+		void reserve(size_t count)
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+
+			size_t recycled = _state->recycled.size();
+			_state->nodes.reserve(count > recycled ? count - recycled : 0);
+			_state->controlBlocks.reserve(count);
+		}
+
+		/*!
+		@brief Getter for the amount of destroyed nodes waiting to be reused.
+		@return The amount of recycled nodes.
+		*/
+		size_t recycled() const
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			return _state->recycled.size();
+		}
+
+	private:
+		/*!
+		@brief Storage for fixed-size blocks, allocated in slabs and kept in a free list once released.
+		*/
+		struct Slabs
+		{
+			/*!
+			@brief Allocates a block. The pool's mutex must not be held.
+			@param mutex The pool's mutex.
+			@return The block.
+			*/
+			void* allocate(std::mutex& mutex)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (freeBlocks.empty())
+				{
+					addSlab(std::max(slabSize, reserved));
+					reserved = 0;
+				}
+
+				void* block = freeBlocks.back();
+				freeBlocks.pop_back();
+				return block;
+			}
+
+			/*!
+			@brief Makes sure that a number of blocks are available. The pool's mutex must be held.
+			@param count The amount of blocks.
+			*/
+			void reserve(size_t count)
+			{
+				if (freeBlocks.size() >= count)
+					return;
+
+				// Until the size of the blocks is known, the next slab is made large enough instead.
+				if (blockSize == 0)
+					reserved = std::max(reserved, count);
+				else
+					addSlab(count - freeBlocks.size());
+			}
+
+			/*!
+			@brief Allocates a slab, adding its blocks to the free list. The pool's mutex must be held.
+			@param blockCount The amount of blocks in the slab.
+			*/
+			void addSlab(size_t blockCount)
+			{
+				std::unique_ptr<unsigned char[]> slab(new unsigned char[blockSize * blockCount]);
+				freeBlocks.reserve(freeBlocks.size() + blockCount);
+				for (size_t block = blockCount; block > 0; block--)
+					freeBlocks.push_back(slab.get() + (block - 1) * blockSize);
+
+				slabs.push_back(std::move(slab));
+			}
+
+			/*!
+			@brief Puts a block back in the free list. The pool's mutex must not be held.
+			@param mutex The pool's mutex.
+			@param block The block.
+			*/
+			void deallocate(std::mutex& mutex, void* block)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				freeBlocks.push_back(block);
+			}
+
+			/*! The size of a block, 0 until known (for control blocks, whose type is only known to the standard library). */
+			size_t blockSize = 0;
+			/*! The amount of blocks in a slab. */
+			size_t slabSize = 0;
+			/*! The amount of blocks reserved before their size was known, allocated along with the next slab. */
+			size_t reserved = 0;
+			/*! The slabs, freed along with the pool's state. */
+			std::vector<std::unique_ptr<unsigned char[]>> slabs;
+			/*! The blocks available for allocation. */
+			std::vector<void*> freeBlocks;
+		};
+
+		/*!
+		@brief The state of the pool, shared with the nodes' deleters and control blocks so that it outlives them.
+		*/
+		struct State
+		{
+			/*!
+			@brief Constructor for the class.
+			@param slabSize The amount of blocks in a slab.
+			*/
+			explicit State(size_t slabSize)
+			{
+				nodes.blockSize = roundUp(sizeof(T));
+				nodes.slabSize = slabSize > 0 ? slabSize : 1;
+				controlBlocks.slabSize = nodes.slabSize;
+			}
+
+			/*!
+			@brief Destroys a node and frees its storage.
+			@param node The node.
+			*/
+			void release(T* node)
+			{
+				node->~T();
+				nodes.deallocate(mutex, node);
+			}
+
+			/*! Mutex protecting the pool's state. */
+			std::mutex mutex;
+			/*! Storage for the nodes. */
+			Slabs nodes;
+			/*! Storage for the control blocks. */
+			Slabs controlBlocks;
+			/*! The destroyed nodes, waiting to be reused. */
+			std::vector<T*> recycled;
+			/*! Whether or not the pool is gone, in which case released nodes are no longer recycled. */
+			bool closed = false;
+		};
+
+		/*!
+		@brief Deleter of the pool's nodes, recycling destroyed nodes instead of freeing them.
+		*/
+		struct Recycler
+		{
+			/*!
+			@brief Recycles or frees a node no longer in use.
+			@param node The node.
+			*/
+			void operator()(T* node) const
+			{
+				// Destroyed nodes were torn down, and let go of their children: nothing is kept alive by recycling them.
+				if (node->destroyed())
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (!state->closed)
+					{
+						state->recycled.push_back(node);
+						return;
+					}
+				}
+
+				// Outside of the lock: the node's destructor may release other nodes of the pool.
+				state->release(node);
+			}
+
+			/*! The pool's state. */
+			std::shared_ptr<State> state;
+		};
+
+		/*!
+		@brief Standard allocator handing out the pool's control blocks.
+		@tparam U The type to allocate (the standard library's control block, once rebound).
+		*/
+		template<typename U>
+		struct ControlBlockAllocator
+		{
+			using value_type = U;
+
+			/*!
+			@brief Constructor for the class.
+			@param state The pool's state.
+			*/
+			explicit ControlBlockAllocator(std::shared_ptr<State> state)
+				: state(std::move(state))
+			{
+			}
+
+			/*!
+			@brief Rebinding constructor for the class.
+			@param rhs The allocator to rebind.
+			*/
+			template<typename V>
+			ControlBlockAllocator(const ControlBlockAllocator<V>& rhs)
+				: state(rhs.state)
+			{
+			}
+
+			/*!
+			@brief Allocates storage for objects of type U. Single objects come from the pool's control block slabs.
+			@param count The amount of objects.
+			@return The storage.
+			*/
+			U* allocate(size_t count)
+			{
+				static_assert(alignof(U) <= alignof(std::max_align_t), "Over-aligned control blocks cannot be pooled!");
+
+				if (count == 1 && fits())
+					return static_cast<U*>(state->controlBlocks.allocate(state->mutex));
+
+				return static_cast<U*>(::operator new(count * sizeof(U)));
+			}
+
+			/*!
+			@brief Frees storage allocated by allocate().
+			@param pointer The storage.
+			@param count The amount of objects.
+			*/
+			void deallocate(U* pointer, size_t count)
+			{
+				if (count == 1 && fits())
+					state->controlBlocks.deallocate(state->mutex, pointer);
+				else
+					::operator delete(pointer);
+			}
+
+			/*!
+			@brief Checks whether U fits the pool's control blocks. The first type allocated sets their size.
+			@return Whether or not objects of type U are allocated from the control block slabs.
+			*/
+			bool fits() const
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+
+				if (state->controlBlocks.blockSize == 0)
+					state->controlBlocks.blockSize = roundUp(sizeof(U));
+
+				return state->controlBlocks.blockSize == roundUp(sizeof(U));
+			}
+
+			template<typename V>
+			bool operator==(const ControlBlockAllocator<V>& rhs) const
+			{
+				return state == rhs.state;
+			}
+
+			template<typename V>
+			bool operator!=(const ControlBlockAllocator<V>& rhs) const
+			{
+				return state != rhs.state;
+			}
+
+			/*! The pool's state. */
+			std::shared_ptr<State> state;
+		};
+
+		/*!
+		@brief Rounds a size up to a multiple of the fundamental alignment, so that consecutive blocks stay aligned.
+		@param size The size to round up.
+		@return The rounded size.
+		*/
+		static constexpr size_t roundUp(size_t size)
+		{
+			return (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+		}
+
+		/*! The pool's state. */
+		std::shared_ptr<State> _state;
+	};
+}
+
+#endif //GAME_FACTORIES_NODEPOOL_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*! @file Game/Factories/Prefab.h */
+
+#ifndef GAME_FACTORIES_PREFAB_H
+#define GAME_FACTORIES_PREFAB_H
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Game/CompositeTree/Node.h"
+#include "Util.h"
+
+namespace Orbit
+{
+	class InstanceAllocator;
+
+	/*!
+	@brief An immutable template subtree, instantiated any number of times. Instances share the template's archetypes
+	(names, models and default transforms) rather than copying them: a node only gets an archetype of its own when it
+	changes its name or model (copy on write), while transforms, which every instance carries anyway, start out as a
+	plain copy of the template's. Instances of a batch are allocated from a single block, freed along with the last of
+	them.
+	Instances are detached, ready to be spawned. Their roots are named after the name passed to instantiate(); nodes
+	below the root keep the template's names, which are therefore only unique within their instance: they stay out of the
+	tree's name index, and are searched from their instance's root.
+	@note Instantiation is thread-safe: a prefab may be instantiated from several threads at once.
+	*/
+	class Prefab final
+	{
+	public:
+		/*!
+		@brief Constructor for the class. Takes the template over, its current transforms becoming the instances' default
+		transforms. The template must not be modified afterwards.
+		@throw std::runtime_error Throws if the root is null, attached to a tree or has a parent.
+		@param root The root of the template subtree.
+		*/
+		ORBIT_CORE_API explicit Prefab(std::shared_ptr<Node> root);
+
+		/*!
+		@brief Instantiates the template once.
+		@param name The name of the instance's root.
+		@return The instance's root.
+		*/
+		ORBIT_CORE_API std::shared_ptr<Node> instantiate(const std::string& name) const;
+
+		/*!
+		@brief Instantiates the template several times, allocating the whole batch at once.
+		@param namePrefix The prefix of the names of the instances' roots, followed by the instance's index.
+		@param count The amount of instances.
+		@return The instances' roots.
+		*/
+		ORBIT_CORE_API std::vector<std::shared_ptr<Node>> instantiate(const std::string& namePrefix, size_t count) const;
+
+		/*!
+		@brief Getter for the size of the template.
+		@return The amount of nodes in the template, i.e. in each instance.
+		*/
+		ORBIT_CORE_API size_t size() const;
+
+	private:
+		/*!
+		@brief A node of the template, in pre-order.
+		*/
+		struct Entry
+		{
+			/*! The node. */
+			std::shared_ptr<Node> node;
+			/*! The index of the node's parent among the entries. Unused for the root. */
+			size_t parent;
+		};
+
+		/*!
+		@brief Instantiates the template once, from an allocator.
+		@param allocator The allocator of the batch of instances.
+		@param name The name of the instance's root.
+		@return The instance's root.
+		*/
+		std::shared_ptr<Node> instantiate(InstanceAllocator& allocator, const std::string& name) const;
+
+		/*! The template's nodes, in pre-order: parents come before their children. */
+		std::vector<Entry> _entries;
+		/*! The memory taken by an instance as of the last instantiation, to size the blocks of batches. */
+		mutable std::atomic<size_t> _instanceSize{ 0 };
+	};
+}
+
+#endif //GAME_FACTORIES_PREFAB_H
\ No newline at end of file
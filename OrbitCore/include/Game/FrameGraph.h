@@ -0,0 +1,170 @@
+/*! @file Game/FrameGraph.h */
+
+#ifndef GAME_FRAMEGRAPH_H
+#define GAME_FRAMEGRAPH_H
+#pragma once
+
+#include "Util.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Orbit
+{
+	/*!
+	@brief Flags describing the shared state touched by a frame phase. Phases touching disjoint resources (or only reading
+	the same ones) are free to run concurrently. Bits from FirstCustom onwards are free for mods to use, through
+	Orbit::customFrameResource().
+	*/
+	enum class FrameResource : uint32_t
+	{
+		None = 0,
+
+		/*! The input state (keys, locked mouse movement). */
+		Input = 1 << 0,
+		/*! The current scene and scene transitions. */
+		Scene = 1 << 1,
+		/*! The composite tree and its nodes. */
+		Tree = 1 << 2,
+		/*! The model visitor's buckets of models and transforms. */
+		ModelVisitor = 1 << 3,
+		/*! The frame packet's view/projection matrices. */
+		RenderView = 1 << 4,
+		/*! The frame packet's models and instance transforms. */
+		RenderInstances = 1 << 5,
+
+		/*! The first bit available to mods. */
+		FirstCustom = 1 << 16
+	};
+
+	/*!
+	@brief Combines two sets of frame resources.
+	@param lhs The left hand side of the operation.
+	@param rhs The right hand side of the operation.
+	@return The union of both sets.
+	*/
+	inline constexpr FrameResource operator|(FrameResource lhs, FrameResource rhs)
+	{
+		return static_cast<FrameResource>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+	}
+
+	/*!
+	@brief Intersects two sets of frame resources.
+	@param lhs The left hand side of the operation.
+	@param rhs The right hand side of the operation.
+	@return The intersection of both sets.
+	*/
+	inline constexpr FrameResource operator&(FrameResource lhs, FrameResource rhs)
+	{
+		return static_cast<FrameResource>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+	}
+
+	/*!
+	@brief Returns a resource flag reserved for custom (mod-defined) state.
+	@param index The index of the custom resource, in [0, 16).
+	@return The resource flag.
+	*/
+	inline constexpr FrameResource customFrameResource(unsigned int index)
+	{
+		return static_cast<FrameResource>(static_cast<uint32_t>(FrameResource::FirstCustom) << index);
+	}
+
+	/*!
+	@brief Definition of a frame phase: a named step of the update tick, along with the resources it reads and writes.
+	*/
+	struct FramePhase final
+	{
+		/*! The phase's name, used to position other phases relative to it. */
+		std::string name;
+		/*! The resources read by the phase. */
+		FrameResource reads = FrameResource::None;
+		/*! The resources written by the phase. */
+		FrameResource writes = FrameResource::None;
+		/*! The phase's work, given the tick's elapsed time. */
+		std::function<void(std::chrono::nanoseconds)> run;
+	};
+
+	/*!
+	@brief Declarative description of an update tick, as an ordered list of phases. Two phases conflict when one writes
+	a resource the other touches; conflicting phases run in list order, while the others may run concurrently. The
+	resulting dependencies are recomputed whenever the list changes.
+	@note The graph must not be modified while it is being executed.
+	*/
+	class FrameGraph final
+	{
+	public:
+		/*!
+		@brief Appends a phase at the end of the graph.
+		@throw std::runtime_error Throws if the phase has no function or if its name is already taken.
+		@param phase The phase to add.
+		*/
+		ORBIT_CORE_API void addPhase(FramePhase phase);
+
+		/*!
+		@brief Inserts a phase right before another one, so that it runs before it should they conflict.
+		@throw std::runtime_error Throws if the phase has no function, if its name is already taken or if there is no phase
+		with the name in parameter.
+		@param before The name of the phase to insert before.
+		@param phase The phase to insert.
+		*/
+		ORBIT_CORE_API void insertPhase(const std::string& before, FramePhase phase);
+
+		/*!
+		@brief Removes a phase. If there is no phase with this name, nothing is done.
+		@param name The name of the phase to remove.
+		*/
+		ORBIT_CORE_API void removePhase(const std::string& name);
+
+		/*!
+		@brief Getter for the amount of phases in the graph.
+		@return The amount of phases.
+		*/
+		ORBIT_CORE_API size_t size() const;
+
+		/*!
+		@brief Getter for a phase.
+		@param index The index of the phase, in list order.
+		@return A reference to the phase.
+		*/
+		ORBIT_CORE_API const FramePhase& phase(size_t index) const;
+
+		/*!
+		@brief Getter for the amount of phases that must complete before a phase can run.
+		@param index The index of the phase, in list order.
+		@return The amount of phases the phase depends on.
+		*/
+		ORBIT_CORE_API size_t dependencyCount(size_t index) const;
+
+		/*!
+		@brief Getter for the phases depending on a phase.
+		@param index The index of the phase, in list order.
+		@return The indices of the phases that depend on it.
+		*/
+		ORBIT_CORE_API const std::vector<size_t>& successors(size_t index) const;
+
+	private:
+		/*!
+		@brief Checks that a phase can be added to the graph.
+		@throw std::runtime_error Throws if the phase has no function or if its name is already taken.
+		@param phase The phase to check.
+		*/
+		void validatePhase(const FramePhase& phase) const;
+
+		/*!
+		@brief Recomputes the dependencies between phases.
+		*/
+		void compile();
+
+		/*! The phases, in list order. */
+		std::vector<FramePhase> _phases;
+		/*! The amount of dependencies of every phase. */
+		std::vector<size_t> _dependencyCounts;
+		/*! The successors of every phase. */
+		std::vector<std::vector<size_t>> _successors;
+	};
+}
+
+#endif //GAME_FRAMEGRAPH_H
\ No newline at end of file
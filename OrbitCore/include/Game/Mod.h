@@ -8,6 +8,8 @@
 
 namespace Orbit
 {
+	class FrameGraph;
+
 	/*!
 	@brief Base class defining a Mod for the Orbit engine. Basically a small wrapper for load/unload methods for
 	dynamically loaded libraries.
@@ -34,6 +36,13 @@ namespace Orbit
 		@brief Unload method for the mod. Called when the mod is unloaded (usually at the program's end).
 		*/
 		virtual void unload() = 0;
+
+		/*!
+		@brief Lets the mod add its own phases to the game's update tick. Called once, after load(). Does nothing by default.
+		@see Orbit::FrameGraph
+		@param graph The game's frame graph, already containing the engine's phases.
+		*/
+		virtual void loadPhases(FrameGraph& graph) { }
 	};
 
 	inline Mod::~Mod() = default;
@@ -5,18 +5,22 @@
 #pragma once
 
 #include "Render/Model.h"
+#include "Task/Task.h"
 #include "Util.h"
 
 #include "Factories/NodeFactory.h"
 
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
 
 namespace Orbit
 {
+	class CompositeNode;
 	class CompositeTree;
 	class Node;
 
@@ -24,6 +28,8 @@ namespace Orbit
 	@brief Base class for scene logic. Handles loading of the scene through loadFactories (which load node-creating
 	factories) and load (which instances the scene's initial tree state through those same factories).
 	Custom data is meant to be loaded in the loadFactories() call and unloaded with the given unload() method.
+	Nodes can also be saved to and loaded from scene files, which refer to their nodes' types and models by name: every
+	type needs a factory and a name, and every model a name, registered with storeFactory() and storeModel().
 	*/
 	class Scene
 	{
@@ -40,8 +46,24 @@ namespace Orbit
 		*/
 		virtual void loadFactories(const Input& input) = 0;
 
+		/*!
+		@brief Loads the factories asynchronously, leaving the calling thread free while assets are read and decoded. By
+		default, simply runs loadFactories() on one of the executor's threads; scenes may override it to await their
+		assets instead.
+		@see Orbit::Scene::loadFactories()
+		@param input The game's input.
+		@param executor The executor on which to do the loading.
+		@return A task completing once the factories are loaded.
+		*/
+		virtual Task<> loadFactoriesAsync(const Input& input, Executor& executor)
+		{
+			co_await resumeOn(executor);
+			loadFactories(input);
+		}
+
 		/*!
 		@brief Loads the initial composite tree state. Creates the necessary nodes in the tree, using the loaded factories.
+		Scene-wide timers can be scheduled on the tree's timers(); cancel them in unload() at the latest.
 		@see Orbit::Scene::loadFactories()
 		@param tree The tree in which to load up nodes.
 		*/
@@ -60,10 +82,7 @@ namespace Orbit
 		template<typename T>
 		std::shared_ptr<Node> createNode()
 		{
-			if (_factoryMap.find(typeid(T)) == _factoryMap.end())
-				throw std::runtime_error("Could not create a node for this type in this scene!");
-
-			return _factoryMap[typeid(T)]->create();
+			return factory<T>().create();
 		}
 
 		/*!
@@ -74,29 +93,129 @@ namespace Orbit
 		template<typename T>
 		std::shared_ptr<Node> createNode(const std::string& name)
 		{
-			if (_factoryMap.find(typeid(T)) == _factoryMap.end())
-				throw std::runtime_error("Could not create a node for this type in this scene!");
+			return factory<T>().create(name);
+		}
 
-			return _factoryMap[typeid(T)]->create(name);
+		/*!
+		@brief Creates a batch of nodes of type T from the scene's factories, allocated at once, then initializes them. The
+		nodes are named after a prefix followed by their index, and can be added at once with CompositeNode::addChildren().
+		@tparam T The type of node to create.
+		@tparam Initializer The type of the initializer, taking a T& and the node's index in the batch.
+		@param namePrefix The prefix of the names of the nodes.
+		@param count The amount of nodes to create.
+		@param initializer The function initializing each node (position, rotation...).
+		@return The newly created nodes.
+		*/
+		template<typename T, typename Initializer>
+		std::vector<std::shared_ptr<Node>> createNodes(const std::string& namePrefix, size_t count, Initializer&& initializer)
+		{
+			std::vector<std::shared_ptr<Node>> nodes = factory<T>().create(namePrefix, count);
+
+			for (size_t index = 0; index < nodes.size(); index++)
+				initializer(static_cast<T&>(*nodes[index]), index);
+
+			return nodes;
+		}
+
+		/*!
+		@brief Creates a batch of nodes of type T from the scene's factories, allocated at once.
+		@tparam T The type of node to create.
+		@param namePrefix The prefix of the names of the nodes.
+		@param count The amount of nodes to create.
+		@return The newly created nodes.
+		*/
+		template<typename T>
+		std::vector<std::shared_ptr<Node>> createNodes(const std::string& namePrefix, size_t count)
+		{
+			return factory<T>().create(namePrefix, count);
 		}
 
+		/*!
+		@brief Saves the nodes below a root (but not the root itself) to a scene file.
+		@see Orbit::SceneFile
+		@throw std::runtime_error Throws if the file cannot be written, or if a node's type or model was not stored in the
+		scene.
+		@param path The path to the file.
+		@param root The root of the nodes to save, e.g. a tree.
+		*/
+		ORBIT_CORE_API void saveNodes(const std::string& path, const CompositeNode& root) const;
+
+		/*!
+		@brief Loads the nodes of a scene file. The file is mapped into memory, then its nodes are created type by type,
+		each type in a single batch through its factory, straight from archetypes holding their name, model, transform and
+		local matrix (see NodeFactory::create(const std::vector<std::shared_ptr<const Node::Archetype>>&)).
+		@see Orbit::SceneFile
+		@throw std::runtime_error Throws if the file cannot be read or is malformatted, or if a node's type has no factory
+		(or its model no name) in the scene.
+		@param path The path to the file.
+		@return The nodes at the top of the file, holding the others, ready to be added to a tree with
+		CompositeNode::addChildren().
+		*/
+		ORBIT_CORE_API std::vector<std::shared_ptr<Node>> loadNodes(const std::string& path);
+
 	protected:
 		/*!
 		@brief Stores the factory in parameter to the scene's active factories, to enable simple Node creation with createNode.
+		The type is registered under a name of the scene's choosing, which scene files refer to it by: unlike the name
+		given by typeid, it stays the same across compilers and builds.
 		@see Orbit::Scene::createNode<T>()
+		@throw std::runtime_error Throws if another type was already stored under the same name.
 		@tparam T The type of node registered with the factory.
+		@param typeName The name of the type, in scene files.
 		@param factory The factory to store.
 		*/
 		template<typename T>
-		void storeFactory(std::unique_ptr<NodeFactory> factory)
+		void storeFactory(const std::string& typeName, std::unique_ptr<NodeFactory> factory)
 		{
 			static_assert(std::is_base_of_v<Node, T>, "Cannot store a factory for something that is not a node!");
-			_factoryMap[typeid(T)] = std::move(factory);
+
+			size_t slot = NodeFactory::slot<T>();
+			auto stored = _slotsByTypeName.emplace(typeName, slot);
+			if (!stored.second && stored.first->second != slot)
+				throw std::runtime_error("Another node type was already stored under the name " + typeName + " in this scene!");
+
+			if (slot >= _factories.size())
+				_factories.resize(slot + 1);
+
+			_factories[slot] = std::move(factory);
+			_typeNames[typeid(T)] = typeName;
+		}
+
+		/*!
+		@brief Stores a model under a name, so that scene files can refer to it.
+		@param name The name of the model.
+		@param model The model.
+		*/
+		void storeModel(const std::string& name, std::shared_ptr<Model> model)
+		{
+			_models[name] = std::move(model);
 		}
 
 	private:
-		/*! The scene's map of factories. */
-		std::unordered_map<std::type_index, std::unique_ptr<NodeFactory>> _factoryMap;
+		/*!
+		@brief Returns the factory of a node type.
+		@throw std::runtime_error Throws if the scene has no factory for the type.
+		@tparam T The type of node.
+		@return The type's factory.
+		*/
+		template<typename T>
+		NodeFactory& factory()
+		{
+			size_t slot = NodeFactory::slot<T>();
+			if (slot >= _factories.size() || !_factories[slot])
+				throw std::runtime_error("Could not create a node for this type in this scene!");
+
+			return *_factories[slot];
+		}
+
+		/*! The scene's factories, indexed by the slots of their node types. */
+		std::vector<std::unique_ptr<NodeFactory>> _factories;
+		/*! The slots of the scene's node types, by registered name, for scene files. */
+		std::unordered_map<std::string, size_t> _slotsByTypeName;
+		/*! The registered names of the scene's node types, for scene files. */
+		std::unordered_map<std::type_index, std::string> _typeNames;
+		/*! The scene's models, by name, for scene files. */
+		std::unordered_map<std::string, std::shared_ptr<Model>> _models;
 	};
 }
 
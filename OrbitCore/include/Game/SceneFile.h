@@ -0,0 +1,188 @@
+/*! @file Game/SceneFile.h */
+
+#ifndef GAME_SCENEFILE_H
+#define GAME_SCENEFILE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+
+#include "Util.h"
+
+namespace Orbit
+{
+	class CompositeNode;
+	class Model;
+
+	/*!
+	@brief A binary scene file, memory-mapped for reading: nodes, with their type, name, transform, model and parent.
+	Records are fixed-size and laid out as they are in memory, so that reading a node is a matter of indexing into the
+	mapped file, with nothing to parse. Files are little-endian, like every platform the engine runs on.
+	Node types and models are recorded by the names they are registered with in their scene, so that files stay valid
+	across compilers and builds.
+	@see Orbit::Scene::saveNodes()
+	@see Orbit::Scene::loadNodes()
+	*/
+	class SceneFile final
+	{
+	public:
+		/*! The current version of the format. Files of other versions are rejected. */
+		static constexpr uint32_t Version = 2;
+		/*! The index used for a missing model or parent. */
+		static constexpr uint32_t None = UINT32_MAX;
+
+		/*!
+		@brief A string, stored in the file's string table.
+		*/
+		struct StringRef
+		{
+			/*! The offset of the string in the string table. */
+			uint32_t offset;
+			/*! The length of the string. */
+			uint32_t length;
+		};
+
+		/*!
+		@brief The file's header, pointing to the file's tables.
+		*/
+		struct Header
+		{
+			/*! The file's magic number, "ORBS". */
+			char magic[4];
+			/*! The version of the format the file was written with. */
+			uint32_t version;
+			/*! The amount of node types. */
+			uint32_t typeCount;
+			/*! The amount of models. */
+			uint32_t modelCount;
+			/*! The amount of nodes. */
+			uint32_t nodeCount;
+			/*! The size of the string table. */
+			uint32_t stringsSize;
+			/*! The offset of the node types. */
+			uint64_t typesOffset;
+			/*! The offset of the models. */
+			uint64_t modelsOffset;
+			/*! The offset of the nodes. */
+			uint64_t nodesOffset;
+			/*! The offset of the string table. */
+			uint64_t stringsOffset;
+		};
+
+		/*!
+		@brief A node, in pre-order: parents come before their children.
+		*/
+		struct NodeRecord
+		{
+			/*! The node's name. */
+			StringRef name;
+			/*! The index of the node's type. */
+			uint32_t type;
+			/*! The index of the node's model, or None. */
+			uint32_t model;
+			/*! The index of the node's parent, or None for the nodes at the top. */
+			uint32_t parent;
+			/*! The node's position. */
+			float position[3];
+			/*! The node's rotation, as w, x, y, z. */
+			float rotation[4];
+			/*! The node's scale. */
+			float scale;
+		};
+
+		/*!
+		@brief Writes the nodes below a root to a file. The root itself is not written.
+		@throw std::runtime_error Throws if the file cannot be written, or if a node's type or model has no name.
+		@param path The path to the file.
+		@param root The root of the nodes to write, e.g. a tree.
+		@param typeNames The names of the nodes' types.
+		@param modelNames The names of the nodes' models.
+		*/
+		ORBIT_CORE_API static void write(
+			const std::string& path,
+			const CompositeNode& root,
+			const std::unordered_map<std::type_index, std::string>& typeNames,
+			const std::unordered_map<const Model*, std::string>& modelNames);
+
+		/*!
+		@brief Constructor for the class. Maps the file into memory and checks its header.
+		@throw std::runtime_error Throws if the file cannot be mapped, is not a scene file, or was written with another
+		version of the format.
+		@param path The path to the file.
+		*/
+		ORBIT_CORE_API explicit SceneFile(const std::string& path);
+
+		/*!
+		@brief Destructor for the class. Unmaps the file.
+		*/
+		ORBIT_CORE_API ~SceneFile();
+
+		SceneFile(const SceneFile&) = delete;
+		SceneFile& operator=(const SceneFile&) = delete;
+
+		/*!
+		@brief Getter for the file's header.
+		@return The file's header.
+		*/
+		ORBIT_CORE_API const Header& header() const;
+
+		/*!
+		@brief Getter for the name of a node type.
+		@param type The index of the type.
+		@return The type's name, as registered in the scene.
+		*/
+		ORBIT_CORE_API std::string_view typeName(size_t type) const;
+
+		/*!
+		@brief Getter for the name of a model.
+		@param model The index of the model.
+		@return The model's name.
+		*/
+		ORBIT_CORE_API std::string_view modelName(size_t model) const;
+
+		/*!
+		@brief Getter for the file's nodes, in pre-order.
+		@return The first of the header's nodeCount nodes.
+		*/
+		ORBIT_CORE_API const NodeRecord* nodes() const;
+
+		/*!
+		@brief Getter for a string of the string table.
+		@throw std::runtime_error Throws if the string lies outside of the string table.
+		@param string The string.
+		@return The string, pointing into the mapped file.
+		*/
+		ORBIT_CORE_API std::string_view string(const StringRef& string) const;
+
+	private:
+		/*!
+		@brief Checks the file's magic number and version, and that its tables lie within the file.
+		@throw std::runtime_error Throws if the file is not a scene file, or is malformatted.
+		@param path The path to the file, for error messages.
+		*/
+		void checkHeader(const std::string& path) const;
+
+		/*!
+		@brief Checks that a table lies within the file.
+		@throw std::runtime_error Throws if the table lies outside of the file.
+		@param offset The offset of the table.
+		@param count The amount of elements in the table.
+		@param size The size of an element.
+		*/
+		void checkTable(uint64_t offset, uint64_t count, size_t size) const;
+
+		/*! The mapped file. */
+		const unsigned char* _data = nullptr;
+		/*! The size of the file. */
+		size_t _size = 0;
+		/*! The handle of the file mapping, where the platform has one. */
+		void* _mappingHandle = nullptr;
+	};
+}
+
+#endif //GAME_SCENEFILE_H
\ No newline at end of file
@@ -0,0 +1,321 @@
+/*! @file Game/SpatialIndex.h */
+
+#ifndef GAME_SPATIALINDEX_H
+#define GAME_SPATIALINDEX_H
+#pragma once
+
+#include "Render/Bounds.h"
+#include "Util.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Orbit
+{
+	class Node;
+
+	/*!
+	@brief Dynamic bounding volume hierarchy over nodes, answering box, sphere, ray and nearest-neighbour queries in
+	logarithmic time rather than by scanning every node.
+	Leaves store a "fat" box, grown by a margin around the node's actual bounds: a node moving within its fat box costs
+	nothing, and only nodes leaving it are taken out and inserted again. Insertion picks the sibling with the smallest
+	increase in surface area, and rotations keep the hierarchy balanced.
+	Boxes are kept apart from the hierarchy's links, in an array of their own, so that traversals stream through them.
+	@note Queries may run concurrently with each other, but not with insertions, removals and moves.
+	*/
+	class SpatialIndex final
+	{
+	public:
+		/*! Identifier of a node in the index. */
+		using Proxy = uint32_t;
+
+		/*! Marker for "no proxy", i.e. a node that is not in the index. */
+		static constexpr Proxy NoProxy = UINT32_MAX;
+
+		/*!
+		@brief Constructor for the class.
+		@param margin How much leaves' boxes are grown by, so that nodes can move around a bit without being reinserted.
+		*/
+		ORBIT_CORE_API explicit SpatialIndex(float margin = 0.1f);
+
+		/*!
+		@brief Adds a node to the index.
+		@param node The node.
+		@param bounds The node's bounds, in world space.
+		@return The node's proxy, to move it and remove it.
+		*/
+		ORBIT_CORE_API Proxy insert(Node& node, const AABB& bounds);
+
+		/*!
+		@brief Removes a node from the index.
+		@param proxy The node's proxy.
+		*/
+		ORBIT_CORE_API void remove(Proxy proxy);
+
+		/*!
+		@brief Updates the bounds of a node. The node is only reinserted if it left its fat box.
+		@param proxy The node's proxy.
+		@param bounds The node's new bounds, in world space.
+		@return Whether or not the node had to be reinserted.
+		*/
+		ORBIT_CORE_API bool move(Proxy proxy, const AABB& bounds);
+
+		/*!
+		@brief Getter for the bounds of a node in the index.
+		@param proxy The node's proxy.
+		@return The node's bounds, as last inserted or moved.
+		*/
+		ORBIT_CORE_API const AABB& bounds(Proxy proxy) const;
+
+		/*!
+		@brief Getter for the amount of nodes in the index.
+		@return The amount of nodes in the index.
+		*/
+		ORBIT_CORE_API size_t size() const;
+
+		/*!
+		@brief Calls a function on every node whose bounds overlap a box.
+		@tparam Function The type of the function, taking a Node&.
+		@param box The box.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void queryBox(const AABB& box, Function&& function) const
+		{
+			traverse([&box](const AABB& bounds) {
+				return bounds.overlaps(box);
+			}, [&](uint32_t leaf) {
+				if (_leaves[leaf].bounds.overlaps(box))
+					function(*_leaves[leaf].node);
+
+				return true;
+			});
+		}
+
+		/*!
+		@brief Calls a function on every node whose bounds overlap a sphere.
+		@tparam Function The type of the function, taking a Node&.
+		@param center The sphere's center.
+		@param radius The sphere's radius.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void querySphere(const glm::vec3& center, float radius, Function&& function) const
+		{
+			float radiusSquared = radius * radius;
+
+			traverse([&](const AABB& bounds) {
+				return bounds.distanceSquared(center) <= radiusSquared;
+			}, [&](uint32_t leaf) {
+				if (_leaves[leaf].bounds.distanceSquared(center) <= radiusSquared)
+					function(*_leaves[leaf].node);
+
+				return true;
+			});
+		}
+
+		/*!
+		@brief Casts a ray through the index, calling a function on every node whose bounds it hits, in no particular order.
+		The function returns how far along the ray to keep looking: the hit's distance to only look for closer hits,
+		maxDistance to keep looking for every hit, or 0 to stop.
+		@tparam Function The type of the function, taking a Node& and the distance to its bounds, returning a float.
+		@param origin The ray's origin.
+		@param direction The ray's direction, normalized.
+		@param maxDistance How far along the ray to look.
+		@param function The function to call.
+		*/
+		template<typename Function>
+		void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Function&& function) const
+		{
+			// Zero components turn into infinities, which the slab test handles as "parallel to the slab".
+			glm::vec3 inverseDirection(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+
+			traverse([&](const AABB& bounds) {
+				return intersectRay(bounds, origin, inverseDirection, maxDistance) <= maxDistance;
+			}, [&](uint32_t leaf) {
+				float distance = intersectRay(_leaves[leaf].bounds, origin, inverseDirection, maxDistance);
+				if (distance <= maxDistance)
+					maxDistance = function(*_leaves[leaf].node, distance);
+
+				return maxDistance > 0.f;
+			});
+		}
+
+		/*!
+		@brief Finds the nodes closest to a point, by distance to their bounds (0 for the nodes containing the point).
+		@param point The point.
+		@param count The maximum amount of nodes to return.
+		@return Up to count nodes, closest first.
+		*/
+		ORBIT_CORE_API std::vector<Node*> nearest(const glm::vec3& point, size_t count) const;
+
+	private:
+		/*! Marker for "no element" in the hierarchy's links. */
+		static constexpr uint32_t None = UINT32_MAX;
+
+		/*!
+		@brief An element of the hierarchy. Leaves have no children, and refer to a node through their leaf index.
+		*/
+		struct Element
+		{
+			/*! The element's parent, or None for the root (and for freed elements, whose next free element it holds). */
+			uint32_t parent = None;
+			/*! The element's children, None for leaves. */
+			uint32_t children[2] = { None, None };
+			/*! The element's height in the hierarchy, 0 for leaves. */
+			int32_t height = 0;
+			/*! The leaf's index in the leaves array, for leaves. */
+			uint32_t leaf = None;
+		};
+
+		/*!
+		@brief A node in the index.
+		*/
+		struct Leaf
+		{
+			/*! The node, or nullptr for freed leaves. */
+			Node* node = nullptr;
+			/*! The node's actual bounds. */
+			AABB bounds;
+			/*! The leaf's element in the hierarchy (or the next free leaf, once freed). */
+			uint32_t element = None;
+		};
+
+		/*!
+		@brief Walks the hierarchy depth first.
+		@tparam Overlaps The type of the predicate telling whether a box is to be walked into.
+		@tparam Visit The type of the function called on leaves, returning whether to go on.
+		@param overlaps The predicate telling whether a box is to be walked into.
+		@param visit The function called on leaves whose fat box passes the predicate, returning whether to go on.
+		*/
+		template<typename Overlaps, typename Visit>
+		void traverse(Overlaps&& overlaps, Visit&& visit) const
+		{
+			if (_root == None)
+				return;
+
+			// The hierarchy is balanced, hence shallow: a stack on the stack covers any realistic depth, the heap only
+			// taking over past that.
+			constexpr size_t LocalStackSize = 64;
+			uint32_t localStack[LocalStackSize];
+			std::vector<uint32_t> overflow;
+			size_t size = 0;
+
+			localStack[size++] = _root;
+			while (size > 0)
+			{
+				uint32_t index;
+				if (size > LocalStackSize)
+				{
+					index = overflow.back();
+					overflow.pop_back();
+				}
+				else
+					index = localStack[size - 1];
+
+				size--;
+
+				if (!overlaps(_boxes[index]))
+					continue;
+
+				const Element& element = _elements[index];
+				if (element.leaf != None)
+				{
+					if (!visit(element.leaf))
+						return;
+
+					continue;
+				}
+
+				for (uint32_t child : element.children)
+				{
+					if (size < LocalStackSize)
+						localStack[size] = child;
+					else
+						overflow.push_back(child);
+
+					size++;
+				}
+			}
+		}
+
+		/*!
+		@brief Slab test between a ray and a box.
+		@param box The box.
+		@param origin The ray's origin.
+		@param inverseDirection The inverse of each of the ray's direction components.
+		@param maxDistance How far along the ray to look.
+		@return The distance along the ray at which it enters the box (0 if it starts inside), or a value above maxDistance
+		if it misses.
+		*/
+		static float intersectRay(const AABB& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+		{
+			glm::vec3 near = (box.min - origin) * inverseDirection;
+			glm::vec3 far = (box.max - origin) * inverseDirection;
+
+			glm::vec3 entry = glm::min(near, far);
+			glm::vec3 exit = glm::max(near, far);
+
+			float enter = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.f));
+			float leave = std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+
+			return enter <= leave ? enter : std::numeric_limits<float>::infinity();
+		}
+
+		/*!
+		@brief Allocates an element of the hierarchy, along with its box.
+		@return The element's index.
+		*/
+		uint32_t allocateElement();
+
+		/*!
+		@brief Frees an element of the hierarchy.
+		@param index The element's index.
+		*/
+		void freeElement(uint32_t index);
+
+		/*!
+		@brief Inserts a leaf element in the hierarchy, next to the sibling making for the cheapest hierarchy.
+		@param element The leaf element, whose box is set.
+		*/
+		void insertElement(uint32_t element);
+
+		/*!
+		@brief Takes a leaf element out of the hierarchy. Its parent is freed, its sibling taking its place.
+		@param element The leaf element.
+		*/
+		void removeElement(uint32_t element);
+
+		/*!
+		@brief Fixes the boxes and heights of an element's ancestors, rebalancing them along the way.
+		@param index The first element to fix.
+		*/
+		void refitFrom(uint32_t index);
+
+		/*!
+		@brief Rotates an element's subtree if one of its children is more than one level deeper than the other.
+		@param index The element.
+		@return The element now at the subtree's root.
+		*/
+		uint32_t balance(uint32_t index);
+
+		/*! How much leaves' boxes are grown by. */
+		float _margin;
+		/*! The boxes of the hierarchy's elements, fat boxes for leaves. Indexed like _elements. */
+		std::vector<AABB> _boxes;
+		/*! The hierarchy's elements. */
+		std::vector<Element> _elements;
+		/*! The nodes in the index. Indices are proxies: they never change for as long as the node is in the index. */
+		std::vector<Leaf> _leaves;
+		/*! The root of the hierarchy, or None if empty. */
+		uint32_t _root = None;
+		/*! The first free element, or None. */
+		uint32_t _freeElements = None;
+		/*! The first free leaf, or None. */
+		uint32_t _freeLeaves = None;
+		/*! The amount of nodes in the index. */
+		size_t _size = 0;
+	};
+}
+
+#endif //GAME_SPATIALINDEX_H
\ No newline at end of file
@@ -0,0 +1,287 @@
+/*! @file Game/TimerWheel.h */
+
+#ifndef GAME_TIMERWHEEL_H
+#define GAME_TIMERWHEEL_H
+#pragma once
+
+#include "Task/InplaceFunction.h"
+#include "Util.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Orbit
+{
+	class TimerWheel;
+
+	/*!
+	@brief Owning handle to a timer scheduled on a TimerWheel. Cancels the timer when destroyed, so that a timer never
+	outlives the object its callback refers to.
+	@note Handles must not outlive their wheel.
+	*/
+	class TimerHandle final
+	{
+	public:
+		/*!
+		@brief Builds an empty handle, referring to no timer.
+		*/
+		TimerHandle() = default;
+
+		/*!
+		@brief Destructor for the class. Cancels the timer, if it is still pending.
+		*/
+		~TimerHandle()
+		{
+			cancel();
+		}
+
+		/*!
+		@brief Move constructor for the class. Takes over the other handle's timer.
+		@param rhs The handle to move.
+		*/
+		TimerHandle(TimerHandle&& rhs) noexcept
+			: _wheel(rhs._wheel), _index(rhs._index), _generation(rhs._generation)
+		{
+			rhs._wheel = nullptr;
+		}
+
+		/*!
+		@brief Move assignment operator for the class. Cancels the current timer, then takes over the other handle's.
+		@param rhs The handle to move.
+		@return A reference to this.
+		*/
+		TimerHandle& operator=(TimerHandle&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				cancel();
+
+				_wheel = rhs._wheel;
+				_index = rhs._index;
+				_generation = rhs._generation;
+				rhs._wheel = nullptr;
+			}
+
+			return *this;
+		}
+
+		TimerHandle(const TimerHandle&) = delete;
+		TimerHandle& operator=(const TimerHandle&) = delete;
+
+		/*!
+		@brief Cancels the timer, if it is still pending. Safe to call from within the timer's own callback.
+		*/
+		ORBIT_CORE_API void cancel() noexcept;
+
+		/*!
+		@brief Returns whether or not the timer is still pending, i.e. it did not fire yet (or repeats) and was not cancelled.
+		@return Whether or not the timer is still pending.
+		*/
+		ORBIT_CORE_API bool active() const noexcept;
+
+		/*!
+		@brief Detaches the handle from its timer, which is then left to run until it expires (or forever, if it repeats).
+		*/
+		void release() noexcept
+		{
+			_wheel = nullptr;
+		}
+
+	private:
+		friend class TimerWheel;
+
+		/*!
+		@brief Builds a handle to a timer.
+		@param wheel The wheel on which the timer is scheduled.
+		@param index The index of the timer in the wheel's storage.
+		@param generation The generation of the timer's storage, telling it apart from timers previously stored there.
+		*/
+		TimerHandle(TimerWheel* wheel, uint32_t index, uint32_t generation)
+			: _wheel(wheel), _index(index), _generation(generation)
+		{
+		}
+
+		/*! The wheel on which the timer is scheduled. nullptr for empty handles. */
+		TimerWheel* _wheel = nullptr;
+		/*! The index of the timer in the wheel's storage. */
+		uint32_t _index = 0;
+		/*! The generation of the timer's storage when it was scheduled. */
+		uint32_t _generation = 0;
+	};
+
+	/*!
+	@brief Hierarchical timer wheel, running one-shot and repeating callbacks once their delay has elapsed. Time only moves
+	forward when the wheel is advanced, i.e. by the update tick: timers follow simulated time, not wall-clock time.
+	Scheduling and cancelling a timer are O(1), and so is advancing by one step of the wheel's resolution: pending timers
+	cost nothing until they are due, no matter how many of them there are.
+	@note The wheel is not thread-safe. Timers must be scheduled, cancelled and fired from the thread advancing the wheel.
+	*/
+	class TimerWheel final
+	{
+	public:
+		/*! Type of the callbacks run by timers. */
+		using Callback = InplaceFunction<void(), 48>;
+
+		/*!
+		@brief Constructor for the class.
+		@param resolution The wheel's resolution: timers fire on the first step at or after their deadline.
+		*/
+		ORBIT_CORE_API explicit TimerWheel(std::chrono::nanoseconds resolution = std::chrono::milliseconds(1));
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		/*!
+		@brief Schedules a callback to run once, after a delay.
+		@param delay The delay after which to run the callback.
+		@param callback The callback to run.
+		@return A handle to the timer, cancelling it when destroyed.
+		*/
+		ORBIT_CORE_API TimerHandle schedule(std::chrono::nanoseconds delay, Callback callback);
+
+		/*!
+		@brief Schedules a callback to run periodically, until the timer is cancelled. Periods are measured from the timer's
+		previous deadline rather than from when it actually fired, so that a repeating timer does not drift.
+		@param period The time between two runs of the callback, the first run being one period from now.
+		@param callback The callback to run.
+		@return A handle to the timer, cancelling it when destroyed.
+		*/
+		ORBIT_CORE_API TimerHandle scheduleRepeating(std::chrono::nanoseconds period, Callback callback);
+
+		/*!
+		@brief Moves the wheel's time forward, running the callbacks of the timers that come due, in deadline order.
+		Callbacks may schedule and cancel timers, including their own.
+		@param elapsedTime The elapsed time since the last advance.
+		*/
+		ORBIT_CORE_API void advance(std::chrono::nanoseconds elapsedTime);
+
+		/*!
+		@brief Getter for the amount of pending timers.
+		@return The amount of pending timers.
+		*/
+		ORBIT_CORE_API size_t pending() const;
+
+		/*!
+		@brief Getter for the wheel's time, i.e. the total time it was advanced by.
+		@return The wheel's time.
+		*/
+		ORBIT_CORE_API std::chrono::nanoseconds now() const;
+
+	private:
+		friend class TimerHandle;
+
+		/*! The amount of bits of a deadline handled by each level of the wheel. */
+		static constexpr unsigned int LevelBits = 6;
+		/*! The amount of slots in each level. */
+		static constexpr uint32_t SlotCount = 1 << LevelBits;
+		/*! The amount of levels. Deadlines up to SlotCount ^ LevelCount steps away are placed directly. */
+		static constexpr unsigned int LevelCount = 4;
+		/*! Index of the list holding the timers being fired, after the slots' lists. */
+		static constexpr uint32_t ExpiringList = LevelCount * SlotCount;
+		/*! Marker for "no timer" and "in no list". */
+		static constexpr uint32_t None = UINT32_MAX;
+
+		/*!
+		@brief A timer, stored in an intrusive doubly linked list: either a slot's or the expiring list.
+		*/
+		struct Timer
+		{
+			/*! The callback to run. */
+			Callback callback;
+			/*! The step at which the timer is due. */
+			uint64_t deadline = 0;
+			/*! The timer's period in steps, or 0 if it only runs once. */
+			uint64_t period = 0;
+			/*! Incremented whenever the timer is freed, invalidating the handles to it. */
+			uint32_t generation = 0;
+			/*! The list the timer is in, or None if it is not in a list (free, or firing). */
+			uint32_t list = None;
+			/*! The previous timer in the list. */
+			uint32_t previous = None;
+			/*! The next timer in the list (or in the free list, once freed). */
+			uint32_t next = None;
+			/*! Whether or not the timer's callback is currently running. */
+			bool firing = false;
+			/*! Whether or not the timer was cancelled while its callback was running. */
+			bool cancelled = false;
+		};
+
+		/*!
+		@brief Stores a new timer, then places it in the wheel.
+		@param delay The delay before the timer's first run.
+		@param period The timer's period, or 0 if it only runs once.
+		@param callback The callback to run.
+		@return A handle to the timer.
+		*/
+		TimerHandle add(std::chrono::nanoseconds delay, std::chrono::nanoseconds period, Callback callback);
+
+		/*!
+		@brief Cancels a timer. Does nothing if the timer already expired or was cancelled.
+		@param index The index of the timer.
+		@param generation The generation of the timer when the handle was created.
+		*/
+		void cancel(uint32_t index, uint32_t generation) noexcept;
+
+		/*!
+		@brief Checks whether a timer is pending.
+		@param index The index of the timer.
+		@param generation The generation of the timer when the handle was created.
+		@return Whether or not the timer is pending.
+		*/
+		bool active(uint32_t index, uint32_t generation) const noexcept;
+
+		/*!
+		@brief Places a timer in the slot matching its deadline. The level is picked from the highest bit in which the
+		deadline differs from the current step, so that the timer is cascaded down exactly when it gets close enough.
+		@param index The index of the timer.
+		*/
+		void place(uint32_t index);
+
+		/*!
+		@brief Advances the wheel by one step: cascades the higher levels' timers that got close enough, then fires the
+		timers due on this step.
+		*/
+		void step();
+
+		/*!
+		@brief Pushes a timer at the front of a list.
+		@param list The index of the list.
+		@param index The index of the timer.
+		*/
+		void link(uint32_t list, uint32_t index);
+
+		/*!
+		@brief Removes a timer from its list.
+		@param index The index of the timer.
+		*/
+		void unlink(uint32_t index);
+
+		/*!
+		@brief Frees a timer, destroying its callback and invalidating the handles to it.
+		@param index The index of the timer.
+		*/
+		void free(uint32_t index);
+
+		/*! The wheel's resolution. */
+		std::chrono::nanoseconds _resolution;
+		/*! The elapsed time not yet accounted for by a step. */
+		std::chrono::nanoseconds _remainder = std::chrono::nanoseconds::zero();
+		/*! The current step. */
+		uint64_t _currentStep = 0;
+
+		/*! The timers. A deque, so that a callback being run stays in place when other timers are scheduled. */
+		std::deque<Timer> _timers;
+		/*! The first free timer, or None. */
+		uint32_t _freeTimers = None;
+		/*! The amount of pending timers. */
+		size_t _pending = 0;
+
+		/*! The heads of every slot's list, level by level, followed by the head of the expiring list. */
+		std::array<uint32_t, LevelCount * SlotCount + 1> _lists;
+	};
+}
+
+#endif //GAME_TIMERWHEEL_H
\ No newline at end of file
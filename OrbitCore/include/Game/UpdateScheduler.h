@@ -0,0 +1,169 @@
+/*! @file Game/UpdateScheduler.h */
+
+#ifndef GAME_UPDATESCHEDULER_H
+#define GAME_UPDATESCHEDULER_H
+#pragma once
+
+#include "Util.h"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Orbit
+{
+	class Executor;
+	class Node;
+
+	/*!
+	@brief Spreads the updates of a tree's nodes over ticks, according to the period each node asks for (see
+	Node::updatePeriod()). Nodes are sorted into rate classes: nodes of class r are updated every 2^r ticks, split over
+	2^r round-robin buckets, one of which is updated per tick. A tick therefore only looks at the nodes due on it: its
+	cost depends on how often nodes ask to be updated, not on how many of them there are.
+	Each node is passed the time elapsed since its own last update, and its period is looked at again right after, so
+	that nodes change class as they get closer to (or further from) the camera. While every node is updated every tick,
+	ticks skip the bucket bookkeeping altogether and go over class 0's bucket as is.
+	@note The scheduler is not thread-safe: nodes are added and removed from the thread updating the tree, and only their
+	update() runs concurrently, when the scheduler is given an executor.
+	*/
+	class UpdateScheduler final
+	{
+	public:
+		/*! The amount of rate classes: nodes are updated at least once every 2^(RateCount - 1) ticks. */
+		static constexpr uint32_t RateCount = 9;
+		/*! Marker for "in no bucket". */
+		static constexpr uint32_t NoBucket = UINT32_MAX;
+
+		/*!
+		@brief A node's place in the scheduler, kept in the slot of the node's tree so that it is removed in constant time.
+		*/
+		struct Slot
+		{
+			/*! The node's rate class: the node is updated every 2^rate ticks. */
+			uint32_t rate = 0;
+			/*! The node's bucket, or NoBucket if the node is not scheduled. */
+			uint32_t bucket = NoBucket;
+			/*! The node's position in its bucket. */
+			size_t position = 0;
+			/*! The scheduler's time as of the node's last update, or as of when it was added. */
+			std::chrono::nanoseconds lastUpdate = std::chrono::nanoseconds::zero();
+		};
+
+		/*!
+		@brief Constructor for the class.
+		*/
+		ORBIT_CORE_API UpdateScheduler();
+
+		UpdateScheduler(const UpdateScheduler&) = delete;
+		UpdateScheduler& operator=(const UpdateScheduler&) = delete;
+
+		/*!
+		@brief Schedules a node, in the class matching the period it asks for as seen from the last tick's viewer. Its
+		first update is passed the time elapsed since it was added.
+		@param node The node to schedule, already given its slot in the tree.
+		*/
+		ORBIT_CORE_API void add(Node& node);
+
+		/*!
+		@brief Unschedules a node. Constant time.
+		@param node The node to unschedule.
+		*/
+		ORBIT_CORE_API void remove(Node& node);
+
+		/*!
+		@brief Updates the nodes due on this tick (destroyed ones excepted), then moves those whose period changed to
+		their new class.
+		@param elapsedTime The elapsed time since the last tick.
+		@param viewer The node distances are measured from, usually the tree's camera; or nullptr, in which case every
+		node is considered to be right next to the viewer.
+		@param executor The executor over which to update the nodes, or nullptr to update them on the calling thread.
+		@param grainSize The amount of nodes updated by a single job.
+		*/
+		ORBIT_CORE_API void update(std::chrono::nanoseconds elapsedTime, const Node* viewer, Executor* executor, size_t grainSize);
+
+		/*!
+		@brief Getter for the amount of scheduled nodes.
+		@return The amount of scheduled nodes.
+		*/
+		ORBIT_CORE_API size_t size() const;
+
+		/*!
+		@brief Getter for the nodes due on the last tick, i.e. the only ones the tick updated.
+		@return The nodes due on the last tick, destroyed ones included. Only valid until a node is next added or removed.
+		*/
+		ORBIT_CORE_API const std::vector<Node*>& lastTick() const;
+
+	private:
+		/*!
+		@brief Picks the rate class of a node: the slowest one still updating the node at least as often as it asks.
+		@param node The node.
+		@return The node's rate class.
+		*/
+		uint32_t rateOf(const Node& node) const;
+
+		/*!
+		@brief Puts a node in the next bucket of a rate class, round-robin.
+		@param node The node.
+		@param rate The rate class.
+		*/
+		void place(Node& node, uint32_t rate);
+
+		/*!
+		@brief Takes a node out of its bucket, swapping the last node of the bucket into its place.
+		@param node The node.
+		*/
+		void unplace(Node& node);
+
+		/*!
+		@brief Getter for a node's place in the scheduler.
+		@param node The node.
+		@return The node's place, indexed by its slot in the tree.
+		*/
+		Slot& slotOf(const Node& node);
+
+		/*!
+		@brief A node asking for another rate class after its update.
+		*/
+		struct RateChange
+		{
+			/*! The node. */
+			Node* node;
+			/*! The node's new rate class. */
+			uint32_t rate;
+		};
+
+		/*! The place of every node, indexed by the nodes' slots in the tree. */
+		std::vector<Slot> _slots;
+		/*! The buckets of every rate class, class by class: class r's 2^r buckets start at index 2^r - 1. */
+		std::vector<std::vector<Node*>> _buckets;
+		/*! The bucket of each rate class the next node placed in it goes to. */
+		std::array<uint32_t, RateCount> _nextBuckets{};
+		/*! The amount of nodes in each rate class. */
+		std::array<size_t, RateCount> _rateSizes{};
+		/*! The nodes due on the current tick, gathered from their buckets. */
+		std::vector<Node*> _due;
+		/*! The nodes due on the current tick: either _due, or class 0's bucket when every node is in it. */
+		const std::vector<Node*>* _dueNodes = &_due;
+		/*! The nodes of the current tick asking for another rate class, at the front. */
+		std::vector<RateChange> _rateChanges;
+
+		/*! The amount of ticks so far. */
+		uint64_t _tick = 0;
+		/*! The scheduler's time, i.e. the total time elapsed over its ticks. */
+		std::chrono::nanoseconds _now = std::chrono::nanoseconds::zero();
+		/*! The duration of the last tick, to turn periods into ticks. Zero until the first tick. */
+		std::chrono::nanoseconds _tickDuration = std::chrono::nanoseconds::zero();
+		/*! The viewer's position as of the last tick. */
+		glm::vec3 _viewpoint{ 0.f };
+		/*! Whether or not there was a viewer on the last tick. */
+		bool _hasViewpoint = false;
+		/*! The amount of scheduled nodes. */
+		size_t _size = 0;
+	};
+}
+
+#endif //GAME_UPDATESCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*! @file Render/Bounds.h */
+
+#ifndef RENDER_BOUNDS_H
+#define RENDER_BOUNDS_H
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Orbit
+{
+	/*!
+	@brief Axis-aligned bounding box. Default-constructed boxes are empty (inverted), and absorb whatever they are merged
+	with.
+	*/
+	struct AABB final
+	{
+		/*! The box's minimum corner. */
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		/*! The box's maximum corner. */
+		glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+		/*!
+		@brief Builds an empty box.
+		*/
+		AABB() = default;
+
+		/*!
+		@brief Builds a box from its corners.
+		@param min The box's minimum corner.
+		@param max The box's maximum corner.
+		*/
+		AABB(const glm::vec3& min, const glm::vec3& max)
+			: min(min), max(max)
+		{
+		}
+
+		/*!
+		@brief Returns whether or not the box is empty, i.e. contains no point at all.
+		@return Whether or not the box is empty.
+		*/
+		bool empty() const
+		{
+			return min.x > max.x || min.y > max.y || min.z > max.z;
+		}
+
+		/*!
+		@brief Getter for the box's center.
+		@return The box's center.
+		*/
+		glm::vec3 center() const
+		{
+			return (min + max) * 0.5f;
+		}
+
+		/*!
+		@brief Getter for the box's half extents, i.e. the distance from its center to its maximum corner on each axis.
+		@return The box's half extents.
+		*/
+		glm::vec3 halfExtents() const
+		{
+			return (max - min) * 0.5f;
+		}
+
+		/*!
+		@brief Computes the box's surface area, the cost metric of bounding volume hierarchies.
+		@return The box's surface area.
+		*/
+		float surfaceArea() const
+		{
+			glm::vec3 size = max - min;
+			return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		/*!
+		@brief Grows the box to include a point.
+		@param point The point to include.
+		*/
+		void merge(const glm::vec3& point)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		/*!
+		@brief Grows the box to include another box.
+		@param box The box to include.
+		*/
+		void merge(const AABB& box)
+		{
+			min = glm::min(min, box.min);
+			max = glm::max(max, box.max);
+		}
+
+		/*!
+		@brief Returns the union of two boxes.
+		@param a The first box.
+		@param b The second box.
+		@return The smallest box containing both boxes.
+		*/
+		static AABB merged(const AABB& a, const AABB& b)
+		{
+			return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+		}
+
+		/*!
+		@brief Returns the box grown by a margin on every side.
+		@param margin The margin.
+		@return The grown box.
+		*/
+		AABB fattened(float margin) const
+		{
+			return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+		}
+
+		/*!
+		@brief Returns whether or not the box contains another box entirely.
+		@param box The other box.
+		@return Whether or not the other box is inside this one.
+		*/
+		bool contains(const AABB& box) const
+		{
+			return min.x <= box.min.x && min.y <= box.min.y && min.z <= box.min.z &&
+				max.x >= box.max.x && max.y >= box.max.y && max.z >= box.max.z;
+		}
+
+		/*!
+		@brief Returns whether or not the box overlaps another box. Touching boxes overlap.
+		@param box The other box.
+		@return Whether or not the boxes overlap.
+		*/
+		bool overlaps(const AABB& box) const
+		{
+			return min.x <= box.max.x && max.x >= box.min.x &&
+				min.y <= box.max.y && max.y >= box.min.y &&
+				min.z <= box.max.z && max.z >= box.min.z;
+		}
+
+		/*!
+		@brief Computes the squared distance from a point to the box, 0 if the point is inside.
+		@param point The point.
+		@return The squared distance from the point to the box.
+		*/
+		float distanceSquared(const glm::vec3& point) const
+		{
+			glm::vec3 outside = glm::max(glm::max(min - point, point - max), glm::vec3(0.f));
+			return glm::dot(outside, outside);
+		}
+
+		/*!
+		@brief Computes the box bounding this box once transformed by a matrix. Uses the matrix's absolute values over the
+		box's extents (Arvo's method), rather than transforming the eight corners.
+		@param matrix The transform, assumed to be affine.
+		@return The transformed box.
+		*/
+		AABB transformed(const glm::mat4& matrix) const
+		{
+			if (empty())
+				return *this;
+
+			glm::vec3 center = this->center();
+			glm::vec3 extents = halfExtents();
+
+			glm::vec3 newCenter = glm::vec3(matrix[3]);
+			glm::vec3 newExtents(0.f);
+			for (int column = 0; column < 3; column++)
+			{
+				newCenter += glm::vec3(matrix[column]) * center[column];
+				newExtents += glm::abs(glm::vec3(matrix[column])) * extents[column];
+			}
+
+			return AABB(newCenter - newExtents, newCenter + newExtents);
+		}
+	};
+}
+
+#endif //RENDER_BOUNDS_H
\ No newline at end of file
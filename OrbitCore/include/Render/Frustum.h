@@ -0,0 +1,126 @@
+/*! @file Render/Frustum.h */
+
+#ifndef RENDER_FRUSTUM_H
+#define RENDER_FRUSTUM_H
+#pragma once
+
+#include "Render/Bounds.h"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+namespace Orbit
+{
+	/*!
+	@brief A view frustum, as six planes facing inwards, for culling what lies outside of the view. Tests are
+	conservative: a volume straddling a plane, or just past a corner of the frustum, is considered visible.
+	Planes are stored component by component, padded to eight: each test runs the same few operations over contiguous
+	arrays with no early exit, which compilers turn into a couple of SIMD batches.
+	Default-constructed frustums contain everything.
+	*/
+	class Frustum final
+	{
+	public:
+		/*!
+		@brief Builds a frustum containing everything, i.e. culling nothing.
+		*/
+		Frustum() = default;
+
+		/*!
+		@brief Extracts a frustum's planes from a view-projection matrix (Gribb and Hartmann's method). The near plane is
+		the one of a [-1, 1] clip depth: with a [0, 1] clip depth, the frustum merely reaches a bit past the near plane.
+		@param viewProjection The view-projection matrix, i.e. the projection matrix times the view matrix.
+		*/
+		explicit Frustum(const glm::mat4& viewProjection)
+		{
+			// glm's matrices are column-major: rows are read across columns.
+			auto row = [&viewProjection](int index) {
+				return glm::vec4(viewProjection[0][index], viewProjection[1][index], viewProjection[2][index], viewProjection[3][index]);
+			};
+
+			glm::vec4 x = row(0);
+			glm::vec4 y = row(1);
+			glm::vec4 z = row(2);
+			glm::vec4 w = row(3);
+
+			glm::vec4 planes[PlaneCount] = { w + x, w - x, w + y, w - y, w + z, w - z };
+
+			for (size_t plane = 0; plane < PaddedPlaneCount; plane++)
+			{
+				// Padding repeats the first planes, so that it never culls anything on its own.
+				glm::vec4 equation = planes[plane % PlaneCount];
+				float length = std::sqrt(equation.x * equation.x + equation.y * equation.y + equation.z * equation.z);
+				if (length > 0.f)
+					equation = equation * (1.f / length);
+
+				_a[plane] = equation.x;
+				_b[plane] = equation.y;
+				_c[plane] = equation.z;
+				_d[plane] = equation.w;
+			}
+		}
+
+		/*!
+		@brief Returns whether or not a box is (at least partly) inside the frustum.
+		@param box The box, in the space the frustum was extracted in (world space for a view-projection matrix).
+		@return Whether or not the box may be visible. Empty boxes are not.
+		*/
+		bool intersects(const AABB& box) const
+		{
+			if (box.empty())
+				return false;
+
+			glm::vec3 center = box.center();
+			glm::vec3 extents = box.halfExtents();
+
+			// The box is outside if it is entirely behind any plane: its center is further behind than its projection on
+			// the plane's normal reaches.
+			bool outside = false;
+			for (size_t plane = 0; plane < PaddedPlaneCount; plane++)
+			{
+				float distance = _a[plane] * center.x + _b[plane] * center.y + _c[plane] * center.z + _d[plane];
+				float radius = std::fabs(_a[plane]) * extents.x + std::fabs(_b[plane]) * extents.y + std::fabs(_c[plane]) * extents.z;
+				outside |= distance + radius < 0.f;
+			}
+
+			return !outside;
+		}
+
+		/*!
+		@brief Returns whether or not a sphere is (at least partly) inside the frustum.
+		@param center The sphere's center, in the space the frustum was extracted in.
+		@param radius The sphere's radius.
+		@return Whether or not the sphere may be visible.
+		*/
+		bool intersects(const glm::vec3& center, float radius) const
+		{
+			bool outside = false;
+			for (size_t plane = 0; plane < PaddedPlaneCount; plane++)
+			{
+				float distance = _a[plane] * center.x + _b[plane] * center.y + _c[plane] * center.z + _d[plane];
+				outside |= distance + radius < 0.f;
+			}
+
+			return !outside;
+		}
+
+	private:
+		/*! The amount of planes of a frustum. */
+		static constexpr size_t PlaneCount = 6;
+		/*! The amount of planes stored, rounded up to a whole amount of SIMD registers. */
+		static constexpr size_t PaddedPlaneCount = 8;
+
+		/*! The x components of the planes' normals. */
+		alignas(32) float _a[PaddedPlaneCount] = {};
+		/*! The y components of the planes' normals. */
+		alignas(32) float _b[PaddedPlaneCount] = {};
+		/*! The z components of the planes' normals. */
+		alignas(32) float _c[PaddedPlaneCount] = {};
+		/*! The planes' distances to the origin, along their normals. */
+		alignas(32) float _d[PaddedPlaneCount] = {};
+	};
+}
+
+#endif //RENDER_FRUSTUM_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*! @file Render/MeshSimplifier.h */
+
+#ifndef RENDER_MESHSIMPLIFIER_H
+#define RENDER_MESHSIMPLIFIER_H
+#pragma once
+
+#include "Render/Model.h"
+#include "Util.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Orbit
+{
+	/*!
+	@brief Simplifies a model's mesh by collapsing edges, cheapest first, as measured by the quadric error metric (Garland
+	and Heckbert): each vertex accumulates the planes of the triangles around it, and an edge collapse costs the sum of the
+	squared distances from the kept vertex to the planes of both vertices.
+	Vertices collapse onto one another rather than onto an optimal position, so that they keep valid attributes; open
+	borders (including texture seams, where vertices are split) are weighted so that the silhouette holds. Collapses that
+	would flip a triangle are refused.
+	Simplification is progressive: a simplifier is built once per model, and simplified further and further, taking
+	snapshots along the way (e.g. one per level of detail).
+	*/
+	class MeshSimplifier final
+	{
+	public:
+		/*!
+		@brief Constructor for the class. Computes the quadrics of the model's vertices, along with their adjacency.
+		@param model The model to simplify. Only read while constructing.
+		*/
+		ORBIT_CORE_API explicit MeshSimplifier(const Model& model);
+
+		/*!
+		@brief Collapses edges until the mesh is down to a number of triangles, or no collapse is left.
+		@param targetTriangles The amount of triangles to reach.
+		@return The amount of triangles left.
+		*/
+		ORBIT_CORE_API size_t simplify(size_t targetTriangles);
+
+		/*!
+		@brief Getter for the current amount of triangles of the mesh.
+		@return The amount of triangles left.
+		*/
+		ORBIT_CORE_API size_t triangles() const;
+
+		/*!
+		@brief Builds a model out of the mesh as currently simplified.
+		@param texture The texture of the model.
+		@return The simplified model.
+		*/
+		ORBIT_CORE_API std::shared_ptr<Model> snapshot(std::shared_ptr<const Texture> texture = nullptr) const;
+
+	private:
+		/*!
+		@brief A symmetric 4x4 matrix summing squared distances to planes, stored as its upper triangle.
+		*/
+		struct Quadric
+		{
+			/*!
+			@brief Adds a plane to the quadric.
+			@param normal The plane's normal, normalized.
+			@param distance The plane's distance to the origin, along its normal.
+			@param weight The weight of the plane.
+			*/
+			void addPlane(const glm::vec3& normal, float distance, float weight);
+
+			/*!
+			@brief Adds another quadric to this one.
+			@param rhs The quadric to add.
+			*/
+			void add(const Quadric& rhs);
+
+			/*!
+			@brief Computes the sum of the weighted squared distances from a point to the quadric's planes.
+			@param point The point.
+			@return The quadric error of the point.
+			*/
+			double evaluate(const glm::vec3& point) const;
+
+			/*! The upper triangle of the matrix, row by row. */
+			std::array<double, 10> coefficients{};
+		};
+
+		/*!
+		@brief A candidate collapse, of a vertex onto another.
+		*/
+		struct Collapse
+		{
+			/*! The collapse's error. */
+			double cost;
+			/*! The vertex going away. */
+			uint32_t from;
+			/*! The vertex kept. */
+			uint32_t to;
+			/*! The versions of both vertices when the collapse was evaluated: stale collapses are skipped. */
+			uint32_t fromVersion;
+			uint32_t toVersion;
+
+			/*!
+			@brief Orders collapses for a min-heap.
+			@param rhs The other collapse.
+			@return Whether or not this collapse costs more than the other one.
+			*/
+			bool operator>(const Collapse& rhs) const
+			{
+				return cost > rhs.cost;
+			}
+		};
+
+		/*!
+		@brief Evaluates the cheapest way to collapse an edge, and queues it.
+		@param a One end of the edge.
+		@param b The other end of the edge.
+		*/
+		void queueEdge(uint32_t a, uint32_t b);
+
+		/*!
+		@brief Checks whether moving a vertex onto another would flip or degenerate any of the triangles it keeps.
+		@param from The vertex going away.
+		@param to The vertex kept.
+		@return Whether or not the collapse is allowed.
+		*/
+		bool collapsible(uint32_t from, uint32_t to) const;
+
+		/*!
+		@brief Collapses a vertex onto another, removing the triangles they share.
+		@param from The vertex going away.
+		@param to The vertex kept.
+		*/
+		void collapse(uint32_t from, uint32_t to);
+
+		/*! The mesh's vertices. Removed vertices stay, unreferenced. */
+		std::vector<Vertex> _vertices;
+		/*! The mesh's triangles, three indices each. */
+		std::vector<std::array<uint32_t, 3>> _triangles;
+		/*! Whether or not each triangle was removed. */
+		std::vector<bool> _removedTriangles;
+		/*! The triangles around each vertex, removed ones included. */
+		std::vector<std::vector<uint32_t>> _vertexTriangles;
+		/*! The quadric of each vertex. */
+		std::vector<Quadric> _quadrics;
+		/*! The version of each vertex, bumped whenever its neighbourhood changes. */
+		std::vector<uint32_t> _versions;
+		/*! Whether or not each vertex was collapsed. */
+		std::vector<bool> _removedVertices;
+		/*! The candidate collapses, as a min-heap. */
+		std::vector<Collapse> _collapses;
+		/*! The amount of triangles left. */
+		size_t _triangleCount = 0;
+	};
+}
+
+#endif //RENDER_MESHSIMPLIFIER_H
\ No newline at end of file
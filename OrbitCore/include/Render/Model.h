@@ -4,6 +4,7 @@
 #define RENDER_MODEL_H
 #pragma once
 
+#include "Render/Bounds.h"
 #include "Util.h"
 
 #include <vector>
@@ -84,11 +85,23 @@ namespace Orbit
 	class Texture;
 
 	/*!
-	@brief Class simplifying access to model data.
+	@brief Class simplifying access to model data. Models may carry a chain of simplified versions of themselves (levels
+	of detail), each a model of its own, used in its stead once instances get small enough on screen.
 	*/
 	class Model final
 	{
 	public:
+		/*!
+		@brief A level of detail of a model.
+		*/
+		struct Lod
+		{
+			/*! The simplified model, rendered as an instance bucket of its own. */
+			std::shared_ptr<Model> model;
+			/*! The projected size under which the level is used, as a fraction of the viewport's height. */
+			float screenSize;
+		};
+
 		/*!
 		@brief Default constructor of the class. Builds an empty model.
 		*/
@@ -141,6 +154,42 @@ namespace Orbit
 		*/
 		ORBIT_CORE_API const std::vector<uint32_t>& getIndices() const;
 
+		/*!
+		@brief Getter for the model's bounding box, computed once when the model is built.
+		@return The box bounding the model's vertices, in model space. Empty for empty models.
+		*/
+		ORBIT_CORE_API const AABB& bounds() const;
+
+		/*!
+		@brief Adds a level of detail to the model, e.g. one simplified offline.
+		@throw std::runtime_error Throws if the level is null, or if its screen size is not below the previous level's.
+		@param lod The simplified model.
+		@param screenSize The projected size under which the level is used, as a fraction of the viewport's height.
+		*/
+		ORBIT_CORE_API void addLod(std::shared_ptr<Model> lod, float screenSize);
+
+		/*!
+		@brief Generates levels of detail for the model, by simplifying it with Orbit::MeshSimplifier. Meant to run at load
+		time, e.g. in a factory's loading task. Stops early if the mesh cannot be simplified any further.
+		@param count The amount of levels to generate.
+		@param reduction The ratio of triangles kept by each level, relative to the previous one.
+		@param screenSize The projected size under which the first level is used. Each further level halves it.
+		*/
+		ORBIT_CORE_API void generateLods(size_t count, float reduction = 0.5f, float screenSize = 0.25f);
+
+		/*!
+		@brief Getter for the model's levels of detail.
+		@return The model's levels of detail, most detailed first.
+		*/
+		ORBIT_CORE_API const std::vector<Lod>& lods() const;
+
+		/*!
+		@brief Selects the level of detail to render an instance of the model at.
+		@param screenSize The instance's projected size, as a fraction of the viewport's height.
+		@return The least detailed level whose screen size is above the instance's, or nullptr for the model itself.
+		*/
+		ORBIT_CORE_API const Lod* selectLod(float screenSize) const;
+
 		/*!
 		@brief Calculates a hash code for the model. As the hash code is (in most cases) complex to calculate, the result
 		of the hash code is saved as a member of the class and returned immediately once computed at least once.
@@ -169,6 +218,10 @@ namespace Orbit
 		std::vector<Vertex> _vertices;
 		/*! A coherent collection of indices. */
 		std::vector<uint32_t> _indices;
+		/*! The box bounding the model's vertices. */
+		AABB _bounds;
+		/*! The model's levels of detail, most detailed first. */
+		std::vector<Lod> _lods;
 	};
 }
 
@@ -0,0 +1,56 @@
+/*! @file Task/Executor.h */
+
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+#pragma once
+
+#include "Task/InplaceFunction.h"
+#include "Util.h"
+
+namespace Orbit
+{
+	/*!
+	@brief Base class for anything able to execute jobs on its own threads. Lets core code (scenes, factories, coroutine
+	tasks) hand work off without knowing about the engine's task runner.
+	*/
+	class Executor
+	{
+	public:
+		/*! A unit of work. Stored inline, so submitting a job never allocates. */
+		using Job = InplaceFunction<void(), 64>;
+
+		/*!
+		@brief Default constructor for the class.
+		*/
+		Executor() = default;
+
+		/*!
+		@brief Destructor for the class.
+		*/
+		virtual ~Executor() = 0;
+
+		/*!
+		@brief Submits a job to be executed, at some point, on one of the executor's threads.
+		@param job The job to execute.
+		*/
+		virtual void submit(Job job) = 0;
+
+		/*!
+		@brief Executes func for every index in [begin, end), only returning once every index is processed. By default, the
+		calling thread simply goes through the range on its own; executors with a worker pool spread it over their threads.
+		@param begin The first index of the range.
+		@param end The index past the last index of the range.
+		@param func The function to execute for every index.
+		@param grainSize The amount of indices processed by a single job.
+		*/
+		virtual void parallelFor(size_t begin, size_t end, const InplaceFunction<void(size_t)>& func, size_t /*grainSize*/ = 1)
+		{
+			for (size_t i = begin; i < end; i++)
+				func(i);
+		}
+	};
+
+	inline Executor::~Executor() = default;
+}
+
+#endif //TASK_EXECUTOR_H
\ No newline at end of file
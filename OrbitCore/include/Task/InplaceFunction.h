@@ -0,0 +1,231 @@
+/*! @file Task/InplaceFunction.h */
+
+#ifndef TASK_INPLACEFUNCTION_H
+#define TASK_INPLACEFUNCTION_H
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Orbit
+{
+	template<typename Signature, size_t Capacity = 48>
+	class InplaceFunction;
+
+	namespace detail
+	{
+		/*! Helper to detect well-formed expressions, as a struct to work around alias template issues on older toolsets. */
+		template<typename...>
+		struct MakeVoid { using type = void; };
+
+		/*!
+		@brief Checks whether F can be called with Args and its result converted to R (or discarded, if R is void).
+		*/
+		template<typename F, typename Signature, typename = void>
+		struct IsCallable : std::false_type { };
+
+		template<typename F, typename R, typename... Args>
+		struct IsCallable<F, R(Args...), typename MakeVoid<decltype(std::declval<F&>()(std::declval<Args>()...))>::type>
+			: std::integral_constant<bool,
+				std::is_void<R>::value || std::is_convertible<decltype(std::declval<F&>()(std::declval<Args>()...)), R>::value>
+		{ };
+	}
+
+	/*!
+	@brief Move-only replacement for std::function that stores its callable in an inline buffer of Capacity bytes and never
+	allocates. Callables that do not fit are rejected at compile time, rather than silently going to the heap.
+	Like std::function, calling through a const InplaceFunction still calls the callable's non-const operator().
+	@tparam R The return type of the function.
+	@tparam Args The types of the function's arguments.
+	@tparam Capacity The size of the inline buffer, in bytes.
+	*/
+	template<typename R, typename... Args, size_t Capacity>
+	class InplaceFunction<R(Args...), Capacity> final
+	{
+	public:
+		/*!
+		@brief Builds an empty function.
+		*/
+		InplaceFunction() = default;
+
+		/*!
+		@brief Builds an empty function.
+		*/
+		InplaceFunction(std::nullptr_t) { }
+
+		/*!
+		@brief Stores a callable in the function's buffer.
+		@tparam F The type of the callable. Must fit in the buffer and be nothrow move constructible.
+		@param func The callable.
+		*/
+		template<typename F, typename = std::enable_if_t<
+			!std::is_same<std::decay_t<F>, InplaceFunction>::value && detail::IsCallable<std::decay_t<F>, R(Args...)>::value>>
+		InplaceFunction(F&& func)
+		{
+			using Callable = std::decay_t<F>;
+
+			static_assert(sizeof(Callable) <= Capacity,
+				"Callable too big for this InplaceFunction: capture less (i.e. by reference) or raise the capacity!");
+			static_assert(alignof(Callable) <= alignof(Storage),
+				"Callable over-aligned for this InplaceFunction!");
+			static_assert(std::is_nothrow_move_constructible<Callable>::value,
+				"Callables stored in an InplaceFunction must be nothrow move constructible!");
+
+			new (&_storage) Callable(std::forward<F>(func));
+			_operations = &OperationsFor<Callable>::value;
+		}
+
+		/*!
+		@brief Destructor for the class. Destroys the stored callable.
+		*/
+		~InplaceFunction()
+		{
+			reset();
+		}
+
+		/*!
+		@brief Move constructor for the class. Moves the callable from one buffer to the other.
+		@param rhs The function to move.
+		*/
+		InplaceFunction(InplaceFunction&& rhs) noexcept
+		{
+			moveFrom(rhs);
+		}
+
+		/*!
+		@brief Move assignment operator for the class. Destroys the current callable, then moves the other one in.
+		@param rhs The function to move.
+		@return A reference to this.
+		*/
+		InplaceFunction& operator=(InplaceFunction&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				reset();
+				moveFrom(rhs);
+			}
+
+			return *this;
+		}
+
+		/*!
+		@brief Empties the function.
+		@return A reference to this.
+		*/
+		InplaceFunction& operator=(std::nullptr_t) noexcept
+		{
+			reset();
+			return *this;
+		}
+
+		InplaceFunction(const InplaceFunction&) = delete;
+		InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+		/*!
+		@brief Returns whether or not the function holds a callable.
+		@return Whether or not the function holds a callable.
+		*/
+		explicit operator bool() const noexcept
+		{
+			return _operations != nullptr;
+		}
+
+		/*!
+		@brief Calls the stored callable. The function must not be empty.
+		@param args The arguments to forward to the callable.
+		@return The callable's result.
+		*/
+		R operator()(Args... args) const
+		{
+			return _operations->invoke(const_cast<Storage*>(&_storage), std::forward<Args>(args)...);
+		}
+
+	private:
+		/*! The inline buffer's type. */
+		using Storage = std::aligned_storage_t<Capacity, alignof(void*)>;
+
+		/*!
+		@brief Table of type-erased operations on the stored callable, shared by every function storing the same type.
+		*/
+		struct Operations
+		{
+			/*! Calls the callable. */
+			R(*invoke)(void*, Args&&...);
+			/*! Move-constructs the callable from a buffer (second) into another (first), then destroys the source. */
+			void(*relocate)(void*, void*);
+			/*! Destroys the callable. */
+			void(*destroy)(void*);
+		};
+
+		/*!
+		@brief Operations table for a given type of callable.
+		@tparam Callable The type of the callable.
+		*/
+		template<typename Callable>
+		struct OperationsFor
+		{
+			static R invoke(void* storage, Args&&... args)
+			{
+				return static_cast<R>((*static_cast<Callable*>(storage))(std::forward<Args>(args)...));
+			}
+
+			static void relocate(void* destination, void* source)
+			{
+				Callable* callable = static_cast<Callable*>(source);
+				new (destination) Callable(std::move(*callable));
+				callable->~Callable();
+			}
+
+			static void destroy(void* storage)
+			{
+				static_cast<Callable*>(storage)->~Callable();
+			}
+
+			static const Operations value;
+		};
+
+		/*!
+		@brief Takes the callable of another function, leaving it empty.
+		@param rhs The function to take the callable from.
+		*/
+		void moveFrom(InplaceFunction& rhs) noexcept
+		{
+			if (!rhs._operations)
+				return;
+
+			rhs._operations->relocate(&_storage, &rhs._storage);
+			_operations = rhs._operations;
+			rhs._operations = nullptr;
+		}
+
+		/*!
+		@brief Destroys the stored callable, if any.
+		*/
+		void reset() noexcept
+		{
+			if (!_operations)
+				return;
+
+			_operations->destroy(&_storage);
+			_operations = nullptr;
+		}
+
+		/*! The inline buffer holding the callable. */
+		Storage _storage;
+		/*! The operations on the stored callable. nullptr when empty. */
+		const Operations* _operations = nullptr;
+	};
+
+	template<typename R, typename... Args, size_t Capacity>
+	template<typename Callable>
+	const typename InplaceFunction<R(Args...), Capacity>::Operations
+		InplaceFunction<R(Args...), Capacity>::OperationsFor<Callable>::value = {
+			&OperationsFor<Callable>::invoke,
+			&OperationsFor<Callable>::relocate,
+			&OperationsFor<Callable>::destroy
+		};
+}
+
+#endif //TASK_INPLACEFUNCTION_H
\ No newline at end of file
@@ -0,0 +1,500 @@
+/*! @file Task/Task.h */
+
+#ifndef TASK_TASK_H
+#define TASK_TASK_H
+#pragma once
+
+#include "Task/Executor.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#else
+#include <experimental/coroutine>
+#endif
+
+namespace Orbit
+{
+	/*! Coroutine support namespace, which is still experimental on older toolsets (enabled with /await). */
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+	namespace coro = std;
+#else
+	namespace coro = std::experimental;
+#endif
+
+	template<typename T>
+	class Task;
+
+	namespace detail
+	{
+		/*!
+		@brief Part of the promise type common to every Task, handling continuation, completion and exceptions.
+		*/
+		class TaskPromiseBase
+		{
+		public:
+			/*!
+			@brief Awaiter used on final suspension. Flags the task as done, then resumes whoever was awaiting it.
+			*/
+			struct FinalAwaiter
+			{
+				/*!
+				@brief Always suspends, so that the frame outlives the coroutine's body until the Task is destroyed.
+				@return False.
+				*/
+				bool await_ready() const noexcept { return false; }
+
+				/*!
+				@brief Resumes the awaiting coroutine, if any.
+				@tparam Promise The type of the finishing coroutine's promise.
+				@param handle The finishing coroutine.
+				*/
+				template<typename Promise>
+				void await_suspend(coro::coroutine_handle<Promise> handle) noexcept
+				{
+					TaskPromiseBase& promise = handle.promise();
+					coro::coroutine_handle<> continuation = promise._continuation;
+
+					// Nothing may touch the frame after this store, as an owner polling ready() may destroy it right away.
+					promise._done.store(true, std::memory_order_release);
+
+					if (continuation)
+						continuation.resume();
+				}
+
+				/*!
+				@brief Does nothing, as a finished coroutine is never resumed.
+				*/
+				void await_resume() const noexcept { }
+			};
+
+			/*!
+			@brief Tasks are lazy: their body only starts when awaited or explicitly started.
+			@return An awaiter always suspending.
+			*/
+			coro::suspend_always initial_suspend() const noexcept { return {}; }
+
+			/*!
+			@brief Flags completion and resumes the awaiting coroutine.
+			@return The final awaiter.
+			*/
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			/*!
+			@brief Stores the exception escaping the coroutine's body, to be rethrown to whoever gets the result.
+			*/
+			void unhandled_exception() noexcept
+			{
+				_exception = std::current_exception();
+			}
+
+			/*!
+			@brief Sets the coroutine to resume once this one is done.
+			@param continuation The coroutine to resume.
+			*/
+			void setContinuation(coro::coroutine_handle<> continuation) noexcept
+			{
+				_continuation = continuation;
+			}
+
+			/*!
+			@brief Returns whether or not the coroutine's body has finished. Safe to call from any thread.
+			@return Whether or not the coroutine is done.
+			*/
+			bool done() const noexcept
+			{
+				return _done.load(std::memory_order_acquire);
+			}
+
+			/*!
+			@brief Rethrows the exception that escaped the coroutine's body, if any.
+			*/
+			void rethrowIfFailed() const
+			{
+				if (_exception)
+					std::rethrow_exception(_exception);
+			}
+
+		private:
+			/*! The coroutine to resume once this one is done. */
+			coro::coroutine_handle<> _continuation = nullptr;
+			/*! Whether or not the coroutine's body has finished. */
+			std::atomic<bool> _done{ false };
+			/*! The exception that escaped the coroutine's body, if any. */
+			std::exception_ptr _exception;
+		};
+
+		/*!
+		@brief Promise type of a Task returning a value.
+		@tparam T The type of the returned value.
+		*/
+		template<typename T>
+		class TaskPromise final : public TaskPromiseBase
+		{
+		public:
+			/*!
+			@brief Builds the Task owning the coroutine.
+			@return The Task.
+			*/
+			Task<T> get_return_object() noexcept;
+
+			/*!
+			@brief Stores the coroutine's result.
+			@tparam U The type of the returned value, convertible to T.
+			@param value The returned value.
+			*/
+			template<typename U>
+			void return_value(U&& value)
+			{
+				_value = std::make_unique<T>(std::forward<U>(value));
+			}
+
+			/*!
+			@brief Retrieves the coroutine's result, rethrowing its exception if it failed.
+			@return The coroutine's result.
+			*/
+			T result()
+			{
+				rethrowIfFailed();
+				return std::move(*_value);
+			}
+
+		private:
+			/*! The coroutine's result. Kept on the heap, as T need not be default-constructible. */
+			std::unique_ptr<T> _value;
+		};
+
+		/*!
+		@brief Promise type of a Task returning nothing.
+		*/
+		template<>
+		class TaskPromise<void> final : public TaskPromiseBase
+		{
+		public:
+			/*!
+			@brief Builds the Task owning the coroutine.
+			@return The Task.
+			*/
+			Task<void> get_return_object() noexcept;
+
+			/*!
+			@brief Does nothing, as there is no result to store.
+			*/
+			void return_void() noexcept { }
+
+			/*!
+			@brief Rethrows the coroutine's exception if it failed.
+			*/
+			void result()
+			{
+				rethrowIfFailed();
+			}
+		};
+	}
+
+	/*!
+	@brief Lazily-started coroutine returning a value of type T. A Task is either awaited from another coroutine (which is
+	then resumed on whichever thread the task finishes), or started with start() and polled with ready() from a loop.
+	The coroutine is destroyed along with the Task.
+	@tparam T The type of the value returned by the coroutine.
+	*/
+	template<typename T = void>
+	class Task final
+	{
+	public:
+		/*! The promise type of the coroutine, as required by the language. */
+		using promise_type = detail::TaskPromise<T>;
+
+		/*!
+		@brief Builds an empty task, which is considered ready.
+		*/
+		Task() = default;
+
+		/*!
+		@brief Constructor for the class. Takes ownership of the coroutine.
+		@param handle The coroutine.
+		*/
+		explicit Task(coro::coroutine_handle<promise_type> handle) : _handle(handle) { }
+
+		/*!
+		@brief Destructor for the class. Destroys the coroutine, which must not be running anymore.
+		*/
+		~Task()
+		{
+			if (_handle)
+				_handle.destroy();
+		}
+
+		/*!
+		@brief Move constructor for the class. Moves the coroutine's ownership.
+		@param rhs The task to move.
+		*/
+		Task(Task&& rhs) noexcept : _handle(std::exchange(rhs._handle, nullptr)) { }
+
+		/*!
+		@brief Move assignment operator for the class. Moves the coroutine's ownership.
+		@param rhs The task to move.
+		@return A reference to this.
+		*/
+		Task& operator=(Task&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				if (_handle)
+					_handle.destroy();
+
+				_handle = std::exchange(rhs._handle, nullptr);
+			}
+
+			return *this;
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		/*!
+		@brief Starts the coroutine on the current thread, without anyone to resume once it's done. It runs until its first
+		suspension point (usually a hand-off to an executor). Does nothing if already started.
+		*/
+		void start()
+		{
+			if (_handle && !_started)
+			{
+				_started = true;
+				_handle.resume();
+			}
+		}
+
+		/*!
+		@brief Returns whether or not the coroutine has finished. Safe to call while the coroutine runs on another thread.
+		@return Whether or not the coroutine has finished.
+		*/
+		bool ready() const
+		{
+			return !_handle || _handle.promise().done();
+		}
+
+		/*!
+		@brief Retrieves the coroutine's result. Must only be called once ready() returns true.
+		@throw Rethrows the exception that escaped the coroutine, if any.
+		@return The coroutine's result.
+		*/
+		T get()
+		{
+			return _handle.promise().result();
+		}
+
+		/*!
+		@brief Awaiter used when a coroutine awaits the task. Starts the task, to resume the awaiting coroutine once done.
+		*/
+		struct Awaiter
+		{
+			/*! The awaited coroutine. */
+			coro::coroutine_handle<promise_type> handle;
+
+			/*!
+			@brief Skips suspension when the task is already done.
+			@return Whether or not the task is done.
+			*/
+			bool await_ready() const noexcept
+			{
+				return !handle || handle.promise().done();
+			}
+
+			/*!
+			@brief Starts the task, to resume the awaiting coroutine once done.
+			@param awaiting The awaiting coroutine.
+			*/
+			void await_suspend(coro::coroutine_handle<> awaiting)
+			{
+				handle.promise().setContinuation(awaiting);
+				handle.resume();
+			}
+
+			/*!
+			@brief Retrieves the task's result.
+			@throw Rethrows the exception that escaped the task, if any.
+			@return The task's result.
+			*/
+			T await_resume()
+			{
+				return handle.promise().result();
+			}
+		};
+
+		/*!
+		@brief Makes the task awaitable. The task must not have been started with start().
+		@return The task's awaiter.
+		*/
+		Awaiter operator co_await() &&
+		{
+			return Awaiter{ _handle };
+		}
+
+		/*! @copydoc Orbit::Task::operator co_await()&& */
+		Awaiter operator co_await() &
+		{
+			return Awaiter{ _handle };
+		}
+
+	private:
+		/*! The owned coroutine. */
+		coro::coroutine_handle<promise_type> _handle = nullptr;
+		/*! Whether or not the coroutine was started with start(). */
+		bool _started = false;
+	};
+
+	namespace detail
+	{
+		template<typename T>
+		Task<T> TaskPromise<T>::get_return_object() noexcept
+		{
+			return Task<T>{ coro::coroutine_handle<TaskPromise<T>>::from_promise(*this) };
+		}
+
+		inline Task<void> TaskPromise<void>::get_return_object() noexcept
+		{
+			return Task<void>{ coro::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+		}
+	}
+
+	/*!
+	@brief Awaiter moving the awaiting coroutine onto one of an executor's threads.
+	*/
+	struct ResumeOnAwaiter
+	{
+		/*! The executor on which to resume. */
+		Executor& executor;
+
+		/*!
+		@brief Always suspends, as the point is to change threads.
+		@return False.
+		*/
+		bool await_ready() const noexcept { return false; }
+
+		/*!
+		@brief Submits the coroutine's resumption to the executor.
+		@param handle The awaiting coroutine.
+		*/
+		void await_suspend(coro::coroutine_handle<> handle)
+		{
+			executor.submit([handle] { handle.resume(); });
+		}
+
+		/*!
+		@brief Does nothing, as there is nothing to return.
+		*/
+		void await_resume() const noexcept { }
+	};
+
+	/*!
+	@brief Hands the awaiting coroutine off to an executor: the code after the co_await runs on one of its threads.
+	@param executor The executor on which to resume.
+	@return The awaiter.
+	*/
+	inline ResumeOnAwaiter resumeOn(Executor& executor)
+	{
+		return ResumeOnAwaiter{ executor };
+	}
+
+	/*! A condition polled by a PollAwaiter. Kept small, so that the polling job fits in an executor job. */
+	using PollCondition = InplaceFunction<bool(), 32>;
+
+	/*!
+	@brief Awaiter resuming the awaiting coroutine once a condition holds, polling it from an executor's threads. Meant for
+	completions that can only be polled, like GPU fences. Failed polls back off exponentially, so that a long wait costs a
+	handful of checks instead of keeping a thread spinning.
+	*/
+	struct PollAwaiter
+	{
+		/*! The delay before the first re-poll. */
+		static constexpr std::chrono::microseconds MinBackoff{ 50 };
+		/*! The longest delay between two polls, bounding how late the coroutine resumes after the condition holds. */
+		static constexpr std::chrono::microseconds MaxBackoff{ 2000 };
+
+		/*! The executor polling the condition. */
+		Executor& executor;
+		/*! The condition to wait for. */
+		PollCondition condition;
+
+		/*!
+		@brief Skips suspension if the condition already holds.
+		@return Whether or not the condition holds.
+		*/
+		bool await_ready() const
+		{
+			return condition();
+		}
+
+		/*!
+		@brief Starts polling the condition on the executor.
+		@param handle The awaiting coroutine.
+		*/
+		void await_suspend(coro::coroutine_handle<> handle)
+		{
+			poll(executor, std::move(condition), handle, MinBackoff);
+		}
+
+		/*!
+		@brief Does nothing, as there is nothing to return.
+		*/
+		void await_resume() const noexcept { }
+
+	private:
+		/*!
+		@brief Checks the condition, resuming the coroutine if it holds. Otherwise, waits for the backoff delay and resubmits
+		itself with twice the delay, so that other jobs get through in the meantime.
+		@param executor The executor polling the condition.
+		@param condition The condition to wait for.
+		@param handle The coroutine to resume.
+		@param backoff The delay to wait for if the condition does not hold yet.
+		*/
+		static void poll(Executor& executor, PollCondition condition, coro::coroutine_handle<> handle, std::chrono::microseconds backoff)
+		{
+			executor.submit([&executor, condition = std::move(condition), handle, backoff]() mutable {
+				if (condition())
+				{
+					handle.resume();
+					return;
+				}
+
+				std::this_thread::sleep_for(backoff);
+				poll(executor, std::move(condition), handle, std::min(backoff * 2, MaxBackoff));
+			});
+		}
+	};
+
+	/*!
+	@brief Suspends the awaiting coroutine until the condition holds. The coroutine resumes on one of the executor's threads.
+	@param executor The executor polling the condition.
+	@param condition The condition to wait for.
+	@return The awaiter.
+	*/
+	inline PollAwaiter pollUntil(Executor& executor, PollCondition condition)
+	{
+		return PollAwaiter{ executor, std::move(condition) };
+	}
+
+	/*!
+	@brief Reads a file's contents on one of an executor's threads, leaving the calling thread free in the meantime.
+	@see Orbit::loadFile()
+	@param executor The executor on which to do the I/O.
+	@param fileName The URI of the file to open.
+	@return A task returning the byte contents of the file.
+	*/
+	inline Task<std::vector<char>> loadFileAsync(Executor& executor, std::string fileName)
+	{
+		co_await resumeOn(executor);
+		co_return loadFile(fileName);
+	}
+}
+
+#endif //TASK_TASK_H
\ No newline at end of file
@@ -12,6 +12,10 @@
 #include <utility>
 #include <vector>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
 /*! Definition of import/export semantics for the core. Unnecessary if not under Windows. */
 #if defined(_WIN32)
 #if defined(CORE)
@@ -309,6 +313,22 @@ namespace Orbit
 		return { {std::forward<U>(u)...} };
 	}
 
+	/*!
+	@brief Hints the processor to start loading the cache line at the address in parameter, for data about to be read.
+	Does nothing on platforms without a prefetch instruction.
+	@param address The address to prefetch. Need not be valid: prefetching never faults.
+	*/
+	inline void prefetch(const void* address)
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+
 	/*!
 	@brief Utility function returning the contents of a file as a std::vector<char> representing the file's data (in bytes).
 	@param fileName The URI of the file to open.
@@ -38,6 +38,11 @@ std::shared_ptr<Node> CameraNode::clone() const
 	throw std::runtime_error("Cloning a camera node is not allowed!");
 }
 
+std::shared_ptr<Node> CameraNode::instantiate(InstanceAllocator& /*allocator*/) const
+{
+	throw std::runtime_error("Instantiating a camera node is not allowed!");
+}
+
 void CameraNode::update(std::chrono::nanoseconds elapsedtime)
 {
 }
@@ -2,28 +2,59 @@
 
 #include "Game/CompositeTree/CompositeNode.h"
 
+#include "Game/CompositeTree/CompositeTree.h"
+
+#include <algorithm>
+#include <string_view>
+
 using namespace Orbit;
 
 CompositeNode::CompositeNode(const std::string& name)
 	: Node(name)
 {
+	_composite = true;
 }
 
 CompositeNode::CompositeNode(const Input& input, const std::string& name)
 	: Node(input, name)
 {
+	_composite = true;
 }
 
 CompositeNode::CompositeNode(CompositeNode&& rhs)
-	: Node(std::move(rhs)), _parent(std::move(rhs._parent)), _children(std::move(rhs._children))
+	: Node(std::move(rhs)), _children(std::move(rhs._children)), _scheduled(rhs._scheduled)
 {
+	_composite = true;
+
+	// Like this node, the moved children start out detached.
+	for (std::shared_ptr<Node>& child : _children)
+	{
+		child->detach();
+		child->_parent = this;
+	}
+}
+
+CompositeNode::~CompositeNode()
+{
+	// Children may be kept alive elsewhere: they must not point back to this node.
+	for (std::shared_ptr<Node>& child : _children)
+		child->_parent = nullptr;
 }
 
 CompositeNode& CompositeNode::operator=(CompositeNode&& rhs)
 {
+	clearChildren();
+
 	Node::operator=(std::move(rhs));
-	_parent = std::move(rhs._parent);
 	_children = std::move(rhs._children);
+	_scheduled = rhs._scheduled;
+
+	for (std::shared_ptr<Node>& child : _children)
+	{
+		child->detach();
+		child->_parent = this;
+	}
+
 	return *this;
 }
 
@@ -33,55 +64,209 @@ void CompositeNode::acceptVisitor(Visitor* visitor)
 		child->acceptVisitor(visitor);
 }
 
-void CompositeNode::destroy()
+void CompositeNode::teardown()
 {
-	if (destroyed())
-		return;
+	Node::teardown();
+	clearChildren();
+}
 
-	std::shared_ptr<CompositeNode> parent = getParent();
-	if (parent)
-	{
-		parent->removeChild(shared_from_this());
-		parent = nullptr;
-	}
+void CompositeNode::attach(CompositeTree& tree)
+{
+	Node::attach(tree);
 
-	clearChildren();
-	setDestroyed(true);
+	for (std::shared_ptr<Node>& child : _children)
+		child->attach(tree);
+}
+
+void CompositeNode::detach()
+{
+	for (std::shared_ptr<Node>& child : _children)
+		child->detach();
+
+	Node::detach();
 }
 
 void CompositeNode::update(std::chrono::nanoseconds elapsedTime)
 {
+	// Within a tree, the scheduler updates the children itself.
+	if (tree())
+		return;
+
 	for (std::shared_ptr<Node>& child : _children)
 		if (!child->destroyed())
 			child->update(elapsedTime);
 }
 
+void CompositeNode::setScheduled(bool scheduled)
+{
+	CompositeTree* nodeTree = tree();
+	if (nodeTree && nodeTree->_updatingNodes)
+		throw std::runtime_error("Changing a node's scheduling during its tree's update is not allowed!");
+
+	if (scheduled == _scheduled)
+		return;
+
+	_scheduled = scheduled;
+	if (!nodeTree || destroyed())
+		return;
+
+	if (scheduled)
+		nodeTree->_updateScheduler.add(*this);
+	else
+		nodeTree->_updateScheduler.remove(*this);
+}
+
 void CompositeNode::addChild(std::shared_ptr<Node> child)
 {
 	if (!child)
 		throw std::runtime_error("Attempted to add a null child!");
 
-	if (find(child->getName()))
-		throw std::runtime_error("Child is already in children (or subchildren)!");
+	if (child->_parent)
+		throw std::runtime_error("Child already has a parent!");
+
+	checkNames(&child, 1);
+	insertChild(child);
+
+	if (CompositeTree* childTree = tree())
+		child->attach(*childTree);
+}
+
+void CompositeNode::addChildren(const std::vector<std::shared_ptr<Node>>& children)
+{
+	for (const std::shared_ptr<Node>& child : children)
+	{
+		if (!child)
+			throw std::runtime_error("Attempted to add a null child!");
+
+		if (child->_parent)
+			throw std::runtime_error("Child already has a parent!");
+	}
+
+	checkNames(children.data(), children.size());
 
-	_children.push_back(child);
+	_children.reserve(_children.size() + children.size());
+	for (const std::shared_ptr<Node>& child : children)
+		insertChild(child);
+
+	if (CompositeTree* childTree = tree())
+		for (const std::shared_ptr<Node>& child : children)
+			child->attach(*childTree);
 }
 
 void CompositeNode::removeChild(std::shared_ptr<Node> child)
 {
-	auto foundChild = std::find(_children.begin(), _children.end(), child);
-	if (foundChild == _children.end())
+	if (!child || child->_parent != this)
 		return;
 
-	std::swap(*foundChild, _children.back());
-	_children.pop_back();
+	extractChild(*child);
+	child->detach();
 }
 
 void CompositeNode::clearChildren()
 {
+	for (std::shared_ptr<Node>& child : _children)
+	{
+		child->detach();
+		child->_parent = nullptr;
+	}
+
 	_children.clear();
 }
 
+void CompositeNode::checkNames(const std::shared_ptr<Node>* subtrees, size_t count) const
+{
+	// Every name of the incoming subtrees, sorted so that duplicates end up side by side. Nodes below the roots of prefab
+	// instances are left out, as their names are only unique within their instance.
+	std::vector<std::string_view> names;
+	std::vector<const Node*> stack;
+	for (size_t subtree = 0; subtree < count; subtree++)
+	{
+		stack.push_back(subtrees[subtree].get());
+		while (!stack.empty())
+		{
+			const Node* node = stack.back();
+			stack.pop_back();
+
+			if (!node->_archetype->scopedName)
+				names.push_back(node->_archetype->name);
+
+			if (node->isComposite())
+				for (const std::shared_ptr<Node>& child : static_cast<const CompositeNode*>(node)->_children)
+					stack.push_back(child.get());
+		}
+	}
+
+	std::sort(names.begin(), names.end());
+	if (std::adjacent_find(names.begin(), names.end()) != names.end())
+		throw std::runtime_error("Child is already in children (or subchildren)!");
+
+	// Within a tree, names are looked up through the tree's index. Outside of one, the hierarchy is walked once for the
+	// whole batch, rather than once per name.
+	if (CompositeTree* childTree = tree())
+	{
+		for (std::string_view name : names)
+			if (childTree->find(std::string(name)) != nullptr)
+				throw std::runtime_error("Child is already in children (or subchildren)!");
+
+		return;
+	}
+
+	stack.push_back(this);
+	while (!stack.empty())
+	{
+		const Node* node = stack.back();
+		stack.pop_back();
+
+		if (!node->_archetype->scopedName && std::binary_search(names.begin(), names.end(), std::string_view(node->_archetype->name)))
+			throw std::runtime_error("Child is already in children (or subchildren)!");
+
+		if (node->isComposite())
+			for (const std::shared_ptr<Node>& child : static_cast<const CompositeNode*>(node)->_children)
+				stack.push_back(child.get());
+	}
+}
+
+void CompositeNode::insertChild(std::shared_ptr<Node> child)
+{
+	CompositeTree* childTree = tree();
+	if (childTree)
+		childTree->invalidatePreorder();
+
+	child->_parent = this;
+	child->_childPosition = _children.size();
+
+	// Moved within the tree: its subtree's model matrices follow at the end of the tick. Nodes being added are brought up
+	// to date as they are attached instead.
+	if (childTree && child->tree() == childTree)
+	{
+		childTree->slotOf(*child).transformDirty = true;
+		childTree->_movedNodes.push_back(child.get());
+	}
+
+	_children.push_back(std::move(child));
+}
+
+std::shared_ptr<Node> CompositeNode::extractChild(Node& child)
+{
+	if (CompositeTree* childTree = tree())
+		childTree->invalidatePreorder();
+
+	// Swap and pop: the last child takes the removed child's place.
+	size_t position = child._childPosition;
+	std::shared_ptr<Node> extracted = std::move(_children[position]);
+
+	if (position + 1 != _children.size())
+	{
+		_children[position] = std::move(_children.back());
+		_children[position]->_childPosition = position;
+	}
+
+	_children.pop_back();
+	extracted->_parent = nullptr;
+
+	return extracted;
+}
+
 std::shared_ptr<Node> CompositeNode::find(std::string name)
 {
 	if (getName() == name)
@@ -124,15 +309,32 @@ std::vector<std::shared_ptr<Node>> CompositeNode::cloneChildren() const
 
 std::shared_ptr<CompositeNode> CompositeNode::getParent()
 {
-	return _parent.lock();
+	CompositeNode* composite = parent();
+	if (!composite)
+		return nullptr;
+
+	return std::static_pointer_cast<CompositeNode>(composite->weak_from_this().lock());
 }
 
 std::shared_ptr<const CompositeNode> CompositeNode::getParent() const
 {
-	return std::const_pointer_cast<const CompositeNode>(_parent.lock());
+	CompositeNode* composite = parent();
+	if (!composite)
+		return nullptr;
+
+	return std::static_pointer_cast<const CompositeNode>(composite->weak_from_this().lock());
 }
 
 void CompositeNode::moveChildren(std::vector<std::shared_ptr<Node>>&& children)
 {
-	_children = std::move(children);
+	clearChildren();
+
+	CompositeTree* childTree = tree();
+	for (std::shared_ptr<Node>& child : children)
+	{
+		insertChild(child);
+
+		if (childTree)
+			child->attach(*childTree);
+	}
 }
\ No newline at end of file
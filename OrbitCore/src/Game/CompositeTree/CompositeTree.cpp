@@ -2,21 +2,40 @@
 
 #include "Game/CompositeTree/CompositeTree.h"
 
+#include "Game/Factories/InstanceAllocator.h"
+#include "Render/Model.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+
 using namespace Orbit;
 
 CompositeTree::CompositeTree()
 	: CompositeNode( "ROOT_TREE_NODE")
 {
+	attach(*this);
+}
+
+CompositeTree::~CompositeTree()
+{
+	clearChildren();
 }
 
 CompositeTree::CompositeTree(CompositeTree&& rhs)
 	: CompositeNode(std::move(rhs))
 {
+	// The moved nodes are brought up to date as they are attached to this tree.
+	rhs._movedNodes.clear();
+	attach(*this);
 }
 
 CompositeTree& CompositeTree::operator=(CompositeTree&& rhs)
 {
 	CompositeNode::operator=(std::move(rhs));
+	rhs._movedNodes.clear();
+	attach(*this);
 	return *this;
 }
 
@@ -27,6 +46,140 @@ std::shared_ptr<Node> CompositeTree::clone() const
 	return newTree;
 }
 
+std::shared_ptr<Node> CompositeTree::instantiate(InstanceAllocator& allocator) const
+{
+	return allocator.create<CompositeTree>();
+}
+
+std::shared_ptr<Node> CompositeTree::find(std::string name)
+{
+	auto found = _nodesByName.find(name);
+	if (found == _nodesByName.end())
+		return nullptr;
+
+	return found->second->shared_from_this();
+}
+
+std::shared_ptr<const Node> CompositeTree::find(std::string name) const
+{
+	auto found = _nodesByName.find(name);
+	if (found == _nodesByName.end())
+		return nullptr;
+
+	return std::const_pointer_cast<const Node>(found->second->shared_from_this());
+}
+
+const std::vector<Node*>& CompositeTree::nodesOfType(std::type_index type) const
+{
+	static const std::vector<Node*> noNodes;
+
+	auto found = _nodesByType.find(type);
+	if (found == _nodesByType.end())
+		return noNodes;
+
+	return found->second;
+}
+
+void CompositeTree::update(std::chrono::nanoseconds elapsedTime)
+{
+	// Only the leaf nodes due on this tick are looked at, rather than every node of the hierarchy.
+	_updatingNodes = true;
+	try
+	{
+		_updateScheduler.update(elapsedTime, getCamera().get(), _updateExecutor, _updateGrainSize);
+	}
+	catch (...)
+	{
+		_updatingNodes = false;
+		throw;
+	}
+
+	_updatingNodes = false;
+
+	// Every node is done reading the previous state: swap in the new one.
+	publishStates();
+	applyMutations();
+
+	refreshPreorder();
+	updateModelMatrices();
+
+	// Last: the nodes that left the tree during the tick may still be among the moved ones.
+	_epochs.reclaim();
+}
+
+EpochGuard CompositeTree::enterEpoch()
+{
+	return _epochs.enter();
+}
+
+void CompositeTree::spawn(std::shared_ptr<Node> node, std::shared_ptr<CompositeNode> parent)
+{
+	if (!node)
+		throw std::runtime_error("Attempted to spawn a null node!");
+
+	queueMutation(Mutation{ Mutation::Type::Spawn, std::move(node), std::move(parent) });
+}
+
+void CompositeTree::reparent(std::shared_ptr<Node> node, std::shared_ptr<CompositeNode> parent)
+{
+	if (!node)
+		throw std::runtime_error("Attempted to reparent a null node!");
+
+	queueMutation(Mutation{ Mutation::Type::Reparent, std::move(node), std::move(parent) });
+}
+
+void CompositeTree::applyMutations()
+{
+	std::vector<Mutation> mutations;
+	std::exception_ptr error;
+
+	// Applying a change may queue more of them (onAttached(), destroy() calls from removed nodes...): drain until empty.
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutationsMutex);
+			if (_mutations.empty())
+				break;
+
+			mutations.swap(_mutations);
+		}
+
+		for (Mutation& mutation : mutations)
+		{
+			try
+			{
+				applyMutation(mutation);
+			}
+			catch (const std::runtime_error&)
+			{
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+
+		mutations.clear();
+	}
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void CompositeTree::setUpdateExecutor(Executor* executor, size_t grainSize)
+{
+	_updateExecutor = executor;
+	_updateGrainSize = std::max<size_t>(grainSize, 1);
+}
+
+Executor* CompositeTree::updateExecutor() const
+{
+	return _updateExecutor;
+}
+
+size_t CompositeTree::updateGrainSize() const
+{
+	return _updateGrainSize;
+}
+
 std::shared_ptr<CameraNode> CompositeTree::getCamera()
 {
 	return std::dynamic_pointer_cast<CameraNode>(find("CAMERA"));
@@ -35,4 +188,329 @@ std::shared_ptr<CameraNode> CompositeTree::getCamera()
 std::shared_ptr<const CameraNode> CompositeTree::getCamera() const
 {
 	return std::dynamic_pointer_cast<const CameraNode>(find("CAMERA"));
+}
+
+const SpatialIndex& CompositeTree::spatialIndex() const
+{
+	return _spatialIndex;
+}
+
+const UpdateScheduler& CompositeTree::updateScheduler() const
+{
+	return _updateScheduler;
+}
+
+void CompositeTree::deferDestroy(std::shared_ptr<Node> node)
+{
+	queueMutation(Mutation{ Mutation::Type::Destroy, std::move(node), nullptr });
+}
+
+void CompositeTree::queueMutation(Mutation&& mutation)
+{
+	std::lock_guard<std::mutex> lock(_mutationsMutex);
+	_mutations.push_back(std::move(mutation));
+}
+
+void CompositeTree::applyMutation(Mutation& mutation)
+{
+	Node& node = *mutation.node;
+	CompositeNode& parent = mutation.parent ? *mutation.parent : *this;
+
+	switch (mutation.type)
+	{
+	case Mutation::Type::Destroy:
+		// Already destroyed: only the tear-down was left.
+		node.teardown();
+		break;
+
+	case Mutation::Type::Spawn:
+		if (node.destroyed() || parent.destroyed() || parent.tree() != this)
+			break;
+
+		parent.addChild(mutation.node);
+		break;
+
+	case Mutation::Type::Reparent:
+	{
+		if (node.destroyed() || node.tree() != this || !node.parent() || parent.destroyed() || parent.tree() != this)
+			break;
+
+		if (node.parent() == &parent)
+			break;
+
+		// A node cannot become its own ancestor.
+		for (const CompositeNode* ancestor = &parent; ancestor; ancestor = ancestor->parent())
+			if (ancestor == &node)
+				return;
+
+		// Both parents are in this tree: the node moves without being detached, keeping its timers and index entries.
+		parent.insertChild(node.parent()->extractChild(node));
+		break;
+	}
+	}
+}
+
+void CompositeTree::publishStates()
+{
+	const std::vector<Node*>& updated = _updateScheduler.lastTick();
+	_published.assign(updated.begin(), updated.end());
+
+	{
+		std::lock_guard<std::mutex> lock(_publishMutex);
+
+		// Queued nodes that were also due are published once: two jobs must never publish the same node.
+		if (!_publishQueue.empty())
+			for (Node* node : _published)
+				slotOf(*node).publishQueued = false;
+
+		for (Node* node : _publishQueue)
+		{
+			NodeSlot& slot = slotOf(*node);
+			if (!slot.publishQueued)
+				continue;
+
+			slot.publishQueued = false;
+			_published.push_back(node);
+		}
+
+		_publishQueue.clear();
+	}
+
+	// Nodes that moved (or changed model) are recorded as they go, after the ones already recorded.
+	size_t movedBegin = _movedNodes.size();
+	_movedNodes.resize(movedBegin + _published.size());
+	std::atomic<size_t> movedEnd{ movedBegin };
+
+	auto publishNode = [this, &movedEnd](Node& node) {
+		node.publishState();
+		if (slotOf(node).transformDirty)
+			_movedNodes[movedEnd.fetch_add(1, std::memory_order_relaxed)] = &node;
+	};
+
+	if (_updateExecutor)
+		_updateExecutor->parallelFor(0, _published.size(), [this, &publishNode](size_t index) {
+			publishNode(*_published[index]);
+		}, 1024);
+	else
+		for (Node* node : _published)
+			publishNode(*node);
+
+	_movedNodes.resize(movedEnd.load(std::memory_order_relaxed));
+}
+
+void CompositeTree::queuePublish(Node& node, bool moved)
+{
+	// Nodes only set their own state from within their update: their slot is theirs alone.
+	if (_updatingNodes)
+	{
+		if (moved)
+			slotOf(node).transformDirty = true;
+
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_publishMutex);
+	NodeSlot& slot = slotOf(node);
+	if (moved)
+		slot.transformDirty = true;
+
+	if (slot.publishQueued)
+		return;
+
+	slot.publishQueued = true;
+	_publishQueue.push_back(&node);
+}
+
+void CompositeTree::updateModelMatrices()
+{
+	// The tree's own transform applies to every node.
+	NodeSlot& treeSlot = slotOf(*this);
+	if (treeSlot.transformDirty)
+	{
+		_worldMatrix = _localMatrix;
+		treeSlot.transformDirty = false;
+
+		updateModelMatrices(0, _preorder.size());
+		_movedNodes.clear();
+		return;
+	}
+
+	// Nodes that left the tree since, or were brought up to date when attached, have nothing left to do.
+	_movedNodes.erase(std::remove_if(_movedNodes.begin(), _movedNodes.end(), [this](const Node* node) {
+		return node == this || node->_tree != this || !slotOf(*node).transformDirty;
+	}), _movedNodes.end());
+
+	std::sort(_movedNodes.begin(), _movedNodes.end(), [this](const Node* lhs, const Node* rhs) {
+		return slotOf(*lhs).preorderIndex < slotOf(*rhs).preorderIndex;
+	});
+
+	// Parents come first, and subtrees are contiguous: nodes within a subtree already walked are skipped.
+	size_t walkedEnd = 0;
+	for (const Node* node : _movedNodes)
+	{
+		size_t index = slotOf(*node).preorderIndex;
+		if (index < walkedEnd)
+			continue;
+
+		walkedEnd = _preorder[index].subtreeEnd;
+		updateModelMatrices(index, walkedEnd);
+	}
+
+	_movedNodes.clear();
+}
+
+void CompositeTree::updateModelMatrices(size_t begin, size_t end)
+{
+	for (size_t index = begin; index < end; index++)
+	{
+		Node& node = *_preorder[index].node;
+		node._worldMatrix = node._parent->_worldMatrix * node._localMatrix;
+		NodeSlot& slot = slotOf(node);
+		slot.transformDirty = false;
+
+		// Nodes moving within their fat box leave the hierarchy as it is.
+		_spatialIndex.move(slot.spatialProxy, updateWorldBounds(node));
+	}
+}
+
+const AABB& CompositeTree::updateWorldBounds(Node& node)
+{
+	const std::shared_ptr<Model>& model = node.model();
+	if (model && !model->bounds().empty())
+		node._worldBounds = model->bounds().transformed(node._worldMatrix);
+	else
+	{
+		glm::vec3 position(node._worldMatrix[3]);
+		node._worldBounds = AABB(position, position);
+	}
+
+	return node._worldBounds;
+}
+
+void CompositeTree::invalidatePreorder()
+{
+	_preorderDirty = true;
+}
+
+void CompositeTree::refreshPreorder()
+{
+	if (!_preorderDirty)
+		return;
+
+	_preorderDirty = false;
+	_preorder.clear();
+
+	// Depth first, with an explicit stack: deep hierarchies must not overflow the thread's stack.
+	struct Frame
+	{
+		const CompositeNode* node;
+		size_t nextChild;
+		size_t entry;
+	};
+
+	std::vector<Frame> stack{ { this, 0, 0 } };
+	while (!stack.empty())
+	{
+		Frame& frame = stack.back();
+		if (frame.nextChild == frame.node->_children.size())
+		{
+			// All of the node's descendants are in: close its subtree.
+			if (frame.node != this)
+				_preorder[frame.entry].subtreeEnd = _preorder.size();
+
+			stack.pop_back();
+			continue;
+		}
+
+		Node* child = frame.node->_children[frame.nextChild++].get();
+		size_t index = _preorder.size();
+		slotOf(*child).preorderIndex = index;
+		_preorder.push_back({ child, index + 1, child->isComposite() });
+
+		if (child->isComposite())
+			stack.push_back({ static_cast<CompositeNode*>(child), 0, index });
+	}
+}
+
+void CompositeTree::registerNode(Node& node)
+{
+	invalidatePreorder();
+
+	// Setters may look up slots from other threads: the array only grows under their mutex.
+	if (!_freeNodeSlots.empty())
+	{
+		node._treeSlot = _freeNodeSlots.back();
+		_freeNodeSlots.pop_back();
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(_publishMutex);
+		if (_nodeSlots.size() >= UINT32_MAX)
+			throw std::runtime_error("Attempted to add too many nodes to a tree!");
+
+		node._treeSlot = static_cast<uint32_t>(_nodeSlots.size());
+		_nodeSlots.emplace_back();
+	}
+
+	NodeSlot& slot = slotOf(node);
+
+	// Names are unique within a tree, as addChild() rejects taken names; nodes below the roots of prefab instances are
+	// found from their instance's root instead.
+	if (!node._archetype->scopedName)
+		_nodesByName.emplace(node._archetype->name, &node);
+
+	std::vector<Node*>& nodesOfType = _nodesByType[typeid(node)];
+	slot.typeIndexPosition = nodesOfType.size();
+	nodesOfType.push_back(&node);
+
+	// Nodes show up with their state as of when they were added, rather than whatever was published before. Parents are
+	// attached before their children, so the node's model matrix can be brought up to date right away.
+	node.publishState();
+	node._worldMatrix = node._parent ? node._parent->_worldMatrix * node._localMatrix : node._localMatrix;
+	slot.transformDirty = false;
+
+	if (&node != this)
+		slot.spatialProxy = _spatialIndex.insert(node, updateWorldBounds(node));
+
+	// Children are scheduled directly: composite nodes are only updated when they opt in.
+	if (!node.isComposite() || static_cast<CompositeNode&>(node)._scheduled)
+		_updateScheduler.add(node);
+}
+
+void CompositeTree::unregisterNode(Node& node)
+{
+	invalidatePreorder();
+
+	auto named = _nodesByName.find(node.getName());
+	if (named != _nodesByName.end() && named->second == &node)
+		_nodesByName.erase(named);
+
+	NodeSlot& slot = slotOf(node);
+
+	// Swap and pop, keeping the moved node's position up to date.
+	std::vector<Node*>& nodesOfType = _nodesByType[typeid(node)];
+	Node* last = nodesOfType.back();
+	nodesOfType[slot.typeIndexPosition] = last;
+	slotOf(*last).typeIndexPosition = slot.typeIndexPosition;
+	nodesOfType.pop_back();
+
+	if (slot.spatialProxy != SpatialIndex::NoProxy)
+		_spatialIndex.remove(slot.spatialProxy);
+
+	_updateScheduler.remove(node);
+
+	// Rare: the node was set, then removed, between two ticks.
+	if (slot.publishQueued)
+	{
+		std::lock_guard<std::mutex> lock(_publishMutex);
+		_publishQueue.erase(std::find(_publishQueue.begin(), _publishQueue.end(), &node));
+	}
+
+	// The slot goes to the next node added, as good as new; its timers are cancelled along the way.
+	slot = NodeSlot();
+	_freeNodeSlots.push_back(node._treeSlot);
+
+	// Readers may still hold the node: whoever releases it last, it is freed on reclamation at the earliest.
+	if (&node != this)
+		_epochs.retire(node.weak_from_this().lock());
 }
\ No newline at end of file
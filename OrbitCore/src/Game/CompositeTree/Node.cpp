@@ -2,79 +2,183 @@
 
 #include "Game/CompositeTree/Node.h"
 
+#include "Game/CompositeTree/CompositeTree.h"
 #include "Game/CompositeTree/Visitor.h"
 
 #include "Render/Model.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+
 using namespace Orbit;
 
 Node::Node(const std::string& name, const std::shared_ptr<Model>& model)
-	: _name(name), _model(model)
+	: _archetype(std::make_shared<Archetype>(Archetype{ name, model, Transform{}, glm::mat4(1.f) }))
 {
 }
 
 Node::Node(const Input& input, const std::string& name, const std::shared_ptr<Model>& model)
-	: _input(&input), _name(name), _model(model)
+	: _input(&input), _archetype(std::make_shared<Archetype>(Archetype{ name, model, Transform{}, glm::mat4(1.f) }))
+{
+}
+
+Node::Node(const std::shared_ptr<const Archetype>& archetype)
+	: _position(archetype->transform.position), _rotation(archetype->transform.rotation), _scale(archetype->transform.scale),
+	_published(archetype->transform), _localMatrix(archetype->localMatrix), _worldMatrix(archetype->localMatrix),
+	_archetype(archetype)
+{
+}
+
+Node::Node(const Input& input, const std::shared_ptr<const Archetype>& archetype)
+	: Node(archetype)
 {
+	_input = &input;
 }
 
 Node::Node(Node&& rhs)
-	: _input(rhs._input), _name(std::move(rhs._name)), _model(rhs._model)
+	: _position(rhs._position), _rotation(rhs._rotation), _scale(rhs._scale),
+	_published(rhs._published), _localMatrix(rhs._localMatrix), _worldMatrix(rhs._localMatrix),
+	_input(rhs._input), _archetype(rhs._archetype), _updatePeriod(rhs._updatePeriod)
 {
 }
 
 Node& Node::operator=(Node&& rhs)
 {
+	detach();
+
+	_position = rhs._position;
+	_rotation = rhs._rotation;
+	_scale = rhs._scale;
+	_published = rhs._published;
+	_localMatrix = rhs._localMatrix;
+	_worldMatrix = rhs._localMatrix;
 	_input = rhs._input;
-	_destroyed = rhs._destroyed;
-	_name = std::move(rhs._name);
-	_model = rhs._model;
+	_destroyed = rhs._destroyed.load();
+	_archetype = rhs._archetype;
+	_updatePeriod = rhs._updatePeriod;
+
+	// The bounds belong to the node's previous life: it starts over, detached.
+	_worldBounds = AABB();
+
+	// The id goes along with the state (a recycled node is a new instance), and rhs gets a new one, so that no two nodes
+	// ever share an id.
+	_instanceId = rhs._instanceId;
+	rhs._instanceId = newInstanceId();
 	return *this;
 }
 
+uint64_t Node::newInstanceId()
+{
+	static std::atomic<uint64_t> nextInstanceId{ 1 };
+	return nextInstanceId.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Node::acceptVisitor(Visitor* visitor)
 {
 	visitor->visitElement(this);
 }
 
+std::chrono::nanoseconds Node::updatePeriod(float /*cameraDistance*/) const
+{
+	return _updatePeriod;
+}
+
+void Node::setUpdatePeriod(std::chrono::nanoseconds period)
+{
+	_updatePeriod = period;
+}
+
 void Node::destroy()
 {
-	setDestroyed(true);
+	if (_destroyed.exchange(true))
+		return;
+
+	// Siblings might be iterated over (or updated) right now: leave the actual removal to the tree.
+	if (_tree)
+	{
+		_tree->deferDestroy(shared_from_this());
+		return;
+	}
+
+	// The parent may hold the last reference to the node: keep it alive until it is torn down.
+	std::shared_ptr<Node> self = weak_from_this().lock();
+	teardown();
+}
+
+void Node::teardown()
+{
+	if (_parent)
+		_parent->removeChild(shared_from_this());
+
+	detach();
+}
+
+void Node::attach(CompositeTree& tree)
+{
+	if (_tree == &tree || destroyed())
+		return;
+
+	detach();
+	_tree = &tree;
+	tree.registerNode(*this);
+	onAttached();
+}
+
+void Node::detach()
+{
+	cancelTimers();
+
+	if (_tree == nullptr)
+		return;
+
+	_tree->unregisterNode(*this);
+	_tree = nullptr;
+}
+
+bool Node::attached() const
+{
+	return _tree != nullptr;
+}
+
+CompositeTree* Node::tree() const
+{
+	return _tree;
+}
+
+CompositeNode* Node::parent() const
+{
+	return _parent;
 }
 
 std::string Node::getName() const
 {
-	return _name;
+	return _archetype->name;
 }
 
 bool Node::destroyed() const
 {
-	
-	std::lock_guard<std::mutex> lock(_mutex);
-	return _destroyed;
+	return _destroyed.load(std::memory_order_acquire);
 }
 
 void Node::setDestroyed(bool value)
 {
-	std::lock_guard<std::mutex> lock(_mutex);
-	_destroyed = value;
+	_destroyed.store(value, std::memory_order_release);
 }
 
 bool Node::hasModel() const
 {
-	return _model != nullptr;
+	return _archetype->model != nullptr;
 }
 
 std::shared_ptr<Model> Node::getModel() const
 {
-	return _model;
+	return _archetype->model;
 }
 
 std::shared_ptr<Node> Node::find(std::string name)
 {
-	if (_name == name)
+	if (_archetype->name == name)
 		return shared_from_this();
 
 	return nullptr;
@@ -82,7 +186,7 @@ std::shared_ptr<Node> Node::find(std::string name)
 
 std::shared_ptr<const Node> Node::find(std::string name) const
 {
-	if (_name == name)
+	if (_archetype->name == name)
 		return shared_from_this();
 
 	return nullptr;
@@ -90,39 +194,168 @@ std::shared_ptr<const Node> Node::find(std::string name) const
 
 glm::vec3 Node::position() const
 {
-	return _position;
+	return _published.position;
 }
 
 glm::quat Node::rotation() const
 {
-	return _rotation;
+	return _published.rotation;
 }
 
 float Node::scale() const
 {
-	return _scale;
+	return _published.scale;
+}
+
+const Node::Transform& Node::transform() const
+{
+	return _published;
+}
+
+const glm::mat4& Node::localMatrix() const
+{
+	return _localMatrix;
 }
 
-glm::mat4 Node::modelMatrix() const
+glm::mat4 Node::buildLocalMatrix(const Transform& transform)
 {
-	glm::mat4 result = glm::translate(glm::mat4(), _position);
-	result *= glm::mat4_cast(_rotation);
-	return glm::scale(result, glm::vec3(_scale));
+	glm::mat4 matrix = glm::translate(glm::mat4(), transform.position);
+	matrix *= glm::mat4_cast(transform.rotation);
+	return glm::scale(matrix, glm::vec3(transform.scale));
+}
+
+const glm::mat4& Node::modelMatrix() const
+{
+	return _worldMatrix;
 }
 
 void Node::setPosition(const glm::vec3& newPos)
 {
 	_position = newPos;
+	stateChanged();
 }
 
 void Node::setRotation(const glm::quat& newRot)
 {
 	_rotation = newRot;
+	stateChanged();
 }
 
 void Node::setScale(float newScale)
 {
 	_scale = newScale;
+	stateChanged();
+}
+
+void Node::setTransform(const Transform& newTransform)
+{
+	_position = newTransform.position;
+	_rotation = newTransform.rotation;
+	_scale = newTransform.scale;
+	stateChanged();
+}
+
+void Node::setModel(const std::shared_ptr<Model>& model)
+{
+	if (_archetype->model == model)
+		return;
+
+	ownArchetype().model = model;
+
+	// The node's world bounds follow its model: have the tree bring them up to date.
+	if (attached())
+		_tree->queuePublish(*this, true);
+}
+
+void Node::publishState()
+{
+	if (_published.position == _position && _published.rotation == _rotation && _published.scale == _scale)
+		return;
+
+	_published.position = _position;
+	_published.rotation = _rotation;
+	_published.scale = _scale;
+
+	_localMatrix = buildLocalMatrix(_published);
+
+	// Within a tree, the model matrix also depends on the ancestors': leave it to the tree's pass over the hierarchy.
+	if (attached())
+		_tree->slotOf(*this).transformDirty = true;
+	else
+		_worldMatrix = _localMatrix;
+}
+
+void Node::stateChanged()
+{
+	// Outside of a tree, there are no ticks to wait for.
+	if (!attached())
+		publishState();
+	else
+		_tree->queuePublish(*this);
+}
+
+void Node::adoptArchetype(const std::shared_ptr<const Archetype>& archetype)
+{
+	_archetype = archetype;
+
+	_position = archetype->transform.position;
+	_rotation = archetype->transform.rotation;
+	_scale = archetype->transform.scale;
+	_published = archetype->transform;
+	_localMatrix = archetype->localMatrix;
+	_worldMatrix = archetype->localMatrix;
+}
+
+Node::Archetype& Node::ownArchetype()
+{
+	// Archetypes are only ever referenced by nodes: a node holding the only reference may modify it in place.
+	if (_archetype.use_count() > 1)
+		_archetype = std::make_shared<Archetype>(*_archetype);
+
+	return const_cast<Archetype&>(*_archetype);
+}
+
+const std::shared_ptr<const Node::Archetype>& Node::archetype() const
+{
+	return _archetype;
+}
+
+void Node::onAttached()
+{
+}
+
+void Node::scheduleTimer(std::chrono::nanoseconds delay, TimerWheel::Callback callback)
+{
+	TimerWheel& wheel = timers();
+	std::vector<TimerHandle>& nodeTimers = _tree->slotOf(*this).timers;
+
+	// Forget about the timers that already ran, so that one-shot timers do not pile up.
+	nodeTimers.erase(std::remove_if(nodeTimers.begin(), nodeTimers.end(), [](const TimerHandle& timer) {
+		return !timer.active();
+	}), nodeTimers.end());
+
+	nodeTimers.push_back(wheel.schedule(delay, std::move(callback)));
+}
+
+void Node::scheduleRepeatingTimer(std::chrono::nanoseconds period, TimerWheel::Callback callback)
+{
+	TimerWheel& wheel = timers();
+	_tree->slotOf(*this).timers.push_back(wheel.scheduleRepeating(period, std::move(callback)));
+}
+
+void Node::cancelTimers()
+{
+	// Timers only exist within a tree.
+	if (attached())
+		_tree->slotOf(*this).timers.clear();
+}
+
+TimerWheel& Node::timers() const
+{
+	if (_tree == nullptr)
+		throw std::runtime_error("Attempted to get the timers of a node that is not in a tree!");
+
+	return _tree->_timerWheel;
 }
 
 const Input& Node::getInput() const
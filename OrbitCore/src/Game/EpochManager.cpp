@@ -0,0 +1,82 @@
+/*! @file Game/EpochManager.cpp */
+
+#include "Game/EpochManager.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace Orbit;
+
+void EpochGuard::leave() noexcept
+{
+	if (!_slot)
+		return;
+
+	_slot->store(0, std::memory_order_release);
+	_slot = nullptr;
+}
+
+EpochManager::EpochManager() = default;
+
+EpochGuard EpochManager::enter()
+{
+	for (;;)
+	{
+		for (Slot& slot : _slots)
+		{
+			uint64_t epoch = _epoch.load(std::memory_order_seq_cst);
+			uint64_t expected = Inactive;
+			if (!slot.epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst))
+				continue;
+
+			// The epoch may have moved on before the slot was published, in which case reclaim() might not have seen
+			// it: publish the new epoch until it holds still.
+			uint64_t current = _epoch.load(std::memory_order_seq_cst);
+			while (current != epoch)
+			{
+				epoch = current;
+				slot.epoch.store(epoch, std::memory_order_seq_cst);
+				current = _epoch.load(std::memory_order_seq_cst);
+			}
+
+			return EpochGuard(&slot.epoch);
+		}
+
+		// Every slot is taken: wait for a reader to leave.
+		std::this_thread::yield();
+	}
+}
+
+void EpochManager::retire(std::shared_ptr<const void> object)
+{
+	if (!object)
+		return;
+
+	_retired.push_back({ _epoch.load(std::memory_order_relaxed), std::move(object) });
+}
+
+void EpochManager::reclaim()
+{
+	// Readers entering from now on cannot reach anything retired so far: they pin the next epoch.
+	uint64_t oldest = _epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+	for (const Slot& slot : _slots)
+	{
+		uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+		if (epoch != Inactive)
+			oldest = std::min(oldest, epoch);
+	}
+
+	// Objects retired in an epoch that every reader has left can go. Releasing them may retire more objects (e.g. nodes
+	// detaching their children): pop before releasing.
+	while (!_retired.empty() && _retired.front().epoch < oldest)
+	{
+		std::shared_ptr<const void> object = std::move(_retired.front().object);
+		_retired.pop_front();
+	}
+}
+
+size_t EpochManager::retired() const
+{
+	return _retired.size();
+}
\ No newline at end of file
@@ -2,9 +2,60 @@
 
 #include "Game/Factories/NodeFactory.h"
 
+#include "Game/CompositeTree/Node.h"
+
+#include <mutex>
+#include <unordered_map>
+
 using namespace Orbit;
 
 NodeFactory::NodeFactory(const Input& input)
 	: _input(input)
 {
+}
+
+std::vector<std::shared_ptr<Node>> NodeFactory::create(const std::vector<std::string_view>& names) const
+{
+	std::vector<std::shared_ptr<Node>> nodes;
+	nodes.reserve(names.size());
+
+	for (std::string_view name : names)
+		nodes.push_back(create(std::string(name)));
+
+	return nodes;
+}
+
+std::vector<std::shared_ptr<Node>> NodeFactory::create(const std::vector<std::shared_ptr<const Node::Archetype>>& archetypes) const
+{
+	std::vector<std::shared_ptr<Node>> nodes;
+	nodes.reserve(archetypes.size());
+
+	for (const std::shared_ptr<const Node::Archetype>& archetype : archetypes)
+	{
+		std::shared_ptr<Node> node = create(archetype->name);
+		node->adoptArchetype(archetype);
+		nodes.push_back(std::move(node));
+	}
+
+	return nodes;
+}
+
+std::vector<std::shared_ptr<Node>> NodeFactory::create(const std::string& namePrefix, size_t count) const
+{
+	std::vector<std::string> names;
+	names.reserve(count);
+	for (size_t index = 0; index < count; index++)
+		names.push_back(namePrefix + std::to_string(index));
+
+	return create(std::vector<std::string_view>(names.begin(), names.end()));
+}
+
+size_t NodeFactory::slot(std::type_index type)
+{
+	// Shared by every module, so that a type gets the same slot wherever it is asked for.
+	static std::mutex mutex;
+	static std::unordered_map<std::type_index, size_t> slots;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	return slots.emplace(type, slots.size()).first->second;
 }
\ No newline at end of file
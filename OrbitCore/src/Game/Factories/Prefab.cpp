@@ -0,0 +1,114 @@
+/*! @file Game/Factories/Prefab.cpp */
+
+#include "Game/Factories/Prefab.h"
+
+#include "Game/CompositeTree/CompositeNode.h"
+#include "Game/Factories/InstanceAllocator.h"
+
+#include <stdexcept>
+
+using namespace Orbit;
+
+namespace
+{
+	/*! The memory guessed for each node of an instance, before the first instantiation tells. */
+	constexpr size_t GuessedNodeSize = 512;
+}
+
+Prefab::Prefab(std::shared_ptr<Node> root)
+{
+	if (!root)
+		throw std::runtime_error("Attempted to make a prefab out of a null node!");
+
+	if (root->attached() || root->parent())
+		throw std::runtime_error("Attempted to make a prefab out of a node that is part of a tree!");
+
+	// Depth first, with an explicit stack, like the tree's pre-order array.
+	std::vector<Entry> stack{ { std::move(root), 0 } };
+	while (!stack.empty())
+	{
+		Entry entry = std::move(stack.back());
+		stack.pop_back();
+
+		Node& node = *entry.node;
+		size_t index = _entries.size();
+
+		// The template's transforms become its archetypes' defaults. Names below the root are repeated by every instance.
+		node.publishState();
+		Node::Archetype& archetype = node.ownArchetype();
+		archetype.transform = node._published;
+		archetype.localMatrix = node._localMatrix;
+		archetype.scopedName = index > 0;
+
+		if (node.isComposite())
+		{
+			const std::vector<std::shared_ptr<Node>>& children = static_cast<CompositeNode&>(node)._children;
+			for (auto child = children.rbegin(); child != children.rend(); ++child)
+				stack.push_back({ *child, index });
+		}
+
+		_entries.push_back(std::move(entry));
+	}
+}
+
+std::shared_ptr<Node> Prefab::instantiate(const std::string& name) const
+{
+	InstanceAllocator allocator(_instanceSize.load(std::memory_order_relaxed));
+	std::shared_ptr<Node> instance = instantiate(allocator, name);
+
+	_instanceSize.store(allocator.allocated(), std::memory_order_relaxed);
+	return instance;
+}
+
+std::vector<std::shared_ptr<Node>> Prefab::instantiate(const std::string& namePrefix, size_t count) const
+{
+	std::vector<std::shared_ptr<Node>> instances;
+	instances.reserve(count);
+
+	size_t instanceSize = _instanceSize.load(std::memory_order_relaxed);
+	if (instanceSize == 0)
+		instanceSize = _entries.size() * GuessedNodeSize;
+
+	// One block for the whole batch: it goes away along with the last of its nodes.
+	InstanceAllocator allocator(instanceSize * count);
+	for (size_t index = 0; index < count; index++)
+		instances.push_back(instantiate(allocator, namePrefix + std::to_string(index)));
+
+	if (count > 0)
+		_instanceSize.store(allocator.allocated() / count, std::memory_order_relaxed);
+
+	return instances;
+}
+
+size_t Prefab::size() const
+{
+	return _entries.size();
+}
+
+std::shared_ptr<Node> Prefab::instantiate(InstanceAllocator& allocator, const std::string& name) const
+{
+	std::vector<std::shared_ptr<Node>> nodes;
+	nodes.reserve(_entries.size());
+
+	for (const Entry& entry : _entries)
+	{
+		std::shared_ptr<Node> node = entry.node->instantiate(allocator);
+
+		// Node types constructing their instances from something else than the archetype (i.e. a name and a model) are
+		// handed the template's state afterwards.
+		if (node->_archetype != entry.node->_archetype)
+			node->adoptArchetype(entry.node->_archetype);
+
+		if (!nodes.empty())
+			static_cast<CompositeNode&>(*nodes[entry.parent]).insertChild(node);
+
+		nodes.push_back(std::move(node));
+	}
+
+	// The root's archetype only differs by its name: copied into the batch's block as well.
+	std::shared_ptr<Node::Archetype> rootArchetype = allocator.create<Node::Archetype>(*nodes.front()->_archetype);
+	rootArchetype->name = name;
+	nodes.front()->_archetype = std::move(rootArchetype);
+
+	return nodes.front();
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+/*! @file Game/FrameGraph.cpp */
+
+#include "Game/FrameGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Orbit;
+
+void FrameGraph::addPhase(FramePhase phase)
+{
+	validatePhase(phase);
+
+	_phases.push_back(std::move(phase));
+	compile();
+}
+
+void FrameGraph::insertPhase(const std::string& before, FramePhase phase)
+{
+	validatePhase(phase);
+
+	auto found = std::find_if(_phases.begin(), _phases.end(), [&before](const FramePhase& existing) {
+		return existing.name == before;
+	});
+
+	if (found == _phases.end())
+		throw std::runtime_error("Could not find frame phase " + before + " to insert before!");
+
+	_phases.insert(found, std::move(phase));
+	compile();
+}
+
+void FrameGraph::removePhase(const std::string& name)
+{
+	auto found = std::find_if(_phases.begin(), _phases.end(), [&name](const FramePhase& existing) {
+		return existing.name == name;
+	});
+
+	if (found == _phases.end())
+		return;
+
+	_phases.erase(found);
+	compile();
+}
+
+size_t FrameGraph::size() const
+{
+	return _phases.size();
+}
+
+const FramePhase& FrameGraph::phase(size_t index) const
+{
+	return _phases[index];
+}
+
+size_t FrameGraph::dependencyCount(size_t index) const
+{
+	return _dependencyCounts[index];
+}
+
+const std::vector<size_t>& FrameGraph::successors(size_t index) const
+{
+	return _successors[index];
+}
+
+void FrameGraph::validatePhase(const FramePhase& phase) const
+{
+	if (!phase.run)
+		throw std::runtime_error("Attempted to add frame phase " + phase.name + " without a function!");
+
+	for (const FramePhase& existing : _phases)
+		if (existing.name == phase.name)
+			throw std::runtime_error("A frame phase named " + phase.name + " already exists!");
+}
+
+void FrameGraph::compile()
+{
+	_dependencyCounts.assign(_phases.size(), 0);
+	_successors.assign(_phases.size(), std::vector<size_t>());
+
+	for (size_t i = 0; i < _phases.size(); i++)
+	{
+		const FramePhase& first = _phases[i];
+		for (size_t j = i + 1; j < _phases.size(); j++)
+		{
+			const FramePhase& second = _phases[j];
+
+			bool conflicts =
+				(first.writes & (second.reads | second.writes)) != FrameResource::None ||
+				(first.reads & second.writes) != FrameResource::None;
+
+			if (!conflicts)
+				continue;
+
+			_successors[i].push_back(j);
+			_dependencyCounts[j]++;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+/*! @file Game/Scene.cpp */
+
+#include "Game/Scene.h"
+
+#include "Game/CompositeTree/CompositeNode.h"
+#include "Game/Factories/InstanceAllocator.h"
+#include "Game/SceneFile.h"
+
+#include <stdexcept>
+
+using namespace Orbit;
+
+void Scene::saveNodes(const std::string& path, const CompositeNode& root) const
+{
+	std::unordered_map<const Model*, std::string> modelNames;
+	for (const auto& model : _models)
+		modelNames.emplace(model.second.get(), model.first);
+
+	SceneFile::write(path, root, _typeNames, modelNames);
+}
+
+std::vector<std::shared_ptr<Node>> Scene::loadNodes(const std::string& path)
+{
+	SceneFile file(path);
+	const SceneFile::Header& header = file.header();
+	const SceneFile::NodeRecord* records = file.nodes();
+	size_t nodeCount = header.nodeCount;
+
+	// Types and models are looked up once per file, rather than once per node.
+	std::vector<NodeFactory*> factories(header.typeCount);
+	for (size_t type = 0; type < factories.size(); type++)
+	{
+		std::string typeName(file.typeName(type));
+		auto slot = _slotsByTypeName.find(typeName);
+		if (slot == _slotsByTypeName.end())
+			throw std::runtime_error("Scene file " + path + " holds nodes of type " + typeName + ", which has no factory in this scene!");
+
+		factories[type] = _factories[slot->second].get();
+	}
+
+	std::vector<std::shared_ptr<Model>> models(header.modelCount);
+	for (size_t model = 0; model < models.size(); model++)
+	{
+		std::string modelName(file.modelName(model));
+		auto found = _models.find(modelName);
+		if (found == _models.end())
+			throw std::runtime_error("Scene file " + path + " refers to model " + modelName + ", which is not in this scene!");
+
+		models[model] = found->second;
+	}
+
+	// Nodes are created type by type, each type in a single batch, straight from archetypes holding their whole state.
+	// The archetypes are allocated in a single block, freed along with the last of the nodes.
+	std::vector<std::vector<std::shared_ptr<const Node::Archetype>>> archetypes(factories.size());
+	std::vector<std::vector<uint32_t>> indices(factories.size());
+	InstanceAllocator allocator(nodeCount * 2 * sizeof(Node::Archetype));
+	for (uint32_t index = 0; index < nodeCount; index++)
+	{
+		const SceneFile::NodeRecord& record = records[index];
+		if (record.type >= factories.size() || (record.model != SceneFile::None && record.model >= models.size()))
+			throw std::runtime_error("Scene file " + path + " is malformatted!");
+
+		std::shared_ptr<Node::Archetype> archetype = allocator.create<Node::Archetype>();
+		archetype->name = file.string(record.name);
+		if (record.model != SceneFile::None)
+			archetype->model = models[record.model];
+
+		archetype->transform = Node::Transform{
+			{ record.position[0], record.position[1], record.position[2] },
+			{ record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3] },
+			record.scale
+		};
+		archetype->localMatrix = Node::buildLocalMatrix(archetype->transform);
+
+		archetypes[record.type].push_back(std::move(archetype));
+		indices[record.type].push_back(index);
+	}
+
+	std::vector<std::shared_ptr<Node>> nodes(nodeCount);
+	for (size_t type = 0; type < factories.size(); type++)
+	{
+		std::vector<std::shared_ptr<Node>> created = factories[type]->create(archetypes[type]);
+		if (created.size() != indices[type].size())
+			throw std::runtime_error("Factory for type " + std::string(file.typeName(type)) + " did not create every node!");
+
+		for (size_t node = 0; node < created.size(); node++)
+			nodes[indices[type][node]] = std::move(created[node]);
+	}
+
+	// Children are grouped by parent (the nodes at the top under index 0, the children of node i under i + 1), so that
+	// each parent gets its children in one go.
+	std::vector<size_t> groupStarts(nodeCount + 2, 0);
+	for (uint32_t index = 0; index < nodeCount; index++)
+	{
+		const SceneFile::NodeRecord& record = records[index];
+
+		// Parents come first: this also rules out cycles.
+		if (record.parent != SceneFile::None && (record.parent >= index || !nodes[record.parent]->isComposite()))
+			throw std::runtime_error("Scene file " + path + " is malformatted!");
+
+		groupStarts[record.parent == SceneFile::None ? 1 : record.parent + 2]++;
+	}
+
+	for (size_t group = 1; group < groupStarts.size(); group++)
+		groupStarts[group] += groupStarts[group - 1];
+
+	std::vector<uint32_t> grouped(nodeCount);
+	std::vector<size_t> groupEnds(groupStarts.begin(), groupStarts.end() - 1);
+	for (uint32_t index = 0; index < nodeCount; index++)
+	{
+		uint32_t parent = records[index].parent;
+		grouped[groupEnds[parent == SceneFile::None ? 0 : parent + 1]++] = index;
+	}
+
+	std::vector<std::shared_ptr<Node>> topNodes;
+	std::vector<std::shared_ptr<Node>> children;
+	for (size_t group = 0; group + 1 < groupStarts.size(); group++)
+	{
+		if (groupStarts[group] == groupStarts[group + 1])
+			continue;
+
+		children.clear();
+		for (size_t child = groupStarts[group]; child < groupStarts[group + 1]; child++)
+			children.push_back(nodes[grouped[child]]);
+
+		// Parents are filled in pre-order: each one is still alone in its hierarchy when its children come in.
+		if (group == 0)
+			topNodes = children;
+		else
+			static_cast<CompositeNode&>(*nodes[group - 1]).addChildren(children);
+	}
+
+	return topNodes;
+}
\ No newline at end of file
@@ -0,0 +1,348 @@
+/*! @file Game/SceneFile.cpp */
+
+#include "Game/SceneFile.h"
+
+#include "Game/CompositeTree/CompositeNode.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+using namespace Orbit;
+
+namespace
+{
+	/*! The magic number of scene files. */
+	constexpr char Magic[4] = { 'O', 'R', 'B', 'S' };
+	/*! The alignment of the file's tables. */
+	constexpr uint64_t TableAlignment = 8;
+
+	/*!
+	@brief Rounds an offset up to the alignment of the file's tables.
+	@param offset The offset.
+	@return The aligned offset.
+	*/
+	uint64_t alignTable(uint64_t offset)
+	{
+		return (offset + TableAlignment - 1) / TableAlignment * TableAlignment;
+	}
+
+	/*!
+	@brief Accumulates the strings of a file, and the indices of the names interned in its tables.
+	*/
+	class StringTable
+	{
+	public:
+		/*!
+		@brief Adds a string to the table.
+		@param string The string.
+		@return The string's reference.
+		*/
+		SceneFile::StringRef add(const std::string& string)
+		{
+			SceneFile::StringRef ref{ static_cast<uint32_t>(_data.size()), static_cast<uint32_t>(string.size()) };
+			_data += string;
+			return ref;
+		}
+
+		/*!
+		@brief Returns the index of a name in a table of names, adding it to the table (and the string to the string table)
+		if it is not there yet.
+		@param names The index of the table's names.
+		@param table The table.
+		@param name The name.
+		@return The name's index in the table.
+		*/
+		uint32_t intern(std::unordered_map<std::string, uint32_t>& names, std::vector<SceneFile::StringRef>& table, const std::string& name)
+		{
+			auto inserted = names.emplace(name, static_cast<uint32_t>(table.size()));
+			if (inserted.second)
+				table.push_back(add(name));
+
+			return inserted.first->second;
+		}
+
+		/*!
+		@brief Getter for the table's data.
+		@return The strings, end to end.
+		*/
+		const std::string& data() const
+		{
+			return _data;
+		}
+
+	private:
+		/*! The strings, end to end. */
+		std::string _data;
+	};
+
+	/*!
+	@brief Writes a table to a file, at its offset.
+	@param file The file.
+	@param offset The table's offset.
+	@param data The table's data.
+	@param size The table's size.
+	*/
+	void writeTable(std::ofstream& file, uint64_t offset, const void* data, size_t size)
+	{
+		static const char padding[TableAlignment] = {};
+
+		uint64_t position = static_cast<uint64_t>(file.tellp());
+		file.write(padding, static_cast<std::streamsize>(offset - position));
+		file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}
+}
+
+void SceneFile::write(
+	const std::string& path,
+	const CompositeNode& root,
+	const std::unordered_map<std::type_index, std::string>& typeNames,
+	const std::unordered_map<const Model*, std::string>& modelNames)
+{
+	StringTable strings;
+	std::unordered_map<std::string, uint32_t> typeIndices;
+	std::unordered_map<std::string, uint32_t> modelIndices;
+	std::vector<StringRef> types;
+	std::vector<StringRef> models;
+	std::vector<NodeRecord> nodes;
+
+	// Depth first, with an explicit stack, so that parents are written before their children.
+	struct Frame
+	{
+		const Node* node;
+		uint32_t parent;
+	};
+
+	std::vector<Frame> stack;
+	for (auto child = root._children.rbegin(); child != root._children.rend(); ++child)
+		stack.push_back({ child->get(), None });
+
+	while (!stack.empty())
+	{
+		Frame frame = stack.back();
+		stack.pop_back();
+
+		const Node& node = *frame.node;
+		uint32_t index = static_cast<uint32_t>(nodes.size());
+
+		NodeRecord record{};
+		record.name = strings.add(node.getName());
+		auto typeName = typeNames.find(typeid(node));
+		if (typeName == typeNames.end())
+			throw std::runtime_error("Attempted to save node " + node.getName() + ", whose type has no name!");
+
+		record.type = strings.intern(typeIndices, types, typeName->second);
+		record.parent = frame.parent;
+		record.model = None;
+
+		if (const std::shared_ptr<Model>& model = node.model())
+		{
+			auto name = modelNames.find(model.get());
+			if (name == modelNames.end())
+				throw std::runtime_error("Attempted to save node " + node.getName() + ", whose model has no name!");
+
+			record.model = strings.intern(modelIndices, models, name->second);
+		}
+
+		const Node::Transform& transform = node.transform();
+		record.position[0] = transform.position.x;
+		record.position[1] = transform.position.y;
+		record.position[2] = transform.position.z;
+		record.rotation[0] = transform.rotation.w;
+		record.rotation[1] = transform.rotation.x;
+		record.rotation[2] = transform.rotation.y;
+		record.rotation[3] = transform.rotation.z;
+		record.scale = transform.scale;
+		nodes.push_back(record);
+
+		if (node.isComposite())
+		{
+			const std::vector<std::shared_ptr<Node>>& children = static_cast<const CompositeNode&>(node)._children;
+			for (auto child = children.rbegin(); child != children.rend(); ++child)
+				stack.push_back({ child->get(), index });
+		}
+	}
+
+	Header header{};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.typeCount = static_cast<uint32_t>(types.size());
+	header.modelCount = static_cast<uint32_t>(models.size());
+	header.nodeCount = static_cast<uint32_t>(nodes.size());
+	header.stringsSize = static_cast<uint32_t>(strings.data().size());
+	header.typesOffset = alignTable(sizeof(Header));
+	header.modelsOffset = alignTable(header.typesOffset + types.size() * sizeof(StringRef));
+	header.nodesOffset = alignTable(header.modelsOffset + models.size() * sizeof(StringRef));
+	header.stringsOffset = alignTable(header.nodesOffset + nodes.size() * sizeof(NodeRecord));
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("Could not open scene file " + path + " for writing!");
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeTable(file, header.typesOffset, types.data(), types.size() * sizeof(StringRef));
+	writeTable(file, header.modelsOffset, models.data(), models.size() * sizeof(StringRef));
+	writeTable(file, header.nodesOffset, nodes.data(), nodes.size() * sizeof(NodeRecord));
+	writeTable(file, header.stringsOffset, strings.data().data(), strings.data().size());
+
+	if (!file)
+		throw std::runtime_error("Could not write scene file " + path + "!");
+}
+
+const SceneFile::Header& SceneFile::header() const
+{
+	return *reinterpret_cast<const Header*>(_data);
+}
+
+std::string_view SceneFile::typeName(size_t type) const
+{
+	return string(reinterpret_cast<const StringRef*>(_data + header().typesOffset)[type]);
+}
+
+std::string_view SceneFile::modelName(size_t model) const
+{
+	return string(reinterpret_cast<const StringRef*>(_data + header().modelsOffset)[model]);
+}
+
+const SceneFile::NodeRecord* SceneFile::nodes() const
+{
+	return reinterpret_cast<const NodeRecord*>(_data + header().nodesOffset);
+}
+
+std::string_view SceneFile::string(const StringRef& string) const
+{
+	if (static_cast<uint64_t>(string.offset) + string.length > header().stringsSize)
+		throw std::runtime_error("Scene file string out of bounds!");
+
+	return std::string_view(reinterpret_cast<const char*>(_data + header().stringsOffset) + string.offset, string.length);
+}
+
+void SceneFile::checkHeader(const std::string& path) const
+{
+	const Header& fileHeader = header();
+	if (std::memcmp(fileHeader.magic, Magic, sizeof(Magic)) != 0)
+		throw std::runtime_error("File " + path + " is not a scene file!");
+
+	if (fileHeader.version != Version)
+		throw std::runtime_error("Scene file " + path + " was written with another version of the format!");
+
+	checkTable(fileHeader.typesOffset, fileHeader.typeCount, sizeof(StringRef));
+	checkTable(fileHeader.modelsOffset, fileHeader.modelCount, sizeof(StringRef));
+	checkTable(fileHeader.nodesOffset, fileHeader.nodeCount, sizeof(NodeRecord));
+	checkTable(fileHeader.stringsOffset, fileHeader.stringsSize, 1);
+}
+
+void SceneFile::checkTable(uint64_t offset, uint64_t count, size_t size) const
+{
+	if (offset % TableAlignment != 0 || offset > _size || count * size > _size - offset)
+		throw std::runtime_error("Scene file table out of bounds!");
+}
+
+#if defined(_WIN32)
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+SceneFile::SceneFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Could not open scene file " + path + "!");
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || static_cast<uint64_t>(size.QuadPart) < sizeof(Header))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Scene file " + path + " is malformatted!");
+	}
+
+	// The mapping keeps the file open on its own.
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		throw std::runtime_error("Could not map scene file " + path + "!");
+
+	const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		throw std::runtime_error("Could not map scene file " + path + "!");
+	}
+
+	_data = static_cast<const unsigned char*>(data);
+	_size = static_cast<size_t>(size.QuadPart);
+	_mappingHandle = mapping;
+
+	try
+	{
+		checkHeader(path);
+	}
+	catch (...)
+	{
+		UnmapViewOfFile(_data);
+		CloseHandle(_mappingHandle);
+		throw;
+	}
+}
+
+SceneFile::~SceneFile()
+{
+	UnmapViewOfFile(_data);
+	CloseHandle(_mappingHandle);
+}
+
+#elif defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SceneFile::SceneFile(const std::string& path)
+{
+	int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		throw std::runtime_error("Could not open scene file " + path + "!");
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || static_cast<uint64_t>(status.st_size) < sizeof(Header))
+	{
+		close(file);
+		throw std::runtime_error("Scene file " + path + " is malformatted!");
+	}
+
+	// The mapping keeps the file open on its own.
+	void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("Could not map scene file " + path + "!");
+
+	_data = static_cast<const unsigned char*>(data);
+	_size = static_cast<size_t>(status.st_size);
+
+	// Nodes are read front to back, once.
+	madvise(data, _size, MADV_SEQUENTIAL);
+
+	try
+	{
+		checkHeader(path);
+	}
+	catch (...)
+	{
+		munmap(data, _size);
+		throw;
+	}
+}
+
+SceneFile::~SceneFile()
+{
+	munmap(const_cast<unsigned char*>(_data), _size);
+}
+
+#else
+#error "Memory-mapped files haven't been implemented for this system!"
+#endif
\ No newline at end of file
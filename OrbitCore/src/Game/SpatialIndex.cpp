@@ -0,0 +1,304 @@
+/*! @file Game/SpatialIndex.cpp */
+
+#include "Game/SpatialIndex.h"
+
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+using namespace Orbit;
+
+SpatialIndex::SpatialIndex(float margin)
+	: _margin(margin)
+{
+}
+
+SpatialIndex::Proxy SpatialIndex::insert(Node& node, const AABB& bounds)
+{
+	Proxy proxy;
+	if (_freeLeaves != None)
+	{
+		proxy = _freeLeaves;
+		_freeLeaves = _leaves[proxy].element;
+	}
+	else
+	{
+		proxy = static_cast<Proxy>(_leaves.size());
+		_leaves.emplace_back();
+	}
+
+	uint32_t element = allocateElement();
+	_elements[element].leaf = proxy;
+	_boxes[element] = bounds.fattened(_margin);
+
+	_leaves[proxy] = { &node, bounds, element };
+	insertElement(element);
+	_size++;
+
+	return proxy;
+}
+
+void SpatialIndex::remove(Proxy proxy)
+{
+	if (proxy >= _leaves.size() || !_leaves[proxy].node)
+		throw std::runtime_error("Attempted to remove a node that is not in the spatial index!");
+
+	uint32_t element = _leaves[proxy].element;
+	removeElement(element);
+	freeElement(element);
+
+	_leaves[proxy] = { nullptr, AABB(), _freeLeaves };
+	_freeLeaves = proxy;
+	_size--;
+}
+
+bool SpatialIndex::move(Proxy proxy, const AABB& bounds)
+{
+	Leaf& leaf = _leaves[proxy];
+	leaf.bounds = bounds;
+
+	if (_boxes[leaf.element].contains(bounds))
+		return false;
+
+	removeElement(leaf.element);
+	_boxes[leaf.element] = bounds.fattened(_margin);
+	insertElement(leaf.element);
+
+	return true;
+}
+
+const AABB& SpatialIndex::bounds(Proxy proxy) const
+{
+	return _leaves[proxy].bounds;
+}
+
+size_t SpatialIndex::size() const
+{
+	return _size;
+}
+
+std::vector<Node*> SpatialIndex::nearest(const glm::vec3& point, size_t count) const
+{
+	std::vector<Node*> nodes;
+	if (_root == None || count == 0)
+		return nodes;
+
+	// Best first: elements are visited closest first, so nodes come out in order, and the search stops as soon as the
+	// closest element left is further away than the count-th closest node found so far.
+	using Candidate = std::pair<float, uint32_t>;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> elements;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> leaves;
+
+	elements.push({ _boxes[_root].distanceSquared(point), _root });
+	while (nodes.size() < count && (!elements.empty() || !leaves.empty()))
+	{
+		// A node goes out once no element left can hold anything closer. Fat boxes are never further than the nodes'
+		// actual bounds, so this holds for the nodes below them too.
+		if (!leaves.empty() && (elements.empty() || leaves.top().first <= elements.top().first))
+		{
+			nodes.push_back(_leaves[leaves.top().second].node);
+			leaves.pop();
+			continue;
+		}
+
+		uint32_t index = elements.top().second;
+		elements.pop();
+
+		const Element& element = _elements[index];
+		if (element.leaf != None)
+		{
+			leaves.push({ _leaves[element.leaf].bounds.distanceSquared(point), element.leaf });
+			continue;
+		}
+
+		for (uint32_t child : element.children)
+			elements.push({ _boxes[child].distanceSquared(point), child });
+	}
+
+	return nodes;
+}
+
+uint32_t SpatialIndex::allocateElement()
+{
+	uint32_t index;
+	if (_freeElements != None)
+	{
+		index = _freeElements;
+		_freeElements = _elements[index].parent;
+	}
+	else
+	{
+		index = static_cast<uint32_t>(_elements.size());
+		_elements.emplace_back();
+		_boxes.emplace_back();
+	}
+
+	_elements[index] = Element();
+	return index;
+}
+
+void SpatialIndex::freeElement(uint32_t index)
+{
+	_elements[index] = Element();
+	_elements[index].parent = _freeElements;
+	_freeElements = index;
+}
+
+void SpatialIndex::insertElement(uint32_t element)
+{
+	if (_root == None)
+	{
+		_root = element;
+		_elements[element].parent = None;
+		return;
+	}
+
+	// Walks down towards the sibling that makes for the smallest total surface area, every ancestor growing to fit the
+	// new element (the surface area heuristic, as in Box2D's dynamic tree).
+	const AABB box = _boxes[element];
+	uint32_t index = _root;
+	while (_elements[index].leaf == None)
+	{
+		const uint32_t* children = _elements[index].children;
+
+		float area = _boxes[index].surfaceArea();
+		float combinedArea = AABB::merged(_boxes[index], box).surfaceArea();
+
+		// Making a new parent for this element and the new one.
+		float cost = 2.f * combinedArea;
+		// Pushing the new one further down: every ancestor grows.
+		float inheritanceCost = 2.f * (combinedArea - area);
+
+		float childCosts[2];
+		for (int child = 0; child < 2; child++)
+		{
+			const AABB& childBox = _boxes[children[child]];
+			float grownArea = AABB::merged(childBox, box).surfaceArea();
+
+			if (_elements[children[child]].leaf != None)
+				childCosts[child] = grownArea + inheritanceCost;
+			else
+				childCosts[child] = grownArea - childBox.surfaceArea() + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	uint32_t sibling = index;
+	uint32_t oldParent = _elements[sibling].parent;
+
+	uint32_t newParent = allocateElement();
+	_elements[newParent].parent = oldParent;
+	_elements[newParent].children[0] = sibling;
+	_elements[newParent].children[1] = element;
+	_elements[newParent].height = _elements[sibling].height + 1;
+	_boxes[newParent] = AABB::merged(_boxes[sibling], box);
+
+	if (oldParent == None)
+		_root = newParent;
+	else
+		_elements[oldParent].children[_elements[oldParent].children[0] == sibling ? 0 : 1] = newParent;
+
+	_elements[sibling].parent = newParent;
+	_elements[element].parent = newParent;
+
+	refitFrom(_elements[newParent].parent);
+}
+
+void SpatialIndex::removeElement(uint32_t element)
+{
+	if (element == _root)
+	{
+		_root = None;
+		return;
+	}
+
+	uint32_t parent = _elements[element].parent;
+	uint32_t grandParent = _elements[parent].parent;
+	uint32_t sibling = _elements[parent].children[_elements[parent].children[0] == element ? 1 : 0];
+
+	// The sibling takes the parent's place.
+	if (grandParent == None)
+	{
+		_root = sibling;
+		_elements[sibling].parent = None;
+	}
+	else
+	{
+		_elements[grandParent].children[_elements[grandParent].children[0] == parent ? 0 : 1] = sibling;
+		_elements[sibling].parent = grandParent;
+	}
+
+	freeElement(parent);
+	_elements[element].parent = None;
+
+	refitFrom(grandParent);
+}
+
+void SpatialIndex::refitFrom(uint32_t index)
+{
+	while (index != None)
+	{
+		index = balance(index);
+
+		const Element& element = _elements[index];
+		uint32_t left = element.children[0];
+		uint32_t right = element.children[1];
+
+		_elements[index].height = 1 + std::max(_elements[left].height, _elements[right].height);
+		_boxes[index] = AABB::merged(_boxes[left], _boxes[right]);
+
+		index = _elements[index].parent;
+	}
+}
+
+uint32_t SpatialIndex::balance(uint32_t a)
+{
+	if (_elements[a].leaf != None || _elements[a].height < 2)
+		return a;
+
+	uint32_t b = _elements[a].children[0];
+	uint32_t c = _elements[a].children[1];
+	int32_t difference = _elements[c].height - _elements[b].height;
+
+	if (difference >= -1 && difference <= 1)
+		return a;
+
+	// The deeper child is promoted in a's place, a taking over its shallower grandchild.
+	uint32_t high = difference > 1 ? c : b;
+	uint32_t low = difference > 1 ? b : c;
+	int aSlot = difference > 1 ? 1 : 0;
+
+	uint32_t f = _elements[high].children[0];
+	uint32_t g = _elements[high].children[1];
+
+	// High takes a's place.
+	_elements[high].children[0] = a;
+	_elements[high].parent = _elements[a].parent;
+	_elements[a].parent = high;
+
+	uint32_t highParent = _elements[high].parent;
+	if (highParent == None)
+		_root = high;
+	else
+		_elements[highParent].children[_elements[highParent].children[0] == a ? 0 : 1] = high;
+
+	// The deeper grandchild stays with high, the other one goes to a.
+	uint32_t kept = _elements[f].height > _elements[g].height ? f : g;
+	uint32_t given = kept == f ? g : f;
+
+	_elements[high].children[1] = kept;
+	_elements[a].children[aSlot] = given;
+	_elements[given].parent = a;
+
+	_boxes[a] = AABB::merged(_boxes[low], _boxes[given]);
+	_boxes[high] = AABB::merged(_boxes[a], _boxes[kept]);
+
+	_elements[a].height = 1 + std::max(_elements[low].height, _elements[given].height);
+	_elements[high].height = 1 + std::max(_elements[a].height, _elements[kept].height);
+
+	return high;
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+/*! @file Game/TimerWheel.cpp */
+
+#include "Game/TimerWheel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Orbit;
+
+void TimerHandle::cancel() noexcept
+{
+	if (!_wheel)
+		return;
+
+	_wheel->cancel(_index, _generation);
+	_wheel = nullptr;
+}
+
+bool TimerHandle::active() const noexcept
+{
+	return _wheel && _wheel->active(_index, _generation);
+}
+
+TimerWheel::TimerWheel(std::chrono::nanoseconds resolution)
+	: _resolution(resolution)
+{
+	if (resolution <= std::chrono::nanoseconds::zero())
+		throw std::runtime_error("A timer wheel's resolution must be positive!");
+
+	_lists.fill(None);
+}
+
+TimerHandle TimerWheel::schedule(std::chrono::nanoseconds delay, Callback callback)
+{
+	return add(delay, std::chrono::nanoseconds::zero(), std::move(callback));
+}
+
+TimerHandle TimerWheel::scheduleRepeating(std::chrono::nanoseconds period, Callback callback)
+{
+	return add(period, std::max(period, _resolution), std::move(callback));
+}
+
+void TimerWheel::advance(std::chrono::nanoseconds elapsedTime)
+{
+	// The remainder is cleared while stepping, so that callbacks scheduling timers do so from their step's time.
+	std::chrono::nanoseconds remaining = _remainder + elapsedTime;
+	_remainder = std::chrono::nanoseconds::zero();
+
+	while (remaining >= _resolution)
+	{
+		remaining -= _resolution;
+		step();
+	}
+
+	_remainder = remaining;
+}
+
+size_t TimerWheel::pending() const
+{
+	return _pending;
+}
+
+std::chrono::nanoseconds TimerWheel::now() const
+{
+	return _resolution * static_cast<int64_t>(_currentStep) + _remainder;
+}
+
+TimerHandle TimerWheel::add(std::chrono::nanoseconds delay, std::chrono::nanoseconds period, Callback callback)
+{
+	uint32_t index = _freeTimers;
+	if (index != None)
+	{
+		_freeTimers = _timers[index].next;
+	}
+	else
+	{
+		if (_timers.size() >= None)
+			throw std::runtime_error("Too many timers scheduled on this wheel!");
+
+		index = static_cast<uint32_t>(_timers.size());
+		_timers.emplace_back();
+	}
+
+	// Round up: a timer never fires before its delay is over.
+	int64_t resolution = _resolution.count();
+	int64_t delaySteps = std::max<int64_t>((_remainder + delay).count() + resolution - 1, 0) / resolution;
+
+	Timer& timer = _timers[index];
+	timer.callback = std::move(callback);
+	timer.deadline = _currentStep + static_cast<uint64_t>(std::max<int64_t>(delaySteps, 1));
+	timer.period = static_cast<uint64_t>((period.count() + resolution - 1) / resolution);
+
+	place(index);
+	_pending++;
+
+	return TimerHandle(this, index, timer.generation);
+}
+
+void TimerWheel::cancel(uint32_t index, uint32_t generation) noexcept
+{
+	if (!active(index, generation))
+		return;
+
+	_pending--;
+
+	// The callback is running: it cannot be destroyed just yet, step() frees the timer once it returns.
+	Timer& timer = _timers[index];
+	if (timer.firing)
+	{
+		timer.cancelled = true;
+		return;
+	}
+
+	unlink(index);
+	free(index);
+}
+
+bool TimerWheel::active(uint32_t index, uint32_t generation) const noexcept
+{
+	if (index >= _timers.size())
+		return false;
+
+	const Timer& timer = _timers[index];
+	return timer.generation == generation && !timer.cancelled;
+}
+
+void TimerWheel::place(uint32_t index)
+{
+	Timer& timer = _timers[index];
+	uint64_t difference = timer.deadline ^ _currentStep;
+
+	unsigned int level = 0;
+	while (level + 1 < LevelCount && (difference >> (LevelBits * (level + 1))) != 0)
+		level++;
+
+	uint32_t slot = static_cast<uint32_t>(timer.deadline >> (LevelBits * level)) & (SlotCount - 1);
+
+	// Too far away for the wheel: park the timer in the top level's first slot, which is cascaded whenever the whole wheel
+	// wraps around. No other timer can be there, as their deadlines are ahead of the current step in the top level.
+	if ((difference >> (LevelBits * LevelCount)) != 0)
+		slot = 0;
+
+	link(level * SlotCount + slot, index);
+}
+
+void TimerWheel::step()
+{
+	_currentStep++;
+
+	// Whenever a level wraps around, the next level's current slot gets close enough to be spread over the lower levels.
+	for (unsigned int level = 1; level < LevelCount; level++)
+	{
+		if ((_currentStep & ((uint64_t(1) << (LevelBits * level)) - 1)) != 0)
+			break;
+
+		uint32_t list = level * SlotCount + (static_cast<uint32_t>(_currentStep >> (LevelBits * level)) & (SlotCount - 1));
+		uint32_t index = _lists[list];
+		_lists[list] = None;
+
+		while (index != None)
+		{
+			uint32_t next = _timers[index].next;
+			place(index);
+			index = next;
+		}
+	}
+
+	// Move the due timers aside, so that callbacks may cancel the ones due on the same step.
+	uint32_t slot = static_cast<uint32_t>(_currentStep) & (SlotCount - 1);
+	for (uint32_t index = _lists[slot]; index != None; index = _timers[index].next)
+		_timers[index].list = ExpiringList;
+
+	_lists[ExpiringList] = _lists[slot];
+	_lists[slot] = None;
+
+	while (_lists[ExpiringList] != None)
+	{
+		uint32_t index = _lists[ExpiringList];
+		unlink(index);
+
+		Timer& timer = _timers[index];
+		if (timer.deadline > _currentStep)
+		{
+			place(index);
+			continue;
+		}
+
+		timer.firing = true;
+		timer.callback();
+		timer.firing = false;
+
+		if (timer.cancelled)
+		{
+			free(index);
+		}
+		else if (timer.period == 0)
+		{
+			_pending--;
+			free(index);
+		}
+		else
+		{
+			timer.deadline += timer.period;
+			place(index);
+		}
+	}
+}
+
+void TimerWheel::link(uint32_t list, uint32_t index)
+{
+	Timer& timer = _timers[index];
+	timer.list = list;
+	timer.previous = None;
+	timer.next = _lists[list];
+
+	if (timer.next != None)
+		_timers[timer.next].previous = index;
+
+	_lists[list] = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+	Timer& timer = _timers[index];
+
+	if (timer.previous != None)
+		_timers[timer.previous].next = timer.next;
+	else
+		_lists[timer.list] = timer.next;
+
+	if (timer.next != None)
+		_timers[timer.next].previous = timer.previous;
+
+	timer.list = None;
+	timer.previous = None;
+	timer.next = None;
+}
+
+void TimerWheel::free(uint32_t index)
+{
+	Timer& timer = _timers[index];
+	timer.callback = nullptr;
+	timer.generation++;
+	timer.cancelled = false;
+
+	timer.next = _freeTimers;
+	_freeTimers = index;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+/*! @file Game/UpdateScheduler.cpp */
+
+#include "Game/UpdateScheduler.h"
+
+#include "Game/CompositeTree/Node.h"
+#include "Task/Executor.h"
+
+#include <atomic>
+
+using namespace Orbit;
+
+UpdateScheduler::UpdateScheduler()
+	: _buckets((size_t(1) << RateCount) - 1)
+{
+}
+
+void UpdateScheduler::add(Node& node)
+{
+	if (node._treeSlot >= _slots.size())
+		_slots.resize(node._treeSlot + size_t(1));
+
+	slotOf(node).lastUpdate = _now;
+	place(node, rateOf(node));
+	_size++;
+}
+
+void UpdateScheduler::remove(Node& node)
+{
+	if (node._treeSlot >= _slots.size() || slotOf(node).bucket == NoBucket)
+		return;
+
+	unplace(node);
+	_size--;
+}
+
+void UpdateScheduler::update(std::chrono::nanoseconds elapsedTime, const Node* viewer, Executor* executor, size_t grainSize)
+{
+	_now += elapsedTime;
+	if (elapsedTime > std::chrono::nanoseconds::zero())
+		_tickDuration = elapsedTime;
+
+	_hasViewpoint = viewer != nullptr;
+	if (viewer)
+		_viewpoint = glm::vec3(viewer->modelMatrix()[3]);
+
+	// When every node is updated every tick, class 0's single bucket is all there is to update: it is not copied.
+	_due.clear();
+	if (_rateSizes[0] == _size)
+		_dueNodes = &_buckets[0];
+	else
+	{
+		// One bucket per class is due: the one the tick lands on, round-robin.
+		for (uint32_t rate = 0; rate < RateCount; rate++)
+		{
+			if (_rateSizes[rate] == 0)
+				continue;
+
+			uint64_t bucketCount = uint64_t(1) << rate;
+			const std::vector<Node*>& bucket = _buckets[bucketCount - 1 + (_tick & (bucketCount - 1))];
+			_due.insert(_due.end(), bucket.begin(), bucket.end());
+		}
+
+		_dueNodes = &_due;
+	}
+
+	_tick++;
+
+	const std::vector<Node*>& due = *_dueNodes;
+
+	// Nodes asking for another period are recorded as they go: only they are looked at again once every node is done.
+	_rateChanges.resize(due.size());
+	std::atomic<size_t> rateChangeCount{ 0 };
+
+	auto updateNode = [this, &rateChangeCount](Node& node) {
+		if (node.destroyed())
+			return;
+
+		Slot& slot = slotOf(node);
+		std::chrono::nanoseconds sinceLastUpdate = _now - slot.lastUpdate;
+		slot.lastUpdate = _now;
+		node.update(sinceLastUpdate);
+
+		uint32_t rate = rateOf(node);
+		if (rate != slot.rate)
+			_rateChanges[rateChangeCount.fetch_add(1, std::memory_order_relaxed)] = { &node, rate };
+	};
+
+	if (executor && due.size() > grainSize)
+		executor->parallelFor(0, due.size(), [&due, &updateNode](size_t index) {
+			updateNode(*due[index]);
+		}, grainSize);
+	else
+		for (Node* node : due)
+			updateNode(*node);
+
+	size_t rateChanges = rateChangeCount.load(std::memory_order_relaxed);
+	if (rateChanges == 0)
+		return;
+
+	// Moving nodes reorders class 0's bucket: the tick's nodes are kept apart from it first.
+	if (_dueNodes != &_due)
+	{
+		_due = *_dueNodes;
+		_dueNodes = &_due;
+	}
+
+	// Buckets are only touched from this thread.
+	for (size_t index = 0; index < rateChanges; index++)
+	{
+		const RateChange& change = _rateChanges[index];
+		unplace(*change.node);
+		place(*change.node, change.rate);
+	}
+}
+
+size_t UpdateScheduler::size() const
+{
+	return _size;
+}
+
+const std::vector<Node*>& UpdateScheduler::lastTick() const
+{
+	return *_dueNodes;
+}
+
+uint32_t UpdateScheduler::rateOf(const Node& node) const
+{
+	float distance = _hasViewpoint ? glm::distance(_viewpoint, glm::vec3(node.modelMatrix()[3])) : 0.f;
+	std::chrono::nanoseconds period = node.updatePeriod(distance);
+
+	// Before the first tick, periods cannot be turned into ticks yet: nodes start out updated every tick.
+	if (_tickDuration <= std::chrono::nanoseconds::zero() || period < 2 * _tickDuration)
+		return 0;
+
+	// Rounded down, so that nodes are never updated less often than they ask for.
+	uint64_t ticks = static_cast<uint64_t>(period / _tickDuration);
+	uint32_t rate = 0;
+	while (rate + 1 < RateCount && (uint64_t(1) << (rate + 1)) <= ticks)
+		rate++;
+
+	return rate;
+}
+
+void UpdateScheduler::place(Node& node, uint32_t rate)
+{
+	uint32_t bucketCount = uint32_t(1) << rate;
+	uint32_t bucket = bucketCount - 1 + _nextBuckets[rate];
+	_nextBuckets[rate] = (_nextBuckets[rate] + 1) & (bucketCount - 1);
+
+	std::vector<Node*>& nodes = _buckets[bucket];
+	Slot& slot = slotOf(node);
+	slot.rate = rate;
+	slot.bucket = bucket;
+	slot.position = nodes.size();
+	nodes.push_back(&node);
+	_rateSizes[rate]++;
+}
+
+void UpdateScheduler::unplace(Node& node)
+{
+	Slot& slot = slotOf(node);
+	std::vector<Node*>& nodes = _buckets[slot.bucket];
+	Node* last = nodes.back();
+	nodes[slot.position] = last;
+	slotOf(*last).position = slot.position;
+	nodes.pop_back();
+
+	_rateSizes[slot.rate]--;
+	slot.bucket = NoBucket;
+}
+
+UpdateScheduler::Slot& UpdateScheduler::slotOf(const Node& node)
+{
+	return _slots[node._treeSlot];
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+/*! @file Render/MeshSimplifier.cpp */
+
+#include "Render/MeshSimplifier.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+using namespace Orbit;
+
+namespace
+{
+	/*! How much more open borders weigh than the triangles around them. */
+	constexpr float BoundaryWeight = 10.f;
+
+	/*!
+	@brief Computes the non-normalized normal of a triangle, whose length is twice the triangle's area.
+	@param a The triangle's first vertex.
+	@param b The triangle's second vertex.
+	@param c The triangle's third vertex.
+	@return The triangle's normal, scaled by twice its area.
+	*/
+	glm::vec3 scaledNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+	{
+		return glm::cross(b - a, c - a);
+	}
+}
+
+void MeshSimplifier::Quadric::addPlane(const glm::vec3& normal, float distance, float weight)
+{
+	double a = normal.x, b = normal.y, c = normal.z, d = distance;
+	double plane[10] = { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+
+	for (size_t coefficient = 0; coefficient < coefficients.size(); coefficient++)
+		coefficients[coefficient] += weight * plane[coefficient];
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& rhs)
+{
+	for (size_t coefficient = 0; coefficient < coefficients.size(); coefficient++)
+		coefficients[coefficient] += rhs.coefficients[coefficient];
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::vec3& point) const
+{
+	double x = point.x, y = point.y, z = point.z;
+	const std::array<double, 10>& q = coefficients;
+
+	return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x +
+		q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y +
+		q[7] * z * z + 2 * q[8] * z +
+		q[9];
+}
+
+MeshSimplifier::MeshSimplifier(const Model& model)
+	: _vertices(model.getVertices())
+{
+	const std::vector<uint32_t>& indices = model.getIndices();
+
+	_triangles.reserve(indices.size() / 3);
+	for (size_t index = 0; index + 2 < indices.size(); index += 3)
+		_triangles.push_back({ indices[index], indices[index + 1], indices[index + 2] });
+
+	_triangleCount = _triangles.size();
+	_removedTriangles.assign(_triangles.size(), false);
+	_vertexTriangles.resize(_vertices.size());
+	_quadrics.resize(_vertices.size());
+	_versions.assign(_vertices.size(), 0);
+	_removedVertices.assign(_vertices.size(), false);
+
+	// Edges used by a single triangle are open borders. Keys are (smaller index, larger index).
+	std::unordered_map<uint64_t, uint32_t> edgeUses;
+	auto edgeKey = [](uint32_t a, uint32_t b) {
+		return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+	};
+
+	for (uint32_t triangle = 0; triangle < _triangles.size(); triangle++)
+	{
+		const std::array<uint32_t, 3>& corners = _triangles[triangle];
+		glm::vec3 normal = scaledNormal(_vertices[corners[0]].pos, _vertices[corners[1]].pos, _vertices[corners[2]].pos);
+		float length = glm::length(normal);
+
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			_vertexTriangles[corners[corner]].push_back(triangle);
+			edgeUses[edgeKey(corners[corner], corners[(corner + 1) % 3])]++;
+		}
+
+		if (length == 0.f)
+			continue;
+
+		// Weighted by area, so that large flat regions resist more than slivers.
+		glm::vec3 unitNormal = normal / length;
+		float distance = -glm::dot(unitNormal, _vertices[corners[0]].pos);
+		for (uint32_t corner : corners)
+			_quadrics[corner].addPlane(unitNormal, distance, 0.5f * length);
+	}
+
+	// Open borders get a plane of their own, perpendicular to their triangle: moving a border vertex off the border
+	// costs as much as moving it off its triangles' planes, times BoundaryWeight.
+	for (const std::array<uint32_t, 3>& corners : _triangles)
+	{
+		glm::vec3 normal = scaledNormal(_vertices[corners[0]].pos, _vertices[corners[1]].pos, _vertices[corners[2]].pos);
+		if (glm::length(normal) == 0.f)
+			continue;
+
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			uint32_t a = corners[corner];
+			uint32_t b = corners[(corner + 1) % 3];
+			if (edgeUses[edgeKey(a, b)] != 1)
+				continue;
+
+			glm::vec3 edge = _vertices[b].pos - _vertices[a].pos;
+			glm::vec3 borderNormal = glm::cross(edge, normal);
+			float length = glm::length(borderNormal);
+			if (length == 0.f)
+				continue;
+
+			borderNormal = borderNormal / length;
+			float distance = -glm::dot(borderNormal, _vertices[a].pos);
+			float weight = BoundaryWeight * glm::dot(edge, edge);
+
+			_quadrics[a].addPlane(borderNormal, distance, weight);
+			_quadrics[b].addPlane(borderNormal, distance, weight);
+		}
+	}
+
+	for (const auto& edge : edgeUses)
+		queueEdge(static_cast<uint32_t>(edge.first >> 32), static_cast<uint32_t>(edge.first));
+}
+
+size_t MeshSimplifier::simplify(size_t targetTriangles)
+{
+	while (_triangleCount > targetTriangles && !_collapses.empty())
+	{
+		std::pop_heap(_collapses.begin(), _collapses.end(), std::greater<Collapse>());
+		Collapse candidate = _collapses.back();
+		_collapses.pop_back();
+
+		// Either vertex changed since the collapse was evaluated: it was queued again along the way.
+		if (_removedVertices[candidate.from] || _removedVertices[candidate.to] ||
+			_versions[candidate.from] != candidate.fromVersion || _versions[candidate.to] != candidate.toVersion)
+			continue;
+
+		if (!collapsible(candidate.from, candidate.to))
+			continue;
+
+		collapse(candidate.from, candidate.to);
+	}
+
+	return _triangleCount;
+}
+
+size_t MeshSimplifier::triangles() const
+{
+	return _triangleCount;
+}
+
+std::shared_ptr<Model> MeshSimplifier::snapshot(std::shared_ptr<const Texture> texture) const
+{
+	// Models are built from a flat list of vertices, deduplicated back into indices.
+	std::vector<Vertex> vertexList;
+	vertexList.reserve(_triangleCount * 3);
+
+	for (size_t triangle = 0; triangle < _triangles.size(); triangle++)
+	{
+		if (_removedTriangles[triangle])
+			continue;
+
+		for (uint32_t corner : _triangles[triangle])
+			vertexList.push_back(_vertices[corner]);
+	}
+
+	return std::make_shared<Model>(vertexList, texture);
+}
+
+void MeshSimplifier::queueEdge(uint32_t a, uint32_t b)
+{
+	Quadric quadric = _quadrics[a];
+	quadric.add(_quadrics[b]);
+
+	double costToA = quadric.evaluate(_vertices[a].pos);
+	double costToB = quadric.evaluate(_vertices[b].pos);
+
+	if (costToB <= costToA)
+		_collapses.push_back({ costToB, a, b, _versions[a], _versions[b] });
+	else
+		_collapses.push_back({ costToA, b, a, _versions[b], _versions[a] });
+
+	std::push_heap(_collapses.begin(), _collapses.end(), std::greater<Collapse>());
+}
+
+bool MeshSimplifier::collapsible(uint32_t from, uint32_t to) const
+{
+	const glm::vec3& target = _vertices[to].pos;
+
+	for (uint32_t triangle : _vertexTriangles[from])
+	{
+		if (_removedTriangles[triangle])
+			continue;
+
+		const std::array<uint32_t, 3>& corners = _triangles[triangle];
+		if (std::find(corners.begin(), corners.end(), to) != corners.end())
+			continue;
+
+		glm::vec3 before[3];
+		glm::vec3 after[3];
+		for (size_t corner = 0; corner < 3; corner++)
+		{
+			before[corner] = _vertices[corners[corner]].pos;
+			after[corner] = corners[corner] == from ? target : before[corner];
+		}
+
+		// Flipped triangles turn their normal around; degenerate ones lose it.
+		if (glm::dot(scaledNormal(before[0], before[1], before[2]), scaledNormal(after[0], after[1], after[2])) <= 0.f)
+			return false;
+	}
+
+	return true;
+}
+
+void MeshSimplifier::collapse(uint32_t from, uint32_t to)
+{
+	for (uint32_t triangle : _vertexTriangles[from])
+	{
+		if (_removedTriangles[triangle])
+			continue;
+
+		std::array<uint32_t, 3>& corners = _triangles[triangle];
+		if (std::find(corners.begin(), corners.end(), to) != corners.end())
+		{
+			// The collapsed edge's triangles flatten into it.
+			_removedTriangles[triangle] = true;
+			_triangleCount--;
+			continue;
+		}
+
+		std::replace(corners.begin(), corners.end(), from, to);
+		_vertexTriangles[to].push_back(triangle);
+	}
+
+	_removedVertices[from] = true;
+	_vertexTriangles[from].clear();
+	_quadrics[to].add(_quadrics[from]);
+
+	// Drop the removed triangles from the kept vertex's list, then evaluate its edges again.
+	std::vector<uint32_t>& triangles = _vertexTriangles[to];
+	triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [this](uint32_t triangle) {
+		return _removedTriangles[triangle];
+	}), triangles.end());
+
+	std::vector<uint32_t> neighbours;
+	for (uint32_t triangle : triangles)
+		for (uint32_t corner : _triangles[triangle])
+			if (corner != to)
+				neighbours.push_back(corner);
+
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+	// The kept vertex's pending collapses are stale now: its edges are queued again, with its new quadric.
+	_versions[to]++;
+	for (uint32_t neighbour : neighbours)
+		queueEdge(neighbour, to);
+}
\ No newline at end of file
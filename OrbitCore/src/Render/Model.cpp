@@ -2,7 +2,10 @@
 
 #include "Render/Model.h"
 
+#include "Render/MeshSimplifier.h"
+
 #include <cstddef>
+#include <stdexcept>
 #include <unordered_map>
 
 using namespace Orbit;
@@ -60,10 +63,14 @@ Model::Model(const std::vector<Vertex>& vertexList, std::shared_ptr<const Textur
 
 		_indices.push_back(vertexIndices[vertex]);
 	}
+
+	for (const Vertex& vertex : _vertices)
+		_bounds.merge(vertex.pos);
 }
 
 Model::Model(Model&& rhs)
-	: _texture(rhs._texture), _vertices(std::move(rhs._vertices)), _indices(std::move(rhs._indices))
+	: _texture(rhs._texture), _vertices(std::move(rhs._vertices)), _indices(std::move(rhs._indices)), _bounds(rhs._bounds),
+	_lods(std::move(rhs._lods))
 {
 }
 
@@ -72,12 +79,17 @@ Model& Model::operator=(Model&& rhs)
 	_texture = rhs._texture;
 	_vertices = std::move(rhs._vertices);
 	_indices = std::move(rhs._indices);
+	_bounds = rhs._bounds;
+	_lods = std::move(rhs._lods);
 	return *this;
 }
 
 void Model::setTexture(std::shared_ptr<const Texture> texture)
 {
 	_texture = texture;
+
+	for (Lod& lod : _lods)
+		lod.model->setTexture(texture);
 }
 
 std::shared_ptr<const Texture> Model::getTexture() const
@@ -95,6 +107,64 @@ const std::vector<uint32_t>& Model::getIndices() const
 	return _indices;
 }
 
+const AABB& Model::bounds() const
+{
+	return _bounds;
+}
+
+void Model::addLod(std::shared_ptr<Model> lod, float screenSize)
+{
+	if (!lod)
+		throw std::runtime_error("Attempted to add a null level of detail!");
+
+	if (!_lods.empty() && screenSize >= _lods.back().screenSize)
+		throw std::runtime_error("Levels of detail must get less detailed as their screen size goes down!");
+
+	_lods.push_back({ std::move(lod), screenSize });
+}
+
+void Model::generateLods(size_t count, float reduction, float screenSize)
+{
+	if (count == 0 || _indices.empty())
+		return;
+
+	// Each level carries on simplifying from the previous one, so the whole chain costs about as much as the last level.
+	MeshSimplifier simplifier(*this);
+	size_t triangles = simplifier.triangles();
+
+	for (size_t level = 0; level < count; level++)
+	{
+		size_t target = static_cast<size_t>(triangles * reduction);
+		size_t reached = simplifier.simplify(target);
+		if (reached == triangles || reached == 0)
+			return;
+
+		addLod(simplifier.snapshot(_texture), screenSize);
+		triangles = reached;
+		screenSize *= 0.5f;
+	}
+}
+
+const std::vector<Model::Lod>& Model::lods() const
+{
+	return _lods;
+}
+
+const Model::Lod* Model::selectLod(float screenSize) const
+{
+	const Lod* selected = nullptr;
+
+	for (const Lod& lod : _lods)
+	{
+		if (screenSize >= lod.screenSize)
+			break;
+
+		selected = &lod;
+	}
+
+	return selected;
+}
+
 size_t Model::hash_code() const
 {
 	// The model won't change in its lifetime. Therefore, the hash should only be calculated once
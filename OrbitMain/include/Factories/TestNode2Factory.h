@@ -4,14 +4,19 @@
 #define FACTORIES_TESTNODE2FACTORY_H
 #pragma once
 
+#include <Game/Factories/InstanceAllocator.h>
 #include <Game/Factories/NodeFactory.h>
+#include <Game/Factories/NodePool.h>
 
 #include <Render/Model.h>
 
+#include "Nodes/TestNode2.h"
+
 namespace OrbitMain
 {
 	/*!
-	@brief Implementation of the factorydesign pattern, outputting instances of OrbitMain::TestNode2.
+	@brief Implementation of the factorydesign pattern, outputting instances of OrbitMain::TestNode2. Instances are
+	allocated from (and recycled through) the factory's node pool.
 	*/
 	class TestNode2Factory : public Orbit::NodeFactory
 	{
@@ -36,9 +41,28 @@ namespace OrbitMain
 		*/
 		std::shared_ptr<Orbit::Node> create(const std::string& name) const override;
 
+		/*!
+		@brief Creates a batch of instances of OrbitMain::TestNode2, one per name. The nodes are allocated from a single slab
+		of the pool, and their names from a single block.
+		@param names The names of the nodes.
+		@return The instances of OrbitMain::TestNode2.
+		*/
+		std::vector<std::shared_ptr<Orbit::Node>> create(const std::vector<std::string_view>& names) const override;
+
+		/*!
+		@brief Creates a batch of instances of OrbitMain::TestNode2, one per archetype, from a single slab of the pool.
+		@param archetypes The archetypes of the nodes.
+		@return The instances of OrbitMain::TestNode2.
+		*/
+		std::vector<std::shared_ptr<Orbit::Node>> create(const std::vector<std::shared_ptr<const Orbit::Node::Archetype>>& archetypes) const override;
+
+		using NodeFactory::create;
+
 	private:
 		/*! The model used by instances of TestNode2. */
 		const std::shared_ptr<Orbit::Model> _testNode2Model;
+		/*! The pool the instances of TestNode2 are allocated from. Mutable, as creating nodes is logically const. */
+		mutable Orbit::NodePool<TestNode2> _pool;
 	};
 }
 
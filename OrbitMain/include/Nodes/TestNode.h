@@ -31,6 +31,13 @@ namespace OrbitMain
 		*/
 		explicit TestNode(const Orbit::Input& input, const std::string& name, const std::shared_ptr<Orbit::Model>& model);
 
+		/*!
+		@brief Initializes the node as an instance of a prefab.
+		@param input The input handler reference to use by the node.
+		@param archetype The archetype shared with the other instances.
+		*/
+		explicit TestNode(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype);
+
 		/*!
 		@brief Destructor for the class.
 		*/
@@ -64,15 +71,28 @@ namespace OrbitMain
 		*/
 		std::shared_ptr<Orbit::Node> clone() const override;
 
+		/*!
+		@brief Returns an instance of the node, sharing its archetype, allocated along with the rest of the batch.
+		@param allocator The allocator of the batch of instances.
+		@return An instance of the node.
+		*/
+		std::shared_ptr<Orbit::Node> instantiate(Orbit::InstanceAllocator& allocator) const override;
+
 		/*!
 		@brief Update code for the node.
 		@param elapsedTime The elapsed time, in nanoseconds.
 		*/
 		void update(std::chrono::nanoseconds elapsedTime) override;
 
+	protected:
+		/*!
+		@brief Schedules the node's once-per-second tick rate output.
+		*/
+		void onAttached() override;
+
 	private:
-		/*! Accumulated time for the node - it outputs something every second. */
-		std::chrono::nanoseconds _accumulatedTime = std::chrono::nanoseconds::zero();
+		/*! The amount of updates since the last output. */
+		uint32_t _ticksSinceOutput = 0;
 	};
 }
 
@@ -30,6 +30,13 @@ namespace OrbitMain
 		*/
 		explicit TestNode2(const Orbit::Input& input, const std::string& name, const std::shared_ptr<Orbit::Model>& model);
 
+		/*!
+		@brief Initializes the node as an instance of a prefab.
+		@param input The input handler reference to use by the node.
+		@param archetype The archetype shared with the other instances.
+		*/
+		explicit TestNode2(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype);
+
 		/*!
 		@brief Destructor for the class.
 		*/
@@ -63,6 +70,13 @@ namespace OrbitMain
 		*/
 		std::shared_ptr<Orbit::Node> clone() const override;
 
+		/*!
+		@brief Returns an instance of the node, sharing its archetype, allocated along with the rest of the batch.
+		@param allocator The allocator of the batch of instances.
+		@return An instance of the node.
+		*/
+		std::shared_ptr<Orbit::Node> instantiate(Orbit::InstanceAllocator& allocator) const override;
+
 		/*!
 		@brief Performs the update operation on the node for a tick.
 		@param elapsedTime The elapsed time, in nanoseconds.
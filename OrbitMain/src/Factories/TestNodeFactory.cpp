@@ -1,7 +1,5 @@
 #include "Factories/TestNodeFactory.h"
 
-#include "Nodes/TestNode.h"
-
 using namespace OrbitMain;
 
 TestNodeFactory::TestNodeFactory(const Orbit::Input& input, std::shared_ptr<Orbit::Model> testNodeModel)
@@ -11,10 +9,41 @@ TestNodeFactory::TestNodeFactory(const Orbit::Input& input, std::shared_ptr<Orbi
 
 std::shared_ptr<Orbit::Node> TestNodeFactory::create() const
 {
-	return std::make_shared<TestNode>(_input, _testNodeModel);
+	return _pool.create(_input, _testNodeModel);
 }
 
 std::shared_ptr<Orbit::Node> TestNodeFactory::create(const std::string& name) const
 {
-	return std::make_shared<TestNode>(_input, name, _testNodeModel);
+	return _pool.create(_input, name, _testNodeModel);
+}
+
+std::vector<std::shared_ptr<Orbit::Node>> TestNodeFactory::create(const std::vector<std::string_view>& names) const
+{
+	std::vector<std::shared_ptr<const Orbit::Node::Archetype>> archetypes;
+	archetypes.reserve(names.size());
+
+	// The nodes' names live in their archetypes, allocated in a single block as well.
+	Orbit::InstanceAllocator allocator(names.size() * 2 * sizeof(Orbit::Node::Archetype));
+	for (std::string_view name : names)
+	{
+		std::shared_ptr<Orbit::Node::Archetype> archetype = allocator.create<Orbit::Node::Archetype>();
+		archetype->name = name;
+		archetype->model = _testNodeModel;
+
+		archetypes.push_back(std::move(archetype));
+	}
+
+	return create(archetypes);
+}
+
+std::vector<std::shared_ptr<Orbit::Node>> TestNodeFactory::create(const std::vector<std::shared_ptr<const Orbit::Node::Archetype>>& archetypes) const
+{
+	std::vector<std::shared_ptr<Orbit::Node>> nodes;
+	nodes.reserve(archetypes.size());
+	_pool.reserve(archetypes.size());
+
+	for (const std::shared_ptr<const Orbit::Node::Archetype>& archetype : archetypes)
+		nodes.push_back(_pool.create(_input, archetype));
+
+	return nodes;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Nodes/TestNode.h"
 
 #include <Game/CompositeTree/Visitor.h>
+#include <Game/Factories/InstanceAllocator.h>
 #include <Input/Input.h>
 
 #include <iostream>
@@ -19,14 +20,20 @@ TestNode::TestNode(const Orbit::Input& input, const std::string& name, const std
 {
 }
 
+TestNode::TestNode(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype)
+	: Node(input, archetype)
+{
+}
+
 TestNode::TestNode(TestNode&& rhs)
-	: Node(std::move(rhs))
+	: Node(std::move(rhs)), _ticksSinceOutput(rhs._ticksSinceOutput)
 {
 }
 
 TestNode& TestNode::operator=(TestNode&& rhs)
 {
 	Node::operator=(std::move(rhs));
+	_ticksSinceOutput = rhs._ticksSinceOutput;
 	return *this;
 }
 
@@ -40,16 +47,14 @@ std::shared_ptr<Orbit::Node> TestNode::clone() const
 	return std::make_shared<TestNode>(getInput(), getModel());
 }
 
-void TestNode::update(std::chrono::nanoseconds elapsedTime)
+std::shared_ptr<Orbit::Node> TestNode::instantiate(Orbit::InstanceAllocator& allocator) const
 {
-	using namespace std::chrono;
+	return allocator.create<TestNode>(getInput(), archetype());
+}
 
-	_accumulatedTime += elapsedTime;
-	if (_accumulatedTime >= seconds(1))
-	{
-		_accumulatedTime = nanoseconds::zero();
-		std::cout << "Ticks per second: " << duration_cast<nanoseconds>(seconds(1)) / elapsedTime << std::endl;
-	}
+void TestNode::update(std::chrono::nanoseconds elapsedTime)
+{
+	_ticksSinceOutput++;
 
 	if (getInput().keyPressed(Orbit::Key::Code::A))
 		std::cout << "Hi I pressed the A button" << std::endl;
@@ -60,4 +65,12 @@ void TestNode::update(std::chrono::nanoseconds elapsedTime)
 	glm::ivec2 mouseDelta = getInput().mouseDelta();
 	if (mouseDelta.x != 0 && mouseDelta.y != 0)
 		std::cout << "MOVED THE MOUSE: " << mouseDelta.x << "," << mouseDelta.y << std::endl;
+}
+
+void TestNode::onAttached()
+{
+	scheduleRepeatingTimer(std::chrono::seconds(1), [this] {
+		std::cout << "Ticks per second: " << _ticksSinceOutput << std::endl;
+		_ticksSinceOutput = 0;
+	});
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Nodes/TestNode2.h"
 
 #include <Game/CompositeTree/Visitor.h>
+#include <Game/Factories/InstanceAllocator.h>
 #include <Input/Input.h>
 
 using namespace OrbitMain;
@@ -17,6 +18,11 @@ TestNode2::TestNode2(const Orbit::Input& input, const std::string& name, const s
 {
 }
 
+TestNode2::TestNode2(const Orbit::Input& input, const std::shared_ptr<const Orbit::Node::Archetype>& archetype)
+	: Node(input, archetype)
+{
+}
+
 TestNode2::TestNode2(TestNode2&& rhs)
 	: Node(std::move(rhs))
 {
@@ -38,6 +44,11 @@ std::shared_ptr<Orbit::Node> TestNode2::clone() const
 	return std::make_shared<TestNode2>(getInput(), getModel());
 }
 
+std::shared_ptr<Orbit::Node> TestNode2::instantiate(Orbit::InstanceAllocator& allocator) const
+{
+	return allocator.create<TestNode2>(getInput(), archetype());
+}
+
 void TestNode2::update(std::chrono::nanoseconds elapsedTime)
 {
 	if (getInput().keyPressed(Orbit::Key::Code::Up))
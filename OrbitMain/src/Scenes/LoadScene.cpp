@@ -42,8 +42,12 @@ void LoadScene::loadFactories(const Orbit::Input& input)
 		{ { -0.5, -0.5, 0 },{ 0, 1 },{ 0, 0, 0 },{ 1, 0, 0, 1 } }
 	}, texture2);
 
-	storeFactory<TestNode>(std::make_unique<TestNodeFactory>(input, model1));
-	storeFactory<TestNode2>(std::make_unique<TestNode2Factory>(input, model2));
+	// Models and node types are named, so that the scene's nodes can be saved to (and loaded from) scene files.
+	storeModel("Hello", model1);
+	storeModel("Hi", model2);
+
+	storeFactory<TestNode>("TestNode", std::make_unique<TestNodeFactory>(input, model1));
+	storeFactory<TestNode2>("TestNode2", std::make_unique<TestNode2Factory>(input, model2));
 }
 
 void LoadScene::load(Orbit::CompositeTree& tree)